@@ -0,0 +1,170 @@
+/**
+ * This benchmark runs the SSD postprocessing on synthetic network outputs
+ * with more than 10k candidate boxes per image and compares it with a
+ * straightforward implementation in the style of Caffe's DetectionOutput
+ * layer: every box decoded, a scalar threshold pass per class and an NMS
+ * computing the overlap against every kept box.
+ *
+ * Both must produce the same detections; the exit code is non-zero if
+ * they do not.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Detection.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void referenceImage(const float *loc, const float *conf, const float *priors, int numPriors,
+                           const trt::DetectionParams &params, std::vector<trt::Detection> &detections)
+{
+    std::vector<trt::Box> boxes(numPriors);
+    for (int p = 0; p < numPriors; ++p)
+        boxes.at(p) = trt::decodeBox(loc + p * 4, priors + p * 4, priors + (numPriors + p) * 4);
+
+    detections.clear();
+    for (int c = 0; c < params.numClasses; ++c) {
+        if (c == params.backgroundLabel)
+            continue;
+
+        std::vector< std::pair<float, int> > scores;
+        for (int p = 0; p < numPriors; ++p)
+            if (conf[p * params.numClasses + c] > params.confidenceThreshold)
+                scores.push_back(std::make_pair(conf[p * params.numClasses + c], p));
+        std::stable_sort(scores.begin(), scores.end(),
+                         [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a.first > b.first; });
+        if ((int)scores.size() > params.topK)
+            scores.resize(params.topK);
+
+        std::vector<int> kept;
+        for (const std::pair<float, int> &s : scores) {
+            bool keep = true;
+            for (int k : kept)
+                if (trt::jaccardOverlap(boxes.at(s.second), boxes.at(k)) > params.nmsThreshold) {
+                    keep = false;
+                    break;
+                }
+            if (keep) {
+                kept.push_back(s.second);
+                detections.push_back({c, s.first, boxes.at(s.second)});
+            }
+        }
+    }
+
+    std::stable_sort(detections.begin(), detections.end(),
+                     [](const trt::Detection &a, const trt::Detection &b) { return a.score > b.score; });
+    if ((int)detections.size() > params.keepTopK)
+        detections.resize(params.keepTopK);
+}
+
+static bool sameDetections(const std::vector<trt::Detection> &a, const std::vector<trt::Detection> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a.at(i).label != b.at(i).label || a.at(i).score != b.at(i).score)
+            return false;
+        if (std::fabs(a.at(i).box.xmin - b.at(i).box.xmin) > 1e-6f || std::fabs(a.at(i).box.ymin - b.at(i).box.ymin) > 1e-6f ||
+            std::fabs(a.at(i).box.xmax - b.at(i).box.xmax) > 1e-6f || std::fabs(a.at(i).box.ymax - b.at(i).box.ymax) > 1e-6f)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int numPriors  = argc > 1 ? std::atoi(argv[1]) : 16384;
+    int batch      = argc > 2 ? std::atoi(argv[2]) : 8;
+    int topK       = argc > 3 ? std::atoi(argv[3]) : 400;
+    int iterations = argc > 4 ? std::atoi(argv[4]) : 20;
+
+    trt::DetectionParams params;
+    params.numClasses = 21;
+    params.topK = topK;
+    params.keepTopK = 200;
+    params.confidenceThreshold = 0.01f;
+    params.nmsThreshold = 0.45f;
+
+    // Priors on a jittered grid, with the SSD variances
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    std::normal_distribution<float> offset(0.f, 1.f);
+
+    std::vector<float> priors(2 * numPriors * 4);
+    for (int p = 0; p < numPriors; ++p) {
+        float cx = uniform(rng), cy = uniform(rng);
+        float w = 0.05f + 0.3f * uniform(rng), h = 0.05f + 0.3f * uniform(rng);
+        float *prior = priors.data() + p * 4;
+        prior[0] = cx - w / 2; prior[1] = cy - h / 2; prior[2] = cx + w / 2; prior[3] = cy + h / 2;
+        float *variance = priors.data() + (numPriors + p) * 4;
+        variance[0] = variance[1] = 0.1f;
+        variance[2] = variance[3] = 0.2f;
+    }
+
+    // Softmax scores with random peaks, so most priors pass the threshold
+    std::vector<float> loc(batch * numPriors * 4), conf(batch * numPriors * params.numClasses);
+    for (float &v : loc)
+        v = offset(rng);
+    for (int i = 0; i < batch * numPriors; ++i) {
+        float *row = conf.data() + i * params.numClasses;
+        float sum = 0.f;
+        for (int c = 0; c < params.numClasses; ++c) {
+            row[c] = std::exp(3.f * uniform(rng));
+            sum += row[c];
+        }
+        for (int c = 0; c < params.numClasses; ++c)
+            row[c] /= sum;
+    }
+
+    size_t numCandidates = 0;
+    for (int p = 0; p < numPriors; ++p)
+        for (int c = 1; c < params.numClasses; ++c)
+            numCandidates += conf.at(p * params.numClasses + c) > params.confidenceThreshold;
+    TRTLog(trt::INFO) << numPriors << " priors, " << numCandidates << " candidates over the threshold in image 0, top-"
+                      << params.topK << " per class, batch " << batch;
+
+    trt::DetectionOutput output(params);
+    std::vector< std::vector<trt::Detection> > detections, reference(batch);
+
+    const size_t locPerBatch = numPriors * 4, confPerBatch = numPriors * params.numClasses;
+
+    Clock::time_point start = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (int n = 0; n < batch; ++n)
+            referenceImage(loc.data() + n * locPerBatch, conf.data() + n * confPerBatch, priors.data(),
+                           numPriors, params, reference.at(n));
+    double referenceMs = elapsedMs(start) / iterations;
+
+    output.forward(loc.data(), conf.data(), priors.data(), batch, numPriors, detections); // Warm up the scratch buffers
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        output.forward(loc.data(), conf.data(), priors.data(), batch, numPriors, detections);
+    double optimizedMs = elapsedMs(start) / iterations;
+
+    bool passed = true;
+    for (int n = 0; n < batch; ++n)
+        passed = passed && sameDetections(detections.at(n), reference.at(n));
+
+    TRTLog(trt::INFO) << "reference: " << referenceMs << " ms/batch";
+#ifdef __AVX__
+    TRTLog(trt::INFO) << "DetectionOutput (AVX): " << optimizedMs << " ms/batch, " << referenceMs / optimizedMs << "x";
+#else
+    TRTLog(trt::INFO) << "DetectionOutput (scalar): " << optimizedMs << " ms/batch, " << referenceMs / optimizedMs << "x";
+#endif
+    if (!detections.at(0).empty())
+        TRTLog(trt::INFO) << "top detection of image 0: " << detections.at(0).at(0);
+    TRTLog(passed ? trt::INFO : trt::ERROR) << (passed ? "PASSED" : "FAILED: detections differ from the reference");
+    return passed ? 0 : 1;
+}
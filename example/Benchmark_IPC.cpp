@@ -0,0 +1,150 @@
+/**
+ * This benchmark measures the round-trip latency and the throughput of
+ * the shared memory inference server with several client processes.
+ *
+ * The server runs a fake executor on the CPU which writes twice its input
+ * to its output, so no GPU is needed and every client checks the results
+ * it receives. The exit code is non-zero if any result is wrong.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Latency.hpp"
+#include "TRTNetwork/InferenceServer.hpp"
+#include "TRTNetwork/InferenceClient.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static const char *SHM_NAME = "trt_benchmark_ipc";
+static const int SAMPLE_SIZE = 3 * 227 * 227;
+static const int NUM_CLASSES = 1000;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Pageable host memory; the ring needs no page-locking on CPU.
+ */
+class HeapAllocator : public trt::HostAllocator
+{
+public:
+    void* allocate(size_t bytes, size_t alignment) override { (void)alignment; return std::malloc(bytes); }
+    void deallocate(void *ptr) override { std::free(ptr); }
+    bool registerMemory(void *ptr, size_t bytes) override { (void)ptr; (void)bytes; return true; }
+    void unregisterMemory(void *ptr) override { (void)ptr; }
+};
+
+class FakeExecutor : public trt::Executor
+{
+public:
+    bool execute(const std::string &model, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict) override
+    {
+        (void)model;
+        const float *data = static_cast<const float*>(feedDict.at(0).second);
+        float *prob = static_cast<float*>(feedDict.at(1).second);
+        for (int n = 0; n < batchSize; ++n)
+            for (int i = 0; i < NUM_CLASSES; ++i)
+                prob[n * NUM_CLASSES + i] = 2.0f * data[n * SAMPLE_SIZE + i];
+        return true;
+    }
+};
+
+/**
+ * @return errors   Number of wrong results.
+ */
+static int runClient(int id, int iterations, int batch, bool copy)
+{
+    trt::InferenceClient client;
+    if (!client.connect(SHM_NAME))
+        return 1;
+
+    std::vector<float> data(batch * SAMPLE_SIZE), prob(batch * NUM_CLASSES);
+    std::vector<double> latencies;
+    int errors = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        const float value = id * 1000.0f + it;
+        Clock::time_point start = Clock::now();
+
+        if (copy) {
+            // Preprocess into a private buffer, as with TRTNetwork::forward
+            std::fill(data.begin(), data.end(), value);
+            errors += !client.infer("fake", batch, {{"data", data.data()}, {"prob", prob.data()}});
+        } else {
+            // Preprocess directly into the shared slot
+            uint64_t ticket;
+            if (!client.acquire(ticket))
+                return errors + 1;
+            float *in = static_cast<float*>(client.getTensor(ticket, "fake", "data"));
+            std::fill(in, in + batch * SAMPLE_SIZE, value);
+            errors += !client.run(ticket, "fake", batch);
+            const float *out = static_cast<const float*>(client.getTensor(ticket, "fake", "prob"));
+            std::copy(out, out + batch * NUM_CLASSES, prob.begin());
+            client.release(ticket);
+        }
+
+        latencies.push_back(elapsedMs(start));
+        for (int i = 0; i < batch * NUM_CLASSES; ++i)
+            if (prob.at(i) != 2.0f * value) {
+                ++errors;
+                break;
+            }
+    }
+
+    TRTLog(trt::INFO) << "client " << id << (copy ? " (copy)" : " (in place)") << ": latency "
+                      << trt::summarizeLatencies(latencies) << ", errors " << errors;
+    return errors;
+}
+
+int main(int argc, char** argv)
+{
+    int numClients = argc > 1 ? std::atoi(argv[1]) : 4;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int batch      = argc > 3 ? std::atoi(argv[3]) : 1;
+    int numSlots   = argc > 4 ? std::atoi(argv[4]) : 16;
+
+    FakeExecutor executor;
+    int failures = 0;
+
+    for (int copy = 0; copy < 2; ++copy) {
+        trt::InferenceServer server(SHM_NAME, executor, numSlots, std::make_shared<HeapAllocator>());
+        server.addModel("fake", batch, {{"data", SAMPLE_SIZE * sizeof(float)}}, {{"prob", NUM_CLASSES * sizeof(float)}});
+        if (!server.open())
+            return 1;
+        server.start();
+
+        Clock::time_point start = Clock::now();
+        std::vector<pid_t> children;
+        for (int id = 0; id < numClients; ++id) {
+            pid_t pid = fork();
+            if (pid == 0)
+                _exit(runClient(id, iterations, batch, copy) ? 1 : 0); // Skip the server destructor
+            children.push_back(pid);
+        }
+
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            failures += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        }
+        double ms = elapsedMs(start);
+
+        TRTLog(trt::INFO) << (copy ? "copy" : "in place") << ": " << server.getNumServed() << " requests from "
+                          << numClients << " processes in " << ms << " ms, "
+                          << server.getNumServed() * batch / (ms * 1e-3) << " samples/s";
+    }
+
+    TRTLog(failures ? trt::ERROR : trt::INFO) << (failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
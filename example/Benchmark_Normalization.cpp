@@ -0,0 +1,153 @@
+/**
+ * This benchmark compares the host-side normalization of Transformer::preprocess,
+ * which uploads 4-byte floats, with the raw 8-bit input of a network whose
+ * normalization is folded into the engine (see InputNormalization).
+ *
+ * Without a model it runs on the CPU only: the normalization computed by
+ * the folded engine, i.e. normalizeReference() of the raw pixels, is checked
+ * against Transformer::preprocess, and the validation of the parameters is
+ * exercised. Given a model, the outputs of both networks are compared too:
+ *
+ *   benchmark_normalization iterations [deploy.prototxt network.caffemodel input_blob output_blob]
+ *
+ * The benchmark exits with a non-zero status if any check fails.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/TRTNetwork.hpp"
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Normalization.hpp"
+#include "TRTNetwork/Transformer.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static int volumeOf(const std::vector<int>& shape)
+{
+    int vol = 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return vol;
+}
+
+static float maxAbsDiff(const float *a, const float *b, size_t count)
+{
+    float diff = 0.f;
+    for (size_t i = 0; i < count; ++i)
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    return diff;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 && argc != 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " iterations [deploy.prototxt network.caffemodel input_blob output_blob]" << std::endl;
+        return 1;
+    }
+    int iterations = std::max(1, std::atoi(argv[1]));
+
+    trt::InputNormalization normalization;
+    normalization.mean = {104.0069879317889f, 116.66876761696767f, 122.6789143406786f};
+
+    // The parameters must fit the input
+    trt::InputNormalization invalid = normalization;
+    invalid.channelOrder = {0, 0, 1};
+    if (!normalization.validate(3) || normalization.validate(1) || invalid.validate(3)) {
+        TRTLog(trt::ERROR) << "FAILED: validation of the normalization parameters";
+        return 1;
+    }
+
+    std::unique_ptr<trt::TRTNetwork> network, folded;
+    std::string inputBlob, outputBlob;
+    std::vector<int> shape = {3, 227, 227};
+    if (argc == 6) {
+        inputBlob = argv[4];
+        outputBlob = argv[5];
+        network.reset(new trt::TRTNetwork("float_input", argv[2], argv[3], {outputBlob}, {inputBlob}));
+        folded.reset(new trt::TRTNetwork("raw_input", argv[2], argv[3], {outputBlob}, {inputBlob},
+                                         1, 0, 0, 1 << 25, &normalization));
+        shape = network->getBlobShape(inputBlob);
+    }
+    const int sizePerBatch = volumeOf(shape);
+
+    trt::Transformer transformer;
+    transformer.set_mean(normalization.mean);
+    transformer.set_input_shape(shape);
+
+    cv::Mat img(375, 500, CV_8UC3);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> pixel(0, 255);
+    for (int r = 0; r < img.rows; ++r)
+        for (int c = 0; c < img.cols * 3; ++c)
+            img.ptr<uchar>(r)[c] = (uchar)pixel(rng);
+
+    std::vector<float> data(sizePerBatch), reference(sizePerBatch);
+    std::vector<uint8_t> raw(sizePerBatch);
+
+    Clock::time_point start = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        transformer.preprocess(data.data(), img);
+    double floatMs = elapsedMs(start) / iterations;
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        transformer.preprocessRaw(raw.data(), img);
+    double rawMs = elapsedMs(start) / iterations;
+
+    trt::normalizeReference(raw.data(), shape.at(1), shape.at(2), shape.at(0), normalization, reference.data());
+    float diff = maxAbsDiff(data.data(), reference.data(), sizePerBatch);
+    TRTLog(trt::INFO) << "Host preprocessing: float " << floatMs << " ms (" << sizePerBatch * sizeof(float)
+                      << " bytes), raw " << rawMs << " ms (" << sizePerBatch << " bytes), max abs diff " << diff;
+    if (diff > 1e-4f) {
+        TRTLog(trt::ERROR) << "FAILED: the folded normalization differs from Transformer::preprocess";
+        return 1;
+    }
+
+    if (!network)
+        return 0;
+
+    std::vector<int> outputShape = network->getBlobShape(outputBlob);
+    const int outputSize = volumeOf(outputShape);
+    outputShape.insert(outputShape.begin(), 1);
+    std::vector<float> floatOutput(outputSize), rawOutput(outputSize);
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        transformer.preprocess(data.data(), img);
+        network->forward(1, {{inputBlob, data.data()}, {outputBlob, floatOutput.data()}});
+    }
+    floatMs = elapsedMs(start) / iterations;
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        transformer.preprocessRaw(raw.data(), img);
+        if (!folded->forward({{inputBlob, trt::TensorView(raw.data(), {1, shape.at(1), shape.at(2), shape.at(0)},
+                                                          trt::DType::kUINT8)},
+                              {outputBlob, trt::TensorView(rawOutput.data(), outputShape)}}))
+            return 1;
+    }
+    rawMs = elapsedMs(start) / iterations;
+
+    diff = maxAbsDiff(floatOutput.data(), rawOutput.data(), outputSize);
+    TRTLog(trt::INFO) << "Inference: float input " << floatMs << " ms, raw input " << rawMs
+                      << " ms, speedup " << floatMs / rawMs << "x, max abs diff " << diff;
+    if (diff > 1e-3f) {
+        TRTLog(trt::ERROR) << "FAILED: the outputs of the folded network differ";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * This benchmark compares test-time augmentation with the per-crop loop,
+ * i.e. cropping and mirroring each of the 10 oversampled crops, followed by
+ * Transformer::preprocess and forward(1), against the batched
+ * Transformer::preprocessOversample and a single forward of Oversampler.
+ *
+ * The preprocessing is always compared. Given a model, the whole
+ * classification is compared too:
+ *
+ *   benchmark_oversample [iterations] [deploy.prototxt network.caffemodel input_blob output_blob]
+ *
+ * The batched outputs are checked against the per-crop loop and the
+ * benchmark exits with a non-zero status if they differ.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/TRTNetwork.hpp"
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Oversample.hpp"
+#include "TRTNetwork/Transformer.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static int volumeOf(const std::vector<int>& shape)
+{
+    int vol = 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return vol;
+}
+
+static float maxAbsDiff(const float *a, const float *b, size_t count)
+{
+    float diff = 0.f;
+    for (size_t i = 0; i < count; ++i)
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    return diff;
+}
+
+/**
+ * @brief The crops of caffe.io.oversample, one preprocess() per crop.
+ */
+static void preprocessPerCrop(trt::Transformer &transformer, const cv::Mat &img, const cv::Size &resizeDims,
+                              const cv::Size &cropDims, int sizePerBatch, float *batch_ptr)
+{
+    cv::Mat resized;
+    cv::resize(img, resized, resizeDims);
+
+    const int xEnd = resizeDims.width - cropDims.width, yEnd = resizeDims.height - cropDims.height;
+    const cv::Point origins[] = {
+        cv::Point(0, 0), cv::Point(xEnd, 0), cv::Point(0, yEnd), cv::Point(xEnd, yEnd),
+        cv::Point(xEnd / 2, yEnd / 2)
+    };
+
+    for (int n = 0; n < trt::OVERSAMPLE_CROPS / 2; ++n) {
+        cv::Mat crop = resized(cv::Rect(origins[n].x, origins[n].y, cropDims.width, cropDims.height));
+        cv::Mat mirrored;
+        cv::flip(crop, mirrored, 1);
+        transformer.preprocess(batch_ptr + n * sizePerBatch, crop);
+        transformer.preprocess(batch_ptr + (n + trt::OVERSAMPLE_CROPS / 2) * sizePerBatch, mirrored);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 && argc != 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " iterations [deploy.prototxt network.caffemodel input_blob output_blob]" << std::endl;
+        return 1;
+    }
+    int iterations = std::max(1, std::atoi(argv[1]));
+
+    const cv::Size resizeDims(256, 256);
+    std::vector<int> shape = {3, 227, 227};
+
+    std::unique_ptr<trt::TRTNetwork> network;
+    std::string inputBlob, outputBlob;
+    if (argc == 6) {
+        inputBlob = argv[4];
+        outputBlob = argv[5];
+        network.reset(new trt::TRTNetwork("oversample", argv[2], argv[3], {outputBlob}, {inputBlob},
+                                          trt::OVERSAMPLE_CROPS));
+        shape = network->getBlobShape(inputBlob);
+    }
+
+    const cv::Size cropDims(shape.at(2), shape.at(1));
+    const int sizePerBatch = volumeOf(shape);
+
+    trt::Transformer transformer;
+    transformer.set_mean({104.0069879317889, 116.66876761696767, 122.6789143406786});
+    transformer.set_input_shape(shape);
+
+    cv::Mat img(375, 500, CV_8UC3);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> pixel(0, 255);
+    for (int r = 0; r < img.rows; ++r)
+        for (int c = 0; c < img.cols * 3; ++c)
+            img.ptr<uchar>(r)[c] = (uchar)pixel(rng);
+
+    // Preprocessing only
+    std::vector<float> loopBatch(trt::OVERSAMPLE_CROPS * sizePerBatch);
+    std::vector<float> batchedBatch(trt::OVERSAMPLE_CROPS * sizePerBatch);
+
+    Clock::time_point start = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        preprocessPerCrop(transformer, img, resizeDims, cropDims, sizePerBatch, loopBatch.data());
+    double loopMs = elapsedMs(start) / iterations;
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        transformer.preprocessOversample(batchedBatch.data(), img, resizeDims);
+    double batchedMs = elapsedMs(start) / iterations;
+
+    float diff = maxAbsDiff(loopBatch.data(), batchedBatch.data(), loopBatch.size());
+    TRTLog(trt::INFO) << "Preprocessing: per-crop " << loopMs << " ms, batched " << batchedMs
+                      << " ms, speedup " << loopMs / batchedMs << "x, max abs diff " << diff;
+    if (diff > 1e-5f) {
+        TRTLog(trt::ERROR) << "FAILED: the oversampled crops differ from the per-crop loop";
+        return 1;
+    }
+
+    if (!network)
+        return 0;
+
+    // Whole classification
+    const int outputSize = volumeOf(network->getBlobShape(outputBlob));
+    std::vector<float> outputs(trt::OVERSAMPLE_CROPS * outputSize);
+    std::vector<float> loopScores(outputSize);
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        preprocessPerCrop(transformer, img, resizeDims, cropDims, sizePerBatch, loopBatch.data());
+        for (int n = 0; n < trt::OVERSAMPLE_CROPS; ++n)
+            network->forward(1, {{inputBlob, loopBatch.data() + n * sizePerBatch},
+                                 {outputBlob, outputs.data() + n * outputSize}});
+        trt::reduceCrops(outputs.data(), trt::OVERSAMPLE_CROPS, outputSize, trt::CropReduction::kMEAN,
+                         loopScores.data());
+    }
+    loopMs = elapsedMs(start) / iterations;
+
+    trt::Oversampler oversampler(*network, transformer, inputBlob, outputBlob, resizeDims);
+    std::vector< std::vector<float> > scores;
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        if (!oversampler.forward({img}, scores))
+            return 1;
+    }
+    batchedMs = elapsedMs(start) / iterations;
+
+    diff = maxAbsDiff(loopScores.data(), scores.at(0).data(), outputSize);
+    TRTLog(trt::INFO) << "Classification: per-crop " << loopMs << " ms, batched " << batchedMs
+                      << " ms, speedup " << loopMs / batchedMs << "x, max abs diff " << diff;
+    if (diff > 1e-4f) {
+        TRTLog(trt::ERROR) << "FAILED: the oversampled scores differ from the per-crop loop";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * This benchmark compares the per-crop Transformer::preprocess loop with
+ * the batched Transformer::preprocessROIs for second-stage classification,
+ * at 10, 50 and 200 boxes per frame.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Transformer.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    const std::vector<int> shape = {3, 227, 227};
+    const int sizePerBatch = shape.at(0) * shape.at(1) * shape.at(2);
+
+    trt::Transformer transformer;
+    transformer.set_mean({104.0069879317889, 116.66876761696767, 122.6789143406786});
+    transformer.set_input_shape(shape);
+
+    // A BGRA frame so that the color conversion is part of the measurement
+    cv::Mat frame(1080, 1920, CV_8UC4);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> pixel(0, 255);
+    for (int r = 0; r < frame.rows; ++r)
+        for (int c = 0; c < frame.cols * 4; ++c)
+            frame.ptr<uchar>(r)[c] = (uchar)pixel(rng);
+
+    for (int numROIs : {10, 50, 200}) {
+        std::uniform_int_distribution<int> x(0, frame.cols - 64), y(0, frame.rows - 64), side(32, 256);
+        std::vector<cv::Rect> rois;
+        for (int i = 0; i < numROIs; ++i)
+            rois.push_back(cv::Rect(x(rng), y(rng), side(rng), side(rng)));
+
+        std::vector<float> batch(numROIs * sizePerBatch);
+
+        Clock::time_point start = Clock::now();
+        for (int it = 0; it < iterations; ++it)
+            for (int n = 0; n < numROIs; ++n)
+                transformer.preprocess(batch.data() + n * sizePerBatch,
+                                       frame(rois.at(n) & cv::Rect(0, 0, frame.cols, frame.rows)));
+        double loopMs = elapsedMs(start) / iterations;
+
+        start = Clock::now();
+        for (int it = 0; it < iterations; ++it)
+            transformer.preprocessROIs(batch.data(), frame, rois);
+        double batchedMs = elapsedMs(start) / iterations;
+
+        TRTLog(trt::INFO) << numROIs << " ROIs: per-crop " << loopMs << " ms, batched "
+                          << batchedMs << " ms, speedup " << loopMs / batchedMs << "x";
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * This benchmark compares the cost of hashing the input tensors for the
+ * ResultCache with the cost of the inference that a cache hit skips.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/TRTNetwork.hpp"
+#include "TRTNetwork/ResultCache.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static int volumeOf(const std::vector<int>& shape)
+{
+    int vol = 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return vol;
+}
+
+static double elapsedUs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " deploy.prototxt network.caffemodel [batch] [iterations]" << std::endl;
+        return 1;
+    }
+
+    std::string model_file   = argv[1];
+    std::string trained_file = argv[2];
+    int batch      = argc > 3 ? std::atoi(argv[3]) : 1;
+    int iterations = argc > 4 ? std::atoi(argv[4]) : 100;
+
+    trt::TRTNetwork caffenet("caffenet", model_file, trained_file, {"prob"}, {"data"}, batch);
+
+    int dataVol = volumeOf(caffenet.getBlobShape("data"));
+    int probVol = volumeOf(caffenet.getBlobShape("prob"));
+    std::vector<float> data(batch * dataVol);
+    std::vector<float> prob(batch * probVol);
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(-128.f, 128.f);
+    for (float &v : data)
+        v = dist(rng);
+
+    std::vector< std::pair<std::string, void*> > feedDict = {{"data", data.data()}, {"prob", prob.data()}};
+
+    // Warm up the engine so that lazy initialization is not measured
+    caffenet.forward(batch, feedDict);
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; ++i)
+        caffenet.forward(batch, feedDict);
+    double forwardUs = elapsedUs(start) / iterations;
+
+    trt::ResultCache cache(64 << 20);
+    trt::Hash128 key;
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i)
+        key = cache.computeKey(caffenet, batch, feedDict);
+    double hashUs = elapsedUs(start) / iterations;
+
+    cache.forward(caffenet, batch, feedDict);
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i)
+        cache.forward(caffenet, batch, feedDict);
+    double hitUs = elapsedUs(start) / iterations;
+
+    double inputMB = batch * dataVol * sizeof(float) / (1024.0 * 1024.0);
+
+    TRTLog(trt::INFO) << "Batch " << batch << ", input " << inputMB << " MB, key " << std::hex << key.hi << key.lo << std::dec;
+    TRTLog(trt::INFO) << "forward():        " << forwardUs << " us";
+    TRTLog(trt::INFO) << "computeKey():     " << hashUs << " us (" << inputMB / (hashUs * 1e-6) << " MB/s)";
+    TRTLog(trt::INFO) << "cache hit total:  " << hitUs << " us";
+    TRTLog(trt::INFO) << "hits " << cache.getHits() << " misses " << cache.getMisses()
+                      << " speedup on hit " << forwardUs / hitUs << "x";
+
+    return 0;
+}
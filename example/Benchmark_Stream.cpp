@@ -0,0 +1,164 @@
+/**
+ * This benchmark compares two ways of feeding batches from many
+ * concurrent video streams:
+ *
+ * 1) Decoding every frame into a new cv::Mat, round-robin over the
+ *    streams on one thread, as the camera pipelines used to do.
+ * 2) VideoSources decoding into recycled frame buffers on their own
+ *    threads, assembled into batches by a StreamBatcher.
+ *
+ * Each local video file is opened --streams times to simulate that many
+ * cameras. The frames/sec, the frames/sec per core of CPU time and the
+ * number of frame buffer allocations are reported.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Transformer.hpp"
+#include "TRTNetwork/VideoSource.hpp"
+#include "TRTNetwork/StreamBatcher.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Result
+{
+    size_t frames = 0;
+    size_t allocations = 0;
+    double wallSec = 0.0;
+    double cpuSec = 0.0;
+};
+
+static double cpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+static void report(const std::string &name, const Result &r)
+{
+    TRTLog(trt::INFO) << name << ": " << r.frames << " frames in " << r.wallSec << " s, "
+                      << r.frames / r.wallSec << " frames/s, "
+                      << r.frames / r.cpuSec << " frames/s per core, "
+                      << r.allocations << " frame allocations";
+}
+
+static Result runNaive(const std::vector<std::string> &uris, int stride, int batch, trt::Transformer &transformer)
+{
+    Result r;
+    std::vector< std::unique_ptr<cv::VideoCapture> > captures;
+    for (const std::string &uri : uris)
+        captures.emplace_back(new cv::VideoCapture(uri));
+
+    std::vector<float> input(batch * transformer.get_sample_size());
+    std::vector<bool> ended(captures.size(), false);
+    size_t numEnded = 0;
+    int slot = 0;
+
+    double cpuStart = cpuSeconds();
+    Clock::time_point start = Clock::now();
+
+    while (numEnded < captures.size()) {
+        for (size_t s = 0; s < captures.size(); ++s) {
+            if (ended.at(s))
+                continue;
+
+            // Every frame is decoded into a fresh cv::Mat, skipped ones included
+            cv::Mat frame;
+            for (int i = 0; i < stride; ++i) {
+                cv::Mat decoded;
+                if (!captures.at(s)->read(decoded)) {
+                    ended.at(s) = true;
+                    ++numEnded;
+                    break;
+                }
+                frame = decoded;
+                ++r.allocations;
+            }
+            if (ended.at(s))
+                continue;
+
+            transformer.preprocess(input.data() + slot * transformer.get_sample_size(), frame);
+            slot = (slot + 1) % batch;
+            ++r.frames;
+        }
+    }
+
+    r.wallSec = std::chrono::duration<double>(Clock::now() - start).count();
+    r.cpuSec = cpuSeconds() - cpuStart;
+    return r;
+}
+
+static Result runPooled(const std::vector<std::string> &uris, int stride, int batch, int buffers,
+                        trt::Transformer &transformer)
+{
+    Result r;
+    std::vector< std::unique_ptr<trt::VideoSource> > sources;
+    trt::StreamBatcher batcher(transformer);
+
+    double cpuStart = cpuSeconds();
+    Clock::time_point start = Clock::now();
+
+    for (const std::string &uri : uris) {
+        sources.emplace_back(new trt::VideoSource(uri, buffers, stride));
+        if (!batcher.addSource(*sources.back()))
+            return r;
+    }
+
+    std::vector<float> input(batch * transformer.get_sample_size());
+    std::vector<trt::FrameInfo> frames;
+    while (int n = batcher.nextBatch(input.data(), batch, frames))
+        r.frames += n;
+
+    r.wallSec = std::chrono::duration<double>(Clock::now() - start).count();
+    r.cpuSec = cpuSeconds() - cpuStart;
+    for (const std::unique_ptr<trt::VideoSource> &source : sources)
+        r.allocations += source->getNumAllocations();
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> files;
+    int streams = 4, batch = 8, stride = 1, buffers = 4;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--streams" && i + 1 < argc)
+            streams = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--batch" && i + 1 < argc)
+            batch = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--stride" && i + 1 < argc)
+            stride = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--buffers" && i + 1 < argc)
+            buffers = std::max(1, std::atoi(argv[++i]));
+        else
+            files.push_back(arg);
+    }
+
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " video [video ...] [--streams N] [--batch B] [--stride S] [--buffers K]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> uris;
+    for (int s = 0; s < streams; ++s)
+        uris.insert(uris.end(), files.begin(), files.end());
+
+    trt::Transformer transformer;
+    transformer.set_input_shape({3, 227, 227});
+    transformer.set_mean({104.f, 117.f, 123.f});
+
+    TRTLog(trt::INFO) << uris.size() << " streams, batch " << batch << ", stride " << stride;
+    report("new cv::Mat per frame", runNaive(uris, stride, batch, transformer));
+    report("recycled frame pool  ", runPooled(uris, stride, batch, buffers, transformer));
+    return 0;
+}
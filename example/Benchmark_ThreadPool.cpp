@@ -0,0 +1,184 @@
+/**
+ * This benchmark measures how the CPU-side stages scale with the number of
+ * threads, running parallel loops of uneven items (like the images of a
+ * batch with different numbers of boxes) on the work-stealing ThreadPool
+ * and on a naive fan-out, which spawns std::threads per loop and splits
+ * the items into equal contiguous chunks:
+ *
+ *   benchmark_thread_pool [iterations] [--threads N] [--affinity none|cores|nodes]
+ *                         [--items N] [--cost N]
+ *
+ * The thread count doubles from 1 up to N, every CPU allowed by default.
+ * The results of both are checked against a serial run, and nested loops
+ * and NUMA-local allocations are exercised; the exit code is non-zero if
+ * any check fails.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/ThreadPool.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief One item: write then reduce a scratch buffer. Every 8th item is
+ *        8 times as expensive, so that equal chunks are unbalanced.
+ */
+static float processItem(int item, int cost)
+{
+    static thread_local std::vector<float> scratch;
+    const int length = cost * (item % 8 == 0 ? 8 : 1);
+    if ((int)scratch.size() < length)
+        scratch.resize(length);
+
+    for (int k = 0; k < length; ++k)
+        scratch[k] = std::sin(item + k * 1e-3f);
+    float sum = 0.f;
+    for (int k = 0; k < length; ++k)
+        sum += std::sqrt(std::fabs(scratch[k]));
+    return sum;
+}
+
+static void naiveFor(int numThreads, int count, const std::function<void(int)> &body)
+{
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = t * count / numThreads; i < (t + 1) * count / numThreads; ++i)
+                body(i);
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+static bool checkNested(trt::ThreadPool &pool)
+{
+    const int outer = 16, inner = 64;
+    std::vector<int> hits(outer * inner, 0);
+    pool.parallelFor(0, outer, [&](int i) {
+        pool.parallelFor(0, inner, [&](int j) {
+            ++hits.at(i * inner + j);
+        });
+    });
+    return std::count(hits.begin(), hits.end(), 1) == (int)hits.size();
+}
+
+static bool checkAllocation(trt::ThreadPool &pool)
+{
+    const size_t bytes = 1 << 22;
+    for (int node = 0; node < pool.getTopology().numNodes(); ++node) {
+        if (pool.getTopology().nodeCpus.at(node).empty())
+            continue;
+        unsigned char *ptr = (unsigned char*)pool.allocateOnNode(bytes, node);
+        if (!ptr)
+            return false;
+        bool zeroed = std::count(ptr, ptr + bytes, 0) == (long)bytes;
+        std::free(ptr);
+        if (!zeroed)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 50, maxThreads = 0, items = 64, cost = 20000;
+    trt::Affinity affinity = trt::Affinity::kNONE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            maxThreads = std::atoi(argv[++i]);
+        } else if (arg == "--items" && i + 1 < argc) {
+            items = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--cost" && i + 1 < argc) {
+            cost = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--affinity" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "cores")
+                affinity = trt::Affinity::kCORES;
+            else if (value == "nodes")
+                affinity = trt::Affinity::kNODES;
+            else if (value != "none")
+                maxThreads = -1;
+        } else if (std::atoi(arg.c_str()) > 0) {
+            iterations = std::atoi(arg.c_str());
+        } else {
+            maxThreads = -1;
+        }
+    }
+    if (maxThreads < 0) {
+        std::cerr << "Usage: " << argv[0] << " [iterations] [--threads N] [--affinity none|cores|nodes]"
+                  << " [--items N] [--cost N]" << std::endl;
+        return 1;
+    }
+
+    trt::ThreadPoolOptions options;
+    options.affinity = affinity;
+    if (maxThreads == 0)
+        maxThreads = trt::ThreadPool(options).getNumThreads();
+
+    std::vector<float> reference(items), results(items);
+    for (int i = 0; i < items; ++i)
+        reference.at(i) = processItem(i, cost);
+    auto body = [&](int i) { results.at(i) = processItem(i, cost); };
+
+    std::vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    double naiveBase = 0.0, poolBase = 0.0;
+    for (int numThreads : counts) {
+        std::fill(results.begin(), results.end(), 0.f);
+        Clock::time_point start = Clock::now();
+        for (int it = 0; it < iterations; ++it)
+            naiveFor(numThreads, items, body);
+        double naiveMs = elapsedMs(start) / iterations;
+        if (results != reference) {
+            TRTLog(trt::ERROR) << "FAILED: the std::thread fan-out differs from the serial run";
+            return 1;
+        }
+
+        options.numThreads = numThreads;
+        trt::ThreadPool pool(options);
+        std::fill(results.begin(), results.end(), 0.f);
+        start = Clock::now();
+        for (int it = 0; it < iterations; ++it)
+            pool.parallelFor(0, items, body);
+        double poolMs = elapsedMs(start) / iterations;
+        if (results != reference) {
+            TRTLog(trt::ERROR) << "FAILED: the thread pool differs from the serial run";
+            return 1;
+        }
+
+        if (!checkNested(pool) || !checkAllocation(pool)) {
+            TRTLog(trt::ERROR) << "FAILED: nested loops or NUMA-local allocations of the thread pool";
+            return 1;
+        }
+
+        if (numThreads == 1) {
+            naiveBase = naiveMs;
+            poolBase = poolMs;
+        }
+        TRTLog(trt::INFO) << numThreads << " threads: std::thread " << naiveMs << " ms (scaling "
+                          << naiveBase / naiveMs << "x), pool " << poolMs << " ms (scaling " << poolBase / poolMs
+                          << "x), speedup " << naiveMs / poolMs << "x";
+    }
+
+    return 0;
+}
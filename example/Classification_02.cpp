@@ -5,25 +5,10 @@
 #include <utility>
 #include <vector>
 
-#include "caffe/caffe.hpp"
-
 #include "TRTNetwork/TRTNetwork.hpp"
 #include "TRTNetwork/Transformer.hpp"
-
-static std::vector<std::string> readLabels(std::string label_file)
-{
-    std::ifstream labels_st(label_file.c_str());
-    if (!labels_st) {
-        TRTLog(trt::ERROR) << "Unable to open labels file " << label_file;
-        exit(1);
-    }
-
-    std::vector<std::string> labels;
-    std::string line;
-    while (std::getline(labels_st, line))
-        labels.push_back(std::string(line));
-    return labels;
-}
+#include "TRTNetwork/CaffeIO.hpp"
+#include "TRTNetwork/HostTensorPool.hpp"
 
 static int volumeOf(const std::vector<int>& shape)
 {
@@ -42,31 +27,36 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    ::google::InitGoogleLogging(argv[0]);
-
     std::string model_file   = argv[1];
     std::string trained_file = argv[2];
     std::string mean_file    = argv[3];
     std::string label_file   = argv[4];
     std::string img_file     = argv[5];
 
-    std::vector<std::string> labels = readLabels(label_file);
+    std::vector<std::string> labels;
+    if (!trt::readLabels(label_file, labels))
+        exit(1);
+
+    trt::BlobData mean_blob;
+    if (!trt::readBlobProto(mean_file, mean_blob))
+        exit(1);
 
     trt::TRTNetwork caffenet("caffenet", model_file, trained_file, {"prob"}, {"data"});
 
     trt::Transformer transformer;
     transformer.set_transpose({2, 0, 1});
-    transformer.set_mean({104.0069879317889, 116.66876761696767, 122.6789143406786});
+    transformer.set_mean(trt::channelMean(mean_blob));
     transformer.set_raw_scale(255.0f);
     transformer.set_channel_swap({2, 1, 0});
     transformer.set_input_shape(caffenet.getBlobShape("data"));
 
-    float *data_ptr = new float[volumeOf(caffenet.getBlobShape("data"))];
-    float *prob_ptr = new float[volumeOf(caffenet.getBlobShape("prob"))];
+    trt::HostTensorPool pool;
+    float *data_ptr = pool.acquire(caffenet, "data");
+    float *prob_ptr = pool.acquire(caffenet, "prob");
 
     cv::Mat img = cv::imread(img_file, -1);
     if (img.empty()) {
-        TRTLog(trt::ERROR) << "Unable to decode image " << img;
+        TRTLog(trt::ERROR) << "Unable to decode image " << img_file;
         exit(1);
     }
 
@@ -83,8 +73,8 @@ int main(int argc, char** argv)
                       << " index: " << topPred.second
                       << " label: " << labels.at(topPred.second);
 
-    delete[] data_ptr;
-    delete[] prob_ptr;
+    pool.release(data_ptr);
+    pool.release(prob_ptr);
 
     return 0;
 }
@@ -0,0 +1,80 @@
+/**
+ * Static cost model and capacity planner.
+ *
+ * Reports the per-layer and total compute and memory of a Caffe network
+ * from its deploy prototxt alone, without a GPU, and estimates how many
+ * instances or what max batch size fit a device memory budget:
+ *
+ *   plan_capacity deploy.prototxt [--output blob]... [--height H --width W]
+ *                 [--batch N] [--workspace-mb W] [--budget-mb B]
+ *
+ * --height and --width resize the first input like the inputHeight and
+ * inputWidth arguments of TRTNetwork.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/CostModel.hpp"
+#include "TRTNetwork/Logger.hpp"
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> outputs, args;
+    int inputHeight = 0, inputWidth = 0, batchSize = 1;
+    size_t workspace = 1 << 25, budget = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc)
+            outputs.push_back(argv[++i]);
+        else if (arg == "--height" && i + 1 < argc)
+            inputHeight = std::atoi(argv[++i]);
+        else if (arg == "--width" && i + 1 < argc)
+            inputWidth = std::atoi(argv[++i]);
+        else if (arg == "--batch" && i + 1 < argc)
+            batchSize = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--workspace-mb" && i + 1 < argc)
+            workspace = (size_t)(std::atof(argv[++i]) * (1 << 20));
+        else if (arg == "--budget-mb" && i + 1 < argc)
+            budget = (size_t)(std::atof(argv[++i]) * (1 << 20));
+        else
+            args.push_back(arg);
+    }
+
+    if (args.size() != 1) {
+        std::cerr << "Usage: " << argv[0] << " deploy.prototxt [--output blob]... [--height H --width W]"
+                  << " [--batch N] [--workspace-mb W] [--budget-mb B]" << std::endl;
+        return 1;
+    }
+
+    trt::NetworkCost cost;
+    if (!trt::estimateCost(args.at(0), outputs, cost, inputHeight, inputWidth))
+        return 1;
+
+    for (const trt::LayerCost &layer : cost.layers)
+        TRTLog(trt::INFO) << layer;
+
+    for (const std::string &blob : cost.inputs) {
+        std::stringstream ss;
+        for (int d : cost.blobShapes.at(blob))
+            ss << " " << d;
+        TRTLog(trt::INFO) << "Input " << blob << ":" << ss.str();
+    }
+    TRTLog(trt::INFO) << "Total: " << cost;
+    TRTLog(trt::INFO) << "Batch " << batchSize << ": " << cost.flops * batchSize * 1e-9 << " GFLOP, footprint "
+                      << cost.estimateFootprint(batchSize, workspace);
+
+    if (budget) {
+        int maxBatch = cost.maxBatchSizeWithin(budget, workspace);
+        int instances = cost.maxInstancesWithin(budget, batchSize, workspace);
+        TRTLog(maxBatch ? trt::INFO : trt::ERROR) << "Budget " << budget << " bytes: one instance up to max batch size "
+                                                  << maxBatch << ", or " << instances << " instances of max batch size "
+                                                  << batchSize;
+        return maxBatch ? 0 : 1;
+    }
+
+    return 0;
+}
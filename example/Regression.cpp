@@ -0,0 +1,356 @@
+/**
+ * Accuracy-vs-speed regression harness.
+ *
+ * Runs a set of models through TRTNetwork and records the throughput,
+ * the latency and the divergence of the outputs from a reference. The
+ * reference is Caffe itself when built with USE_CAFFE (on the CPU with
+ * --cpu-reference), otherwise the golden tensors recorded by a previous
+ * run with --record. Two recorded golden files can also be compared
+ * without any GPU using --compare.
+ *
+ * With USE_CAFFE, --record --cpu-reference records the golden tensors of
+ * Caffe on the CPU alone, without building any engine, so that they can
+ * be produced on a host without a GPU.
+ *
+ * The models file lists one model per line:
+ *
+ *   name deploy.prototxt network.caffemodel mean.binaryproto input_blob output_blob
+ *
+ * The images file lists one image path per line, relative to the images
+ * file itself unless absolute. Golden tensors are keyed by that relative
+ * path, so they stay valid when the dataset is moved. Blank lines and
+ * lines starting with '#' are skipped in both files.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef USE_CAFFE
+#include "caffe/caffe.hpp"
+#endif
+
+#include "TRTNetwork/TRTNetwork.hpp"
+#include "TRTNetwork/Transformer.hpp"
+#include "TRTNetwork/CaffeIO.hpp"
+#include "TRTNetwork/Regression.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct ModelSpec
+{
+    std::string name, deploy, model, mean, input, output;
+};
+
+struct ImageEntry
+{
+    std::string path; // To read the image from
+    std::string key;  // Relative to the images file, the key of its golden tensors
+};
+
+struct Options
+{
+    std::string goldenDir;
+    bool record = false;
+    bool cpuReference = false;
+    int batch = 1;
+    float maxAbsError = 1e-3f;
+    double minTop1 = 0.99;
+};
+
+static int volumeOf(const std::vector<int>& shape)
+{
+    int vol = 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return vol;
+}
+
+static bool readModels(const std::string& path, std::vector<ModelSpec>& models)
+{
+    std::vector<std::string> lines;
+    if (!trt::readLines(path, lines))
+        return false;
+    for (const std::string& line : lines) {
+        std::istringstream ss(line);
+        ModelSpec spec;
+        if (ss >> spec.name >> spec.deploy >> spec.model >> spec.mean >> spec.input >> spec.output)
+            models.push_back(spec);
+        else
+            TRTLog(trt::WARN) << "Skipping malformed model line: " << line;
+    }
+    return !models.empty();
+}
+
+/**
+ * @brief Read the images file. Relative paths are resolved against its
+ *        directory, and absolute paths below it are keyed relative to it.
+ */
+static bool readImages(const std::string& path, std::vector<ImageEntry>& images)
+{
+    std::vector<std::string> lines;
+    if (!trt::readLines(path, lines))
+        return false;
+
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    for (const std::string& line : lines) {
+        ImageEntry entry;
+        if (line.at(0) == '/') {
+            entry.path = line;
+            bool below = !dir.empty() && dir.at(0) == '/' && line.compare(0, dir.size(), dir) == 0;
+            entry.key = below ? line.substr(dir.size()) : line;
+        } else {
+            entry.path = dir + line;
+            entry.key = line.compare(0, 2, "./") == 0 ? line.substr(2) : line;
+        }
+        images.push_back(entry);
+    }
+    return !images.empty();
+}
+
+#ifdef USE_CAFFE
+/**
+ * @brief Run the Caffe reference on the already preprocessed batch.
+ */
+class CaffeReference
+{
+public:
+    CaffeReference(const ModelSpec& spec, bool cpu)
+        : spec(spec)
+    {
+        caffe::Caffe::set_mode(cpu ? caffe::Caffe::CPU : caffe::Caffe::GPU);
+        net.reset(new caffe::Net<float>(spec.deploy, caffe::TEST));
+        net->CopyTrainedLayersFrom(spec.model);
+    }
+
+    /**
+     * @brief Shape of a blob without the batch, like TRTNetwork::getBlobShape.
+     */
+    std::vector<int> getBlobShape(const std::string& name) const
+    {
+        std::vector<int> shape = net->blob_by_name(name)->shape();
+        shape.erase(shape.begin());
+        return shape;
+    }
+
+    void forward(const float* input, int batch, float* output)
+    {
+        caffe::Blob<float>* blob = net->blob_by_name(spec.input).get();
+        std::vector<int> shape = blob->shape();
+        shape.at(0) = batch;
+        blob->Reshape(shape);
+        net->Reshape();
+        std::memcpy(blob->mutable_cpu_data(), input, blob->count() * sizeof(float));
+
+        net->Forward();
+
+        const caffe::Blob<float>* out = net->blob_by_name(spec.output).get();
+        std::memcpy(output, out->cpu_data(), out->count() * sizeof(float));
+    }
+
+private:
+    ModelSpec spec;
+    std::shared_ptr< caffe::Net<float> > net;
+};
+#endif
+
+/**
+ * @return passed   Whether the model stays within the accuracy thresholds.
+ */
+static bool runModel(const ModelSpec& spec, const std::vector<ImageEntry>& images, const Options& opt)
+{
+#ifdef USE_CAFFE
+    // Recording the CPU reference needs no engine, nor any GPU
+    const bool referenceOnly = opt.record && opt.cpuReference;
+    CaffeReference caffeRef(spec, opt.cpuReference);
+#else
+    const bool referenceOnly = false;
+#endif
+
+    std::unique_ptr<trt::TRTNetwork> network;
+    std::vector<int> inputShape, outputShape;
+    if (!referenceOnly) {
+        network.reset(new trt::TRTNetwork(spec.name, spec.deploy, spec.model, {spec.output}, {spec.input},
+                                          opt.batch));
+        inputShape = network->getBlobShape(spec.input);
+        outputShape = network->getBlobShape(spec.output);
+    }
+#ifdef USE_CAFFE
+    else {
+        inputShape = caffeRef.getBlobShape(spec.input);
+        outputShape = caffeRef.getBlobShape(spec.output);
+    }
+#endif
+
+    trt::BlobData meanBlob;
+    if (!trt::readBlobProto(spec.mean, meanBlob))
+        return false;
+
+    trt::Transformer transformer;
+    transformer.set_mean(trt::channelMean(meanBlob));
+    transformer.set_input_shape(inputShape);
+
+    const int inputVol = volumeOf(inputShape);
+    const int outputVol = volumeOf(outputShape);
+    std::vector<float> input(opt.batch * inputVol);
+    std::vector<float> output(opt.batch * outputVol);
+    std::vector<float> refOutput(opt.batch * outputVol);
+
+    trt::GoldenSet test, reference;
+    std::vector<double> latencies;
+    double totalMs = 0.0;
+    int numImages = 0;
+
+    for (size_t begin = 0; begin < images.size(); begin += opt.batch) {
+        int batch = (int)std::min(images.size() - begin, (size_t)opt.batch);
+        for (int n = 0; n < batch; ++n) {
+            cv::Mat img = cv::imread(images.at(begin + n).path, -1);
+            if (img.empty()) {
+                TRTLog(trt::ERROR) << "Unable to decode image " << images.at(begin + n).path;
+                return false;
+            }
+            if (!transformer.preprocess(input.data() + n * inputVol, img)) {
+                TRTLog(trt::ERROR) << "Unable to preprocess image " << images.at(begin + n).path;
+                return false;
+            }
+        }
+
+        if (network) {
+            Clock::time_point start = Clock::now();
+            if (!network->forward(batch, {{spec.input, input.data()}, {spec.output, output.data()}})) {
+                TRTLog(trt::ERROR) << "Error occurs during forward() of " << spec.name;
+                return false;
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            latencies.push_back(ms);
+            totalMs += ms;
+            numImages += batch;
+        }
+
+#ifdef USE_CAFFE
+        caffeRef.forward(input.data(), batch, refOutput.data());
+#endif
+
+        for (int n = 0; n < batch; ++n) {
+            std::string key = images.at(begin + n).key + "/" + spec.output;
+            if (network) {
+                trt::BlobData& t = test[key];
+                t.shape = outputShape;
+                t.data.assign(output.begin() + n * outputVol, output.begin() + (n + 1) * outputVol);
+            }
+#ifdef USE_CAFFE
+            trt::BlobData& r = reference[key];
+            r.shape = outputShape;
+            r.data.assign(refOutput.begin() + n * outputVol, refOutput.begin() + (n + 1) * outputVol);
+#endif
+        }
+    }
+
+    const std::string goldenPath = opt.goldenDir + "/" + spec.name + ".golden";
+
+#ifndef USE_CAFFE
+    if (!opt.record && !trt::readGolden(goldenPath, reference))
+        return false;
+#endif
+
+    if (opt.record) {
+        // Without Caffe the current TensorRT outputs become the golden results
+        if (reference.empty())
+            reference = test;
+        if (!trt::writeGolden(goldenPath, reference))
+            return false;
+        TRTLog(trt::INFO) << spec.name << ": recorded " << reference.size() << " golden tensors to " << goldenPath;
+    }
+    if (referenceOnly)
+        return true;
+
+    // Keep the outputs of this run so that later runs can be compared on CPU only
+    trt::writeGolden(opt.goldenDir + "/" + spec.name + ".trt.golden", test);
+
+    trt::Divergence divergence = trt::compareGolden(test, reference);
+    bool passed = divergence.samples > 0 &&
+                  divergence.maxAbsError <= opt.maxAbsError &&
+                  divergence.top1Agreement >= opt.minTop1;
+
+    TRTLog(trt::INFO) << spec.name << ": throughput " << numImages / (totalMs * 1e-3) << " img/s, latency "
+                      << trt::summarizeLatencies(latencies);
+    TRTLog(passed ? trt::INFO : trt::ERROR) << spec.name << ": " << divergence << (passed ? " PASSED" : " FAILED");
+    return passed;
+}
+
+static int compareFiles(const std::string& testPath, const std::string& refPath, const Options& opt)
+{
+    trt::GoldenSet test, reference;
+    if (!trt::readGolden(testPath, test) || !trt::readGolden(refPath, reference))
+        return 1;
+
+    trt::Divergence divergence = trt::compareGolden(test, reference);
+    bool passed = divergence.samples > 0 &&
+                  divergence.maxAbsError <= opt.maxAbsError &&
+                  divergence.top1Agreement >= opt.minTop1;
+    TRTLog(passed ? trt::INFO : trt::ERROR) << divergence << (passed ? " PASSED" : " FAILED");
+    return passed ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record")
+            opt.record = true;
+        else if (arg == "--cpu-reference")
+            opt.cpuReference = true;
+        else if (arg == "--batch" && i + 1 < argc)
+            opt.batch = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--max-abs-err" && i + 1 < argc)
+            opt.maxAbsError = (float)std::atof(argv[++i]);
+        else if (arg == "--min-top1" && i + 1 < argc)
+            opt.minTop1 = std::atof(argv[++i]);
+        else
+            args.push_back(arg);
+    }
+
+    if (args.size() == 3 && args.at(0) == "--compare")
+        return compareFiles(args.at(1), args.at(2), opt);
+
+    if (args.size() != 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " models.txt images.txt golden_dir [--record] [--cpu-reference] [--batch N]"
+                  << " [--max-abs-err E] [--min-top1 A]" << std::endl
+                  << "       " << argv[0] << " --compare test.golden reference.golden" << std::endl;
+        return 1;
+    }
+
+    std::vector<ModelSpec> models;
+    std::vector<ImageEntry> images;
+    if (!readModels(args.at(0), models) || !readImages(args.at(1), images))
+        return 1;
+    opt.goldenDir = args.at(2);
+
+#ifndef USE_CAFFE
+    if (opt.cpuReference) {
+        TRTLog(trt::ERROR) << "--cpu-reference needs Caffe, rebuild with it to run the reference on the CPU";
+        return 1;
+    }
+#endif
+
+#ifdef USE_CAFFE
+    ::google::InitGoogleLogging(argv[0]);
+#endif
+
+    int failures = 0;
+    for (const ModelSpec& spec : models)
+        failures += !runModel(spec, images, opt);
+
+    TRTLog(failures ? trt::ERROR : trt::INFO) << models.size() - failures << "/" << models.size() << " models passed";
+    return failures ? 1 : 0;
+}
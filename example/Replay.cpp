@@ -0,0 +1,160 @@
+/**
+ * Inference traffic replay tool.
+ *
+ * Replays a trace written by a TrafficRecorder attached to
+ * TRTNetwork::forward, either at the recorded rate or as fast as
+ * possible, and reports the throughput and the latency percentiles.
+ *
+ * With --models the requests run on TensorRT networks listed one per line:
+ *
+ *   name deploy.prototxt network.caffemodel input_blob output_blob max_batch
+ *
+ * Otherwise a mock executor on the CPU sleeps for the mean recorded
+ * service time per sample of each model, so the request mix can be
+ * replayed on any machine. --synthesize writes a random trace to try it.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TRTNetwork/TRTNetwork.hpp"
+#include "TRTNetwork/CaffeIO.hpp"
+#include "TRTNetwork/Traffic.hpp"
+
+class MockExecutor : public trt::Executor
+{
+public:
+    explicit MockExecutor(const std::vector<trt::TraceRecord> &records)
+    {
+        std::map<std::string, double> totalNs, totalSamples;
+        for (const trt::TraceRecord &rec : records) {
+            totalNs[rec.model] += rec.durationNs;
+            totalSamples[rec.model] += std::max(1, rec.batchSize);
+        }
+        for (const std::pair<const std::string, double> &kv : totalNs)
+            nsPerSample[kv.first] = kv.second / totalSamples[kv.first];
+    }
+
+    bool execute(const std::string &model, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict) override
+    {
+        (void)feedDict;
+        std::map<std::string, double>::const_iterator it = nsPerSample.find(model);
+        if (it == nsPerSample.end())
+            return false;
+        std::this_thread::sleep_for(std::chrono::nanoseconds((int64_t)(it->second * batchSize)));
+        return true;
+    }
+
+private:
+    std::map<std::string, double> nsPerSample;
+};
+
+/**
+ * @brief Random mix of two models with Poisson arrivals.
+ */
+static bool synthesize(const std::string &path, int numRequests)
+{
+    trt::TrafficRecorder recorder(path);
+    if (!recorder.isOpen())
+        return false;
+
+    std::mt19937 rng(1);
+    std::exponential_distribution<double> gapMs(1.0 / 4.0);
+    std::discrete_distribution<int> batchOf({0, 6, 2, 0, 1, 0, 0, 0, 1});
+    std::bernoulli_distribution detector(0.3);
+
+    double t = 0.0;
+    for (int i = 0; i < numRequests; ++i) {
+        t += gapMs(rng);
+        trt::TraceRecord rec;
+        bool det = detector(rng);
+        rec.model = det ? "detector" : "classifier";
+        rec.batchSize = batchOf(rng);
+        rec.startNs = (int64_t)(t * 1e6);
+        rec.durationNs = (int64_t)((det ? 1.5e6 : 0.5e6) * rec.batchSize);
+        rec.success = true;
+
+        trt::TraceTensor input, output;
+        input.name = "data";
+        input.shape = {rec.batchSize, 3, det ? 300 : 227, det ? 300 : 227};
+        output.name = det ? "detection_out" : "prob";
+        output.isOutput = true;
+        output.shape = {rec.batchSize, 1000, 1, 1};
+        rec.tensors = {input, output};
+        recorder.record(rec);
+    }
+    TRTLog(trt::INFO) << "Wrote " << recorder.getNumRecords() << " synthetic requests to " << path;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    trt::ReplayOptions options;
+    std::string modelsPath;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-speed")
+            options.realtime = false;
+        else if (arg == "--speed" && i + 1 < argc)
+            options.speed = std::atof(argv[++i]);
+        else if (arg == "--workers" && i + 1 < argc)
+            options.numWorkers = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--models" && i + 1 < argc)
+            modelsPath = argv[++i];
+        else
+            args.push_back(arg);
+    }
+
+    if (args.size() == 3 && args.at(0) == "--synthesize")
+        return synthesize(args.at(1), std::atoi(args.at(2).c_str())) ? 0 : 1;
+
+    if (args.size() != 1) {
+        std::cerr << "Usage: " << argv[0] << " trace [--max-speed] [--speed S] [--workers N] [--models models.txt]" << std::endl
+                  << "       " << argv[0] << " --synthesize trace num_requests" << std::endl;
+        return 1;
+    }
+
+    std::vector<trt::TraceRecord> records;
+    if (!trt::readTrace(args.at(0), records))
+        return 1;
+    TRTLog(trt::INFO) << "Replaying " << records.size() << " requests "
+                      << (options.realtime ? "at the recorded rate" : "as fast as possible")
+                      << " with " << (options.numWorkers > 0 ? options.numWorkers
+                                      : options.realtime ? trt::openLoopWorkers(records, options.speed) : 1)
+                      << " workers";
+
+    std::unique_ptr<trt::Executor> executor;
+    std::vector< std::unique_ptr<trt::TRTNetwork> > networks;
+    if (modelsPath.empty()) {
+        executor.reset(new MockExecutor(records));
+    } else {
+        std::vector<std::string> lines;
+        if (!trt::readLines(modelsPath, lines))
+            return 1;
+        trt::NetworkExecutor *networkExecutor = new trt::NetworkExecutor();
+        executor.reset(networkExecutor);
+        for (const std::string &line : lines) {
+            std::istringstream ss(line);
+            std::string name, deploy, model, input, output;
+            int maxBatch = 1;
+            if (!(ss >> name >> deploy >> model >> input >> output >> maxBatch))
+                continue;
+            networks.emplace_back(new trt::TRTNetwork(name, deploy, model, {output}, {input}, maxBatch));
+            networkExecutor->addNetwork(*networks.back());
+        }
+    }
+
+    trt::ReplayResult result = trt::replayTrace(*executor, records, options);
+    TRTLog(result.failed ? trt::ERROR : trt::INFO) << result;
+    return result.failed ? 1 : 0;
+}
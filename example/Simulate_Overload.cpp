@@ -0,0 +1,112 @@
+/**
+ * Overload simulation of the Scheduler admission control.
+ *
+ * A fake executor with a fixed service time per model stands in for the
+ * GPU and a ManualClock for the time, so the run is deterministic and
+ * needs no accelerator. Requests of 1 to 4 samples arrive at a multiple of
+ * the capacity of the executor; the bounded queues reject what does not
+ * fit and requests which cannot meet their deadline are shed before
+ * execution. Every request which does reach the executor must then finish
+ * in time. The exit code is non-zero otherwise, it runs as a ctest:
+ *
+ *   simulate_overload [overload] [requests] [capacity]
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TRTNetwork/Logger.hpp"
+#include "TRTNetwork/Scheduler.hpp"
+
+typedef std::chrono::microseconds us;
+
+class FakeExecutor : public trt::Executor
+{
+public:
+    FakeExecutor(std::shared_ptr<trt::ManualClock> clock)
+        : clock(clock)
+    {
+    }
+
+    void setServiceTime(const std::string &model, trt::Duration d)
+    {
+        serviceTimes[model] = d;
+    }
+
+    bool execute(const std::string &model, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict) override
+    {
+        (void)feedDict;
+        clock->advance(serviceTimes.at(model) * batchSize);
+        return true;
+    }
+
+private:
+    std::shared_ptr<trt::ManualClock> clock;
+    std::map<std::string, trt::Duration> serviceTimes;
+};
+
+struct Arrival
+{
+    trt::TimePoint time;
+    trt::InferenceRequest request;
+};
+
+int main(int argc, char** argv)
+{
+    double overload  = argc > 1 ? std::atof(argv[1]) : 2.0;
+    int numRequests  = argc > 2 ? std::atoi(argv[2]) : 20000;
+    size_t capacity  = argc > 3 ? std::atoi(argv[3]) : 32;
+
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    executor.setServiceTime("detector", us(4000));
+    executor.setServiceTime("classifier", us(1000));
+
+    trt::Scheduler scheduler(executor, 2, clock);
+    scheduler.setQueueCapacity(0, capacity);
+    scheduler.setQueueCapacity(1, capacity);
+
+    // Mean service time is 2.5ms per sample and 2.5 samples per request
+    const double meanServiceUs = 2500.0 * 2.5;
+    std::mt19937 rng(42);
+    std::exponential_distribution<double> gap(overload / meanServiceUs);
+    std::bernoulli_distribution interactive(0.5);
+    std::uniform_int_distribution<int> batchSize(1, 4);
+
+    std::vector<Arrival> arrivals(numRequests);
+    trt::TimePoint t = clock->now();
+    for (Arrival &a : arrivals) {
+        t += us((long long)gap(rng));
+        a.time = t;
+        bool critical = interactive(rng);
+        a.request.model = critical ? "classifier" : "detector";
+        a.request.priority = critical ? 0 : 1;
+        a.request.batchSize = batchSize(rng);
+        a.request.deadline = t + (critical ? us(20000) : us(200000));
+    }
+
+    size_t next = 0;
+    while (next < arrivals.size() || scheduler.getNumPending()) {
+        // Everything which arrived while the executor was busy
+        while (next < arrivals.size() && arrivals.at(next).time <= clock->now())
+            scheduler.trySubmit(std::move(arrivals.at(next++).request));
+
+        if (!scheduler.dispatchOne() && next < arrivals.size())
+            clock->set(arrivals.at(next).time);
+    }
+
+    bool passed = true;
+    for (int priority = 0; priority < scheduler.getNumPriorityClasses(); ++priority) {
+        trt::ClassMetrics metrics = scheduler.getMetrics(priority);
+        TRTLog(trt::INFO) << "class " << priority << ": " << metrics;
+        passed = passed && metrics.deadlineMisses == 0 &&
+                 metrics.submitted == metrics.shed + metrics.expired + metrics.completed + metrics.failed;
+    }
+
+    TRTLog(passed ? trt::INFO : trt::ERROR) << (passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
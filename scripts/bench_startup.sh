@@ -0,0 +1,21 @@
+# ==============================================================
+# Compare the dynamic-link and startup time of the Caffe-linked
+# example (classification_01) with the slim one (classification_02)
+# ==============================================================
+# Both binaries print their usage and exit when run without
+# arguments, so the measured time is loader + static init only.
+RUNS=${1:-50}
+
+for bin in ./bin/classification_01 ./bin/classification_02; do
+    if [ ! -x ${bin} ]; then
+        echo "${bin} not found, skipped"
+        continue
+    fi
+    libs=$(ldd ${bin} | wc -l)
+    start=$(date +%s%N)
+    for i in $(seq ${RUNS}); do
+        ${bin} > /dev/null 2>&1
+    done
+    end=$(date +%s%N)
+    echo "${bin}: ${libs} shared libraries, $(( (end - start) / RUNS / 1000 )) us per startup"
+done
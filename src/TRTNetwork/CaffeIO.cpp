@@ -0,0 +1,253 @@
+#include "CaffeIO.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+namespace {
+
+/**
+ * @brief Minimal decoder of the protobuf wire format.
+ */
+class WireReader
+{
+public:
+    WireReader(const uint8_t *begin, const uint8_t *end)
+        : cur(begin), end(end) {}
+
+    bool done() const { return cur >= end; }
+
+    bool varint(uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cur >= end)
+                return false;
+            uint8_t byte = *cur++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    template <typename T>
+    bool fixed(T &value)
+    {
+        if (end - cur < (ptrdiff_t)sizeof(T))
+            return false;
+        std::memcpy(&value, cur, sizeof(T));
+        cur += sizeof(T);
+        return true;
+    }
+
+    bool bytes(WireReader &sub)
+    {
+        uint64_t len;
+        if (!varint(len) || (uint64_t)(end - cur) < len)
+            return false;
+        sub = WireReader(cur, cur + len);
+        cur += len;
+        return true;
+    }
+
+    bool skip(int wireType)
+    {
+        uint64_t v;
+        WireReader sub(nullptr, nullptr);
+        switch (wireType) {
+        case 0: return varint(v);
+        case 1: return fixed(v);
+        case 2: return bytes(sub);
+        case 5: { uint32_t w; return fixed(w); }
+        default: return false;
+        }
+    }
+
+private:
+    const uint8_t *cur;
+    const uint8_t *end;
+};
+
+/**
+ * @brief Read a repeated scalar field which may be packed (wire type 2)
+ *        or unpacked (wire type 5 for floats, 1 for doubles).
+ */
+template <typename T>
+bool readRepeated(WireReader &reader, int wireType, std::vector<float> &out)
+{
+    T v;
+    if (wireType == (sizeof(T) == sizeof(float) ? 5 : 1)) {
+        if (!reader.fixed(v))
+            return false;
+        out.push_back((float)v);
+        return true;
+    }
+    if (wireType != 2)
+        return false;
+
+    WireReader packed(nullptr, nullptr);
+    if (!reader.bytes(packed))
+        return false;
+    while (!packed.done()) {
+        if (!packed.fixed(v))
+            return false;
+        out.push_back((float)v);
+    }
+    return true;
+}
+
+bool readShape(WireReader reader, std::vector<int> &shape)
+{
+    while (!reader.done()) {
+        uint64_t key, dim;
+        if (!reader.varint(key))
+            return false;
+        int field = int(key >> 3), wireType = int(key & 7);
+
+        if (field != 1) {
+            if (!reader.skip(wireType))
+                return false;
+        } else if (wireType == 2) {
+            WireReader packed(nullptr, nullptr);
+            if (!reader.bytes(packed))
+                return false;
+            while (!packed.done()) {
+                if (!packed.varint(dim))
+                    return false;
+                shape.push_back((int)dim);
+            }
+        } else {
+            if (!reader.varint(dim))
+                return false;
+            shape.push_back((int)dim);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int BlobData::count() const
+{
+    int vol = shape.empty() ? 0 : 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return vol;
+}
+
+bool readBlobProto(const std::string &path, BlobData &blob)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        TRTLog(ERROR) << "Unable to open blob file " << path;
+        return false;
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const uint8_t *begin = reinterpret_cast<const uint8_t*>(buffer.data());
+
+    WireReader reader(begin, begin + buffer.size());
+    int legacy[4] = {0, 0, 0, 0}; // num, channels, height, width
+    blob.shape.clear();
+    blob.data.clear();
+
+    bool ok = true;
+    while (ok && !reader.done()) {
+        uint64_t key, v = 0;
+        ok = reader.varint(key);
+        if (!ok)
+            break;
+        int field = int(key >> 3), wireType = int(key & 7);
+
+        switch (field) {
+        case 1: case 2: case 3: case 4:
+            ok = wireType == 0 && reader.varint(v);
+            legacy[field - 1] = (int)v;
+            break;
+        case 5:
+            ok = readRepeated<float>(reader, wireType, blob.data);
+            break;
+        case 7: {
+            WireReader sub(nullptr, nullptr);
+            ok = wireType == 2 && reader.bytes(sub) && readShape(sub, blob.shape);
+            break;
+        }
+        case 8:
+            ok = readRepeated<double>(reader, wireType, blob.data);
+            break;
+        default:
+            ok = reader.skip(wireType);
+        }
+    }
+
+    if (blob.shape.empty() && legacy[1] > 0)
+        blob.shape.assign(legacy, legacy + 4);
+
+    if (!ok || blob.count() != (int)blob.data.size()) {
+        TRTLog(ERROR) << "Malformed blob file " << path;
+        return false;
+    }
+    return true;
+}
+
+std::vector<float> channelMean(const BlobData &blob)
+{
+    std::vector<float> mean;
+    int nbDims = (int)blob.shape.size();
+    if (nbDims < 3 || nbDims > 4 || blob.data.empty())
+        return mean;
+
+    // The mean file is planar, so each channel is a contiguous H*W plane
+    int channels = blob.shape.at(nbDims - 3);
+    int area = blob.shape.at(nbDims - 2) * blob.shape.at(nbDims - 1);
+    for (int c = 0; c < channels; ++c) {
+        double sum = 0.0;
+        const float *plane = blob.data.data() + c * area;
+        for (int i = 0; i < area; ++i)
+            sum += plane[i];
+        mean.push_back(float(sum / area));
+    }
+    return mean;
+}
+
+bool readLabels(const std::string &path, std::vector<std::string> &labels)
+{
+    std::ifstream file(path.c_str());
+    if (!file) {
+        TRTLog(ERROR) << "Unable to open labels file " << path;
+        return false;
+    }
+
+    labels.clear();
+    std::string line;
+    while (std::getline(file, line))
+        labels.push_back(line);
+    return true;
+}
+
+bool readLines(const std::string &path, std::vector<std::string> &lines)
+{
+    std::ifstream file(path.c_str());
+    if (!file) {
+        TRTLog(ERROR) << "Unable to open list file " << path;
+        return false;
+    }
+
+    lines.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line.at(begin) == '#')
+            continue;
+        lines.push_back(line.substr(begin));
+    }
+    return true;
+}
+
+} // namespace trt
@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * This file implements readers for the auxiliary files shipped with
+ * Caffe models, i.e. the .binaryproto mean file and the label file,
+ * so that services do not need to link libcaffe or protobuf just to
+ * load them.
+ */
+
+#include <string>
+#include <vector>
+
+namespace trt {
+
+/**
+ * @brief Content of a Caffe BlobProto.
+ *
+ *        The shape is always reported in 4D NCHW form when the file uses
+ *        the legacy num/channels/height/width fields.
+ */
+struct BlobData
+{
+    std::vector<int> shape;
+    std::vector<float> data;
+
+    int count() const;
+};
+
+/**
+ * @brief Read a BlobProto serialized in the protobuf binary format,
+ *        e.g. imagenet_mean.binaryproto.
+ *
+ *        Only the fields needed to reconstruct the blob are decoded:
+ *        shape (7), data (5), double_data (8) and the legacy num (1),
+ *        channels (2), height (3) and width (4). Other fields are skipped.
+ *
+ * @return success   False if the file cannot be opened or is malformed.
+ */
+bool readBlobProto(const std::string& path, BlobData& blob);
+
+/**
+ * @brief Per-channel average of a mean blob, the same value Caffe's
+ *        classification example subtracts from the input image.
+ *
+ * @return mean      One value per channel. Empty if the blob is not 3D/4D.
+ */
+std::vector<float> channelMean(const BlobData& blob);
+
+/**
+ * @brief Read one label per line, e.g. synset_words.txt.
+ */
+bool readLabels(const std::string& path, std::vector<std::string>& labels);
+
+/**
+ * @brief Read the entries of a list file, e.g. a list of images or models.
+ *        Unlike readLabels, whose line numbers are the class indices,
+ *        blank lines and lines starting with '#' are skipped and trailing
+ *        whitespace is trimmed.
+ */
+bool readLines(const std::string& path, std::vector<std::string>& lines);
+
+} // namespace trt
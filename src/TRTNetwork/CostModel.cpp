@@ -0,0 +1,630 @@
+#include "CostModel.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <set>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+bool ProtoMessage::has(const std::string &key) const
+{
+    for (const std::pair<std::string, std::string> &field : fields)
+        if (field.first == key)
+            return true;
+    return false;
+}
+
+std::string ProtoMessage::get(const std::string &key, const std::string &fallback) const
+{
+    for (const std::pair<std::string, std::string> &field : fields)
+        if (field.first == key)
+            return field.second;
+    return fallback;
+}
+
+std::vector<std::string> ProtoMessage::getAll(const std::string &key) const
+{
+    std::vector<std::string> values;
+    for (const std::pair<std::string, std::string> &field : fields)
+        if (field.first == key)
+            values.push_back(field.second);
+    return values;
+}
+
+int ProtoMessage::getInt(const std::string &key, int fallback) const
+{
+    return has(key) ? std::atoi(get(key).c_str()) : fallback;
+}
+
+bool ProtoMessage::getBool(const std::string &key, bool fallback) const
+{
+    return has(key) ? get(key) == "true" : fallback;
+}
+
+const ProtoMessage* ProtoMessage::getMessage(const std::string &key) const
+{
+    for (const std::pair<std::string, std::shared_ptr<ProtoMessage> > &message : messages)
+        if (message.first == key)
+            return message.second.get();
+    return nullptr;
+}
+
+std::vector<const ProtoMessage*> ProtoMessage::getMessages(const std::string &key) const
+{
+    std::vector<const ProtoMessage*> found;
+    for (const std::pair<std::string, std::shared_ptr<ProtoMessage> > &message : messages)
+        if (message.first == key)
+            found.push_back(message.second.get());
+    return found;
+}
+
+struct ProtoToken
+{
+    enum Type { kWORD, kSTRING, kSYMBOL } type;
+    std::string text;
+    int line;
+};
+
+static bool tokenize(const std::string &text, std::vector<ProtoToken> &tokens)
+{
+    int line = 1;
+    for (size_t i = 0; i < text.size(); ) {
+        const char c = text[i];
+        if (c == '\n') {
+            ++line;
+            ++i;
+        } else if (std::isspace((unsigned char)c) || c == ',' || c == ';') {
+            ++i;
+        } else if (c == '#') {
+            while (i < text.size() && text[i] != '\n')
+                ++i;
+        } else if (c == '{' || c == '}' || c == ':') {
+            tokens.push_back({ProtoToken::kSYMBOL, std::string(1, c), line});
+            ++i;
+        } else if (c == '"' || c == '\'') {
+            std::string str;
+            for (++i; i < text.size() && text[i] != c; ++i) {
+                if (text[i] == '\\' && i + 1 < text.size())
+                    ++i;
+                str += text[i];
+            }
+            if (i == text.size()) {
+                TRTLog(ERROR) << "Unterminated string at line " << line;
+                return false;
+            }
+            ++i;
+            tokens.push_back({ProtoToken::kSTRING, str, line});
+        } else {
+            size_t begin = i;
+            while (i < text.size() && (std::isalnum((unsigned char)text[i]) || std::strchr("_.+-", text[i])))
+                ++i;
+            if (i == begin) {
+                TRTLog(ERROR) << "Unexpected character '" << c << "' at line " << line;
+                return false;
+            }
+            tokens.push_back({ProtoToken::kWORD, text.substr(begin, i - begin), line});
+        }
+    }
+    return true;
+}
+
+static bool isSymbol(const std::vector<ProtoToken> &tokens, size_t pos, char symbol)
+{
+    return pos < tokens.size() && tokens[pos].type == ProtoToken::kSYMBOL && tokens[pos].text[0] == symbol;
+}
+
+/**
+ * @brief message := { name [':'] ( '{' message '}' | value ) }
+ */
+static bool parseMessage(const std::vector<ProtoToken> &tokens, size_t &pos, ProtoMessage &message, bool nested)
+{
+    while (pos < tokens.size()) {
+        if (isSymbol(tokens, pos, '}')) {
+            if (!nested)
+                break;
+            ++pos;
+            return true;
+        }
+        if (tokens[pos].type != ProtoToken::kWORD) {
+            TRTLog(ERROR) << "Expected a field name at line " << tokens[pos].line;
+            return false;
+        }
+
+        const std::string key = tokens[pos++].text;
+        const bool colon = isSymbol(tokens, pos, ':');
+        if (colon)
+            ++pos;
+
+        if (isSymbol(tokens, pos, '{')) {
+            std::shared_ptr<ProtoMessage> child = std::make_shared<ProtoMessage>();
+            if (!parseMessage(tokens, ++pos, *child, true))
+                return false;
+            message.messages.push_back(std::make_pair(key, child));
+        } else if (colon && pos < tokens.size() && tokens[pos].type != ProtoToken::kSYMBOL) {
+            message.fields.push_back(std::make_pair(key, tokens[pos++].text));
+        } else {
+            TRTLog(ERROR) << "Expected a value for field " << key << " at line "
+                          << (pos < tokens.size() ? tokens[pos].line : tokens.back().line);
+            return false;
+        }
+    }
+
+    if (nested || pos != tokens.size()) {
+        TRTLog(ERROR) << (nested ? "Unterminated message" : "Unbalanced '}'") << " in prototxt";
+        return false;
+    }
+    return true;
+}
+
+bool parsePrototxt(const std::string &text, ProtoMessage &root)
+{
+    root = ProtoMessage();
+    std::vector<ProtoToken> tokens;
+    size_t pos = 0;
+    return tokenize(text, tokens) && parseMessage(tokens, pos, root, false);
+}
+
+bool readPrototxt(const std::string &path, ProtoMessage &root)
+{
+    std::ifstream file(path.c_str());
+    if (!file) {
+        TRTLog(ERROR) << "Unable to open prototxt " << path;
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    if (!parsePrototxt(ss.str(), root)) {
+        TRTLog(ERROR) << "Malformed prototxt " << path;
+        return false;
+    }
+    return true;
+}
+
+static size_t volumeOf(const std::vector<int> &shape)
+{
+    size_t vol = 1;
+    for (int d : shape)
+        vol *= d;
+    return vol;
+}
+
+static std::string shapeString(const std::vector<int> &shape)
+{
+    std::stringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < shape.size(); ++i)
+        ss << (i ? ", " : "") << shape.at(i);
+    ss << "]";
+    return ss.str();
+}
+
+std::ostream& operator<< (std::ostream &os, const LayerCost &layer)
+{
+    os << layer.name << " (" << layer.type << ") " << shapeString(layer.outputShape)
+       << " " << layer.flops * 1e-6 << " MFLOP, params " << layer.paramBytes
+       << " bytes, activations " << layer.activationBytes << " bytes";
+    if (!layer.supported)
+        os << ", unknown cost";
+    return os;
+}
+
+std::ostream& operator<< (std::ostream &os, const NetworkCost &cost)
+{
+    os << cost.layers.size() << " layers, " << cost.flops * 1e-9 << " GFLOP, params " << cost.paramBytes
+       << " bytes, activations " << cost.activationBytes << " bytes (peak " << cost.peakActivationBytes
+       << "), IO " << cost.ioBytes << " bytes per sample";
+    return os;
+}
+
+MemoryFootprint NetworkCost::estimateFootprint(int maxBatchSize, size_t maxWorkspaceSize) const
+{
+    MemoryFootprint footprint;
+    footprint.engineBytes = paramBytes;
+    footprint.workspaceBytes = maxWorkspaceSize + maxBatchSize * peakActivationBytes;
+    footprint.ioBlobBytes = maxBatchSize * ioBytes;
+    return footprint;
+}
+
+int NetworkCost::maxBatchSizeWithin(size_t budget, size_t maxWorkspaceSize) const
+{
+    // The footprint is affine in the batch size
+    const size_t fixed = estimateFootprint(0, maxWorkspaceSize).total();
+    const size_t perSample = peakActivationBytes + ioBytes;
+    if (budget < fixed + perSample)
+        return 0;
+    if (perSample == 0)
+        return INT_MAX;
+    return (int)std::min<size_t>((budget - fixed) / perSample, INT_MAX);
+}
+
+int NetworkCost::maxInstancesWithin(size_t budget, int maxBatchSize, size_t maxWorkspaceSize) const
+{
+    const size_t perInstance = estimateFootprint(maxBatchSize, maxWorkspaceSize).total();
+    return perInstance ? (int)std::min<size_t>(budget / perInstance, INT_MAX) : 0;
+}
+
+/**
+ * @brief Read a spatial parameter given either as a repeated field (one
+ *        value for both or height then width) or as its _h and _w fields.
+ */
+static void spatialParam(const ProtoMessage &param, const std::string &key, const std::string &keyH,
+                         const std::string &keyW, int fallback, int &h, int &w)
+{
+    std::vector<std::string> values = param.getAll(key);
+    h = w = values.empty() ? fallback : std::atoi(values.at(0).c_str());
+    if (values.size() > 1)
+        w = std::atoi(values.at(1).c_str());
+    h = param.getInt(keyH, h);
+    w = param.getInt(keyW, w);
+}
+
+/**
+ * @brief Names of the layer types of the V1 format, which are enums.
+ */
+static std::string layerTypeOf(const ProtoMessage &layer)
+{
+    static const std::map<std::string, std::string> v1Types = {
+        {"CONVOLUTION", "Convolution"}, {"DECONVOLUTION", "Deconvolution"},
+        {"INNER_PRODUCT", "InnerProduct"}, {"POOLING", "Pooling"}, {"RELU", "ReLU"},
+        {"SIGMOID", "Sigmoid"}, {"TANH", "TanH"}, {"LRN", "LRN"}, {"DROPOUT", "Dropout"},
+        {"SOFTMAX", "Softmax"}, {"CONCAT", "Concat"}, {"ELTWISE", "Eltwise"},
+        {"FLATTEN", "Flatten"}, {"SPLIT", "Split"}, {"SLICE", "Slice"}, {"POWER", "Power"},
+        {"ABSVAL", "AbsVal"}, {"BNLL", "BNLL"}
+    };
+    std::string type = layer.get("type");
+    std::map<std::string, std::string>::const_iterator it = v1Types.find(type);
+    return it == v1Types.end() ? type : it->second;
+}
+
+/**
+ * @brief Derive the top shapes and the cost of one layer.
+ * @return success  False if the shapes are inconsistent.
+ */
+static bool deriveLayerCost(const ProtoMessage &layer, const std::vector< std::vector<int> > &bottoms, int numTops,
+                      LayerCost &cost, std::vector< std::vector<int> > &tops)
+{
+    static const ProtoMessage empty;
+    auto paramOf = [&](const char *name) {
+        const ProtoMessage *param = layer.getMessage(name);
+        return param ? param : &empty;
+    };
+
+    const std::string &type = cost.type;
+    const std::vector<int> in = bottoms.empty() ? std::vector<int>() : bottoms.at(0);
+    const double elements = volumeOf(in);
+    const bool spatial = in.size() == 3;
+    std::vector<int> out = in;
+
+    if (type == "Convolution" || type == "Deconvolution") {
+        const ProtoMessage &p = *paramOf("convolution_param");
+        int kh, kw, sh, sw, ph, pw, dh, dw;
+        spatialParam(p, "kernel_size", "kernel_h", "kernel_w", 0, kh, kw);
+        spatialParam(p, "stride", "stride_h", "stride_w", 1, sh, sw);
+        spatialParam(p, "pad", "pad_h", "pad_w", 0, ph, pw);
+        spatialParam(p, "dilation", "dilation_h", "dilation_w", 1, dh, dw);
+        const int numOutput = p.getInt("num_output");
+        const int group = std::max(1, p.getInt("group", 1));
+        const bool bias = p.getBool("bias_term", true);
+        if (!spatial || kh <= 0 || kw <= 0 || sh <= 0 || sw <= 0 || numOutput <= 0 || in.at(0) % group) {
+            TRTLog(ERROR) << "Invalid convolution " << cost.name << " of input " << shapeString(in);
+            return false;
+        }
+
+        const double kernel = (double)kh * kw;
+        if (type == "Convolution") {
+            out = {numOutput, (in.at(1) + 2 * ph - (dh * (kh - 1) + 1)) / sh + 1,
+                   (in.at(2) + 2 * pw - (dw * (kw - 1) + 1)) / sw + 1};
+            cost.flops = 2.0 * volumeOf(out) * (in.at(0) / group) * kernel;
+        } else {
+            out = {numOutput, sh * (in.at(1) - 1) + dh * (kh - 1) + 1 - 2 * ph,
+                   sw * (in.at(2) - 1) + dw * (kw - 1) + 1 - 2 * pw};
+            cost.flops = 2.0 * elements * (numOutput / group) * kernel;
+        }
+        if (bias)
+            cost.flops += volumeOf(out);
+        cost.paramBytes = ((size_t)numOutput * (in.at(0) / group) * kh * kw + (bias ? numOutput : 0)) * sizeof(float);
+    } else if (type == "InnerProduct") {
+        const ProtoMessage &p = *paramOf("inner_product_param");
+        const int numOutput = p.getInt("num_output");
+        const bool bias = p.getBool("bias_term", true);
+        if (numOutput <= 0 || in.empty()) {
+            TRTLog(ERROR) << "Invalid inner product " << cost.name;
+            return false;
+        }
+        out = {numOutput, 1, 1};
+        cost.flops = 2.0 * elements * numOutput + (bias ? numOutput : 0);
+        cost.paramBytes = ((size_t)elements * numOutput + (bias ? numOutput : 0)) * sizeof(float);
+    } else if (type == "Pooling") {
+        const ProtoMessage &p = *paramOf("pooling_param");
+        int kh, kw, sh, sw, ph, pw;
+        spatialParam(p, "kernel_size", "kernel_h", "kernel_w", 0, kh, kw);
+        spatialParam(p, "stride", "stride_h", "stride_w", 1, sh, sw);
+        spatialParam(p, "pad", "pad_h", "pad_w", 0, ph, pw);
+        if (spatial && p.getBool("global_pooling")) {
+            kh = in.at(1); kw = in.at(2);
+            sh = sw = 1; ph = pw = 0;
+        }
+        if (!spatial || kh <= 0 || kw <= 0 || sh <= 0 || sw <= 0) {
+            TRTLog(ERROR) << "Invalid pooling " << cost.name << " of input " << shapeString(in);
+            return false;
+        }
+
+        // Caffe rounds up, and the last window must start inside the image
+        int oh = (int)std::ceil((float)(in.at(1) + 2 * ph - kh) / sh) + 1;
+        int ow = (int)std::ceil((float)(in.at(2) + 2 * pw - kw) / sw) + 1;
+        if ((ph || pw) && (oh - 1) * sh >= in.at(1) + ph)
+            --oh;
+        if ((ph || pw) && (ow - 1) * sw >= in.at(2) + pw)
+            --ow;
+        out = {in.at(0), oh, ow};
+        cost.flops = (double)volumeOf(out) * kh * kw;
+    } else if (type == "ReLU" || type == "Sigmoid" || type == "TanH" || type == "ELU" || type == "AbsVal" ||
+               type == "BNLL" || type == "Power" || type == "Exp" || type == "Log" || type == "Threshold" ||
+               type == "Clip") {
+        cost.flops = elements;
+    } else if (type == "Dropout" || type == "Split") {
+        // Nothing to compute at inference
+    } else if (type == "PReLU") {
+        const bool shared = paramOf("prelu_param")->getBool("channel_shared");
+        cost.flops = 2.0 * elements;
+        cost.paramBytes = (shared || in.empty() ? 1 : in.at(0)) * sizeof(float);
+    } else if (type == "BatchNorm") {
+        cost.flops = 2.0 * elements;
+        cost.paramBytes = (2 * (in.empty() ? 0 : in.at(0)) + 1) * sizeof(float);
+    } else if (type == "Scale" || type == "Bias") {
+        const bool bias = type == "Bias" || paramOf("scale_param")->getBool("bias_term");
+        cost.flops = elements * (type == "Scale" && bias ? 2 : 1);
+        if (bottoms.size() == 1 && !in.empty())
+            cost.paramBytes = in.at(0) * (type == "Scale" && bias ? 2 : 1) * sizeof(float);
+    } else if (type == "LRN") {
+        // Sum of squares over the window, then the power and the division
+        cost.flops = elements * (paramOf("lrn_param")->getInt("local_size", 5) + 5);
+    } else if (type == "Softmax") {
+        cost.flops = 4.0 * elements;
+    } else if (type == "Eltwise") {
+        for (const std::vector<int> &bottom : bottoms) {
+            if (bottom != in) {
+                TRTLog(ERROR) << "Eltwise " << cost.name << " of different shapes " << shapeString(in)
+                              << " and " << shapeString(bottom);
+                return false;
+            }
+        }
+        cost.flops = elements * (bottoms.size() - 1);
+    } else if (type == "Concat") {
+        const ProtoMessage &p = *paramOf("concat_param");
+        const int axis = p.getInt("axis", p.getInt("concat_dim", 1)) - 1; // Without the batch
+        if (axis < 0 || axis >= (int)in.size()) {
+            TRTLog(ERROR) << "Unsupported concat axis of " << cost.name;
+            return false;
+        }
+        out.at(axis) = 0;
+        for (const std::vector<int> &bottom : bottoms) {
+            if (bottom.size() != in.size()) {
+                TRTLog(ERROR) << "Concat " << cost.name << " of different ranks";
+                return false;
+            }
+            out.at(axis) += bottom.at(axis);
+        }
+    } else if (type == "Flatten") {
+        out = {(int)elements, 1, 1};
+    } else if (type == "Reshape") {
+        // Batch dimension first, where 0 copies the bottom and -1 is inferred
+        std::vector<int> full(1, 1);
+        full.insert(full.end(), in.begin(), in.end());
+        std::vector<int> dims;
+        const ProtoMessage *shape = paramOf("reshape_param")->getMessage("shape");
+        for (const std::string &dim : shape ? shape->getAll("dim") : std::vector<std::string>())
+            dims.push_back(std::atoi(dim.c_str()));
+
+        int inferred = -1;
+        size_t known = 1;
+        for (size_t i = 0; i < dims.size(); ++i) {
+            if (dims.at(i) == 0 && i < full.size())
+                dims.at(i) = full.at(i);
+            if (dims.at(i) == -1)
+                inferred = i;
+            else
+                known *= dims.at(i);
+        }
+        if (inferred >= 0 && known)
+            dims.at(inferred) = volumeOf(full) / known;
+        if (dims.size() < 2 || volumeOf(dims) != volumeOf(full)) {
+            TRTLog(ERROR) << "Invalid reshape " << cost.name << " of input " << shapeString(in);
+            return false;
+        }
+        out.assign(dims.begin() + 1, dims.end());
+    } else if (type == "Slice") {
+        const ProtoMessage &p = *paramOf("slice_param");
+        const int axis = p.getInt("axis", p.getInt("slice_dim", 1)) - 1;
+        if (axis < 0 || axis >= (int)in.size()) {
+            TRTLog(ERROR) << "Unsupported slice axis of " << cost.name;
+            return false;
+        }
+        std::vector<int> points;
+        for (const std::string &point : p.getAll("slice_point"))
+            points.push_back(std::atoi(point.c_str()));
+        if (points.empty())
+            for (int t = 1; t < numTops; ++t)
+                points.push_back(in.at(axis) * t / numTops);
+        points.insert(points.begin(), 0);
+        points.push_back(in.at(axis));
+        if ((int)points.size() != numTops + 1) {
+            TRTLog(ERROR) << "Slice " << cost.name << " has " << points.size() - 2 << " points for " << numTops << " tops";
+            return false;
+        }
+        for (int t = 0; t < numTops; ++t) {
+            std::vector<int> top = in;
+            top.at(axis) = points.at(t + 1) - points.at(t);
+            tops.push_back(top);
+        }
+        cost.outputShape = tops.at(0);
+        return true;
+    } else {
+        TRTLog(WARN) << "Unknown cost of layer " << cost.name << " of type " << type << ", assuming an unchanged shape";
+        cost.supported = false;
+    }
+
+    tops.assign(numTops, out);
+    cost.outputShape = out;
+    return true;
+}
+
+bool estimateCost(const std::string &deploy, const std::vector<std::string> &outputs, NetworkCost &cost,
+                  int inputHeight, int inputWidth)
+{
+    ProtoMessage root;
+    return readPrototxt(deploy, root) && estimateCost(root, outputs, cost, inputHeight, inputWidth);
+}
+
+bool estimateCost(const ProtoMessage &deploy, const std::vector<std::string> &outputs, NetworkCost &cost,
+                  int inputHeight, int inputWidth)
+{
+    cost = NetworkCost();
+
+    // Shapes of the prototxt include the batch, which TensorRT leaves implicit
+    auto addInput = [&](const std::string &name, std::vector<int> shape) {
+        if (!shape.empty())
+            shape.erase(shape.begin());
+        if (cost.inputs.empty() && inputHeight && inputWidth && shape.size() == 3) {
+            shape.at(1) = inputHeight;
+            shape.at(2) = inputWidth;
+        }
+        cost.inputs.push_back(name);
+        cost.blobShapes[name] = shape;
+    };
+
+    const std::vector<std::string> inputNames = deploy.getAll("input");
+    const std::vector<const ProtoMessage*> inputShapes = deploy.getMessages("input_shape");
+    const std::vector<std::string> inputDims = deploy.getAll("input_dim");
+    for (size_t i = 0; i < inputNames.size(); ++i) {
+        std::vector<int> shape;
+        if (i < inputShapes.size())
+            for (const std::string &dim : inputShapes.at(i)->getAll("dim"))
+                shape.push_back(std::atoi(dim.c_str()));
+        else
+            for (size_t d = 4 * i; d < 4 * i + 4 && d < inputDims.size(); ++d)
+                shape.push_back(std::atoi(inputDims.at(d).c_str()));
+        addInput(inputNames.at(i), shape);
+    }
+
+    std::vector<const ProtoMessage*> layers = deploy.getMessages("layer");
+    if (layers.empty())
+        layers = deploy.getMessages("layers");
+
+    // Blob names consumed and produced per layer, for the liveness below
+    std::vector< std::vector<std::string> > layerBottoms, layerTops;
+
+    for (const ProtoMessage *layer : layers) {
+        const ProtoMessage *include = layer->getMessage("include");
+        if (include && include->get("phase") == "TRAIN")
+            continue;
+
+        LayerCost layerCost;
+        layerCost.name = layer->get("name");
+        layerCost.type = layerTypeOf(*layer);
+        const std::vector<std::string> bottomNames = layer->getAll("bottom");
+        const std::vector<std::string> topNames = layer->getAll("top");
+
+        if (layerCost.type == "Input") {
+            const ProtoMessage *param = layer->getMessage("input_param");
+            std::vector<const ProtoMessage*> shapes = param ? param->getMessages("shape") : std::vector<const ProtoMessage*>();
+            for (size_t t = 0; t < topNames.size() && !shapes.empty(); ++t) {
+                std::vector<int> shape;
+                for (const std::string &dim : shapes.at(std::min(t, shapes.size() - 1))->getAll("dim"))
+                    shape.push_back(std::atoi(dim.c_str()));
+                addInput(topNames.at(t), shape);
+            }
+            continue;
+        }
+
+        std::vector< std::vector<int> > bottoms, tops;
+        for (const std::string &bottom : bottomNames) {
+            std::map< std::string, std::vector<int> >::const_iterator it = cost.blobShapes.find(bottom);
+            if (it == cost.blobShapes.end()) {
+                TRTLog(ERROR) << "Layer " << layerCost.name << " consumes the unknown blob " << bottom;
+                return false;
+            }
+            bottoms.push_back(it->second);
+        }
+
+        if (!deriveLayerCost(*layer, bottoms, topNames.size(), layerCost, tops))
+            return false;
+
+        for (size_t t = 0; t < topNames.size(); ++t) {
+            const bool inPlace = std::find(bottomNames.begin(), bottomNames.end(), topNames.at(t)) != bottomNames.end();
+            if (!inPlace && layerCost.type != "Split")
+                layerCost.activationBytes += volumeOf(tops.at(t)) * sizeof(float);
+            cost.blobShapes[topNames.at(t)] = tops.at(t);
+        }
+
+        cost.flops += layerCost.flops;
+        cost.paramBytes += layerCost.paramBytes;
+        cost.layers.push_back(layerCost);
+        layerBottoms.push_back(bottomNames);
+        layerTops.push_back(topNames);
+    }
+
+    // Outputs default to the blobs which no later layer consumes
+    cost.outputs = outputs;
+    if (cost.outputs.empty()) {
+        for (size_t l = 0; l < layerTops.size(); ++l) {
+            for (const std::string &top : layerTops.at(l)) {
+                bool consumed = false;
+                for (size_t k = l + 1; k < layerBottoms.size() && !consumed; ++k)
+                    consumed = std::find(layerBottoms.at(k).begin(), layerBottoms.at(k).end(), top) != layerBottoms.at(k).end();
+                if (!consumed && std::find(cost.outputs.begin(), cost.outputs.end(), top) == cost.outputs.end())
+                    cost.outputs.push_back(top);
+            }
+        }
+    }
+
+    std::set<std::string> ioBlobs(cost.inputs.begin(), cost.inputs.end());
+    for (const std::string &output : cost.outputs) {
+        if (!cost.blobShapes.count(output)) {
+            TRTLog(ERROR) << "Unknown output blob " << output;
+            return false;
+        }
+        ioBlobs.insert(output);
+    }
+    for (const std::string &blob : ioBlobs)
+        cost.ioBytes += volumeOf(cost.blobShapes.at(blob)) * sizeof(float);
+
+    // The internal blobs are alive from their first producer to their last consumer
+    std::map<std::string, std::pair<size_t, size_t> > lifetimes;
+    for (size_t l = 0; l < layerTops.size(); ++l) {
+        for (const std::vector<std::string> *names : {&layerTops.at(l), &layerBottoms.at(l)}) {
+            for (const std::string &name : *names) {
+                if (ioBlobs.count(name))
+                    continue;
+                std::map<std::string, std::pair<size_t, size_t> >::iterator it = lifetimes.find(name);
+                if (it == lifetimes.end())
+                    lifetimes[name] = std::make_pair(l, l);
+                else
+                    it->second.second = l;
+            }
+        }
+    }
+
+    typedef std::map<std::string, std::pair<size_t, size_t> >::const_iterator it_t;
+    for (it_t it = lifetimes.begin(); it != lifetimes.end(); ++it)
+        cost.activationBytes += volumeOf(cost.blobShapes.at(it->first)) * sizeof(float);
+    for (size_t l = 0; l < layerTops.size(); ++l) {
+        size_t alive = 0;
+        for (it_t it = lifetimes.begin(); it != lifetimes.end(); ++it)
+            if (it->second.first <= l && l <= it->second.second)
+                alive += volumeOf(cost.blobShapes.at(it->first)) * sizeof(float);
+        cost.peakActivationBytes = std::max(cost.peakActivationBytes, alive);
+    }
+
+    return true;
+}
+
+} // namespace trt
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * This file implements a static cost model of Caffe networks: the shapes,
+ * compute and memory of every layer are derived from the deploy prototxt
+ * alone, so the footprint of a model can be planned before building its
+ * engine on a GPU.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <iostream>
+#include <cstdint>
+
+#include "DeviceMemory.hpp"
+
+namespace trt {
+
+/**
+ * @brief Message of a protobuf text file, e.g. a prototxt. The scalar
+ *        fields and the nested messages are kept in file order, and a
+ *        repeated field simply appears several times.
+ */
+struct ProtoMessage
+{
+    std::vector< std::pair<std::string, std::string> > fields;
+    std::vector< std::pair<std::string, std::shared_ptr<ProtoMessage> > > messages;
+
+    bool has(const std::string &key) const;
+    std::string get(const std::string &key, const std::string &fallback = "") const;
+    std::vector<std::string> getAll(const std::string &key) const;
+    int getInt(const std::string &key, int fallback = 0) const;
+    bool getBool(const std::string &key, bool fallback = false) const;
+
+    /**
+     * @return message  The first message of that name, nullptr if none.
+     */
+    const ProtoMessage* getMessage(const std::string &key) const;
+    std::vector<const ProtoMessage*> getMessages(const std::string &key) const;
+};
+
+/**
+ * @brief Parse protobuf text without its schema. Enough for prototxt
+ *        files: comments, quoted strings and nested messages.
+ */
+bool parsePrototxt(const std::string &text, ProtoMessage &root);
+bool readPrototxt(const std::string &path, ProtoMessage &root);
+
+/**
+ * @brief Cost of one layer for a single sample. Shapes exclude the batch
+ *        dimension, like TRTNetwork::getBlobShape.
+ */
+struct LayerCost
+{
+    std::string name;
+    std::string type;
+    std::vector<int> outputShape;   // Shape of the first top
+    double flops = 0.0;             // Multiply-adds count as 2
+    size_t paramBytes = 0;          // Weights and biases in FP32
+    size_t activationBytes = 0;     // Tops of the layer, 0 when in place
+    bool supported = true;          // False if the cost is unknown, the shape is assumed unchanged
+};
+
+std::ostream& operator<< (std::ostream &os, const LayerCost &layer);
+
+/**
+ * @brief Cost of a whole network for a single sample.
+ */
+struct NetworkCost
+{
+    std::vector<LayerCost> layers;
+    std::map< std::string, std::vector<int> > blobShapes;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+
+    double flops = 0.0;
+    size_t paramBytes = 0;
+    size_t activationBytes = 0;     // Sum over the internal blobs
+    size_t peakActivationBytes = 0; // Max of the internal blobs alive at once
+    size_t ioBytes = 0;             // Input and output blobs, i.e. the IOBlobs
+
+    /**
+     * @brief Estimate the device memory of a TRTNetwork built with these
+     *        arguments. The weights are counted as engine bytes and the
+     *        activations at the peak as workspace, on top of the max
+     *        workspace size. The engine reuses the activation memory more
+     *        aggressively and fuses layers, so this is an upper bound.
+     */
+    MemoryFootprint estimateFootprint(int maxBatchSize, size_t maxWorkspaceSize = 1 << 25) const;
+
+    /**
+     * @return batchSize    The largest max batch size of one instance
+     *                      whose footprint fits the budget, 0 if none.
+     */
+    int maxBatchSizeWithin(size_t budget, size_t maxWorkspaceSize = 1 << 25) const;
+
+    /**
+     * @return instances    Number of instances of that max batch size
+     *                      which fit the budget together.
+     */
+    int maxInstancesWithin(size_t budget, int maxBatchSize, size_t maxWorkspaceSize = 1 << 25) const;
+};
+
+std::ostream& operator<< (std::ostream &os, const NetworkCost &cost);
+
+/**
+ * @brief Derive the cost of a network from its deploy prototxt.
+ * @param outputs       The output blobs, as passed to TRTNetwork. If empty,
+ *                      every blob which no layer consumes.
+ * @param inputHeight   Resize the first input blob, with the same semantics
+ * @param inputWidth    as TRTBuilder::createEngine. 0 keeps the prototxt one.
+ * @return success      False if the prototxt cannot be parsed or a shape
+ *                      cannot be derived. Unknown layer types only warn.
+ */
+bool estimateCost(const std::string &deploy, const std::vector<std::string> &outputs, NetworkCost &cost,
+                  int inputHeight = 0, int inputWidth = 0);
+
+/**
+ * @brief The same from an already parsed prototxt.
+ */
+bool estimateCost(const ProtoMessage &deploy, const std::vector<std::string> &outputs, NetworkCost &cost,
+                  int inputHeight = 0, int inputWidth = 0);
+
+} // namespace trt
@@ -0,0 +1,247 @@
+#include "Detection.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "Logger.hpp"
+#include "ThreadPool.hpp"
+
+namespace trt {
+
+std::ostream& operator<< (std::ostream &os, const Detection &detection)
+{
+    os << "label " << detection.label << " score " << detection.score
+       << " [" << detection.box.xmin << ", " << detection.box.ymin << ", "
+       << detection.box.xmax << ", " << detection.box.ymax << "]";
+    return os;
+}
+
+Box decodeBox(const float *loc, const float *prior, const float *variance)
+{
+    const float priorWidth = prior[2] - prior[0];
+    const float priorHeight = prior[3] - prior[1];
+    const float priorCenterX = (prior[0] + prior[2]) * 0.5f;
+    const float priorCenterY = (prior[1] + prior[3]) * 0.5f;
+
+    const float centerX = variance[0] * loc[0] * priorWidth + priorCenterX;
+    const float centerY = variance[1] * loc[1] * priorHeight + priorCenterY;
+    const float width = std::exp(variance[2] * loc[2]) * priorWidth;
+    const float height = std::exp(variance[3] * loc[3]) * priorHeight;
+
+    Box box;
+    box.xmin = centerX - width * 0.5f;
+    box.ymin = centerY - height * 0.5f;
+    box.xmax = centerX + width * 0.5f;
+    box.ymax = centerY + height * 0.5f;
+    return box;
+}
+
+static float boxArea(const Box &box)
+{
+    if (box.xmax < box.xmin || box.ymax < box.ymin)
+        return 0.f;
+    return (box.xmax - box.xmin) * (box.ymax - box.ymin);
+}
+
+float jaccardOverlap(const Box &a, const Box &b)
+{
+    const float w = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+    const float h = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+    if (w <= 0.f || h <= 0.f)
+        return 0.f;
+    const float inter = w * h;
+    return inter / (boxArea(a) + boxArea(b) - inter);
+}
+
+void nmsSorted(float *x1, float *y1, float *x2, float *y2, float *area,
+               int count, float threshold, std::vector<int> &kept)
+{
+    kept.clear();
+
+    for (int i = 0; i < count; ++i) {
+        /* Compare box i with the kept boxes, which are compacted in
+         * [0, numKept). The test inter / union > threshold is done as
+         * inter > threshold * union to keep the division out of the loop. */
+        const int numKept = kept.size();
+        bool keep = true;
+        int k = 0;
+#ifdef __AVX__
+        const __m256 bx1 = _mm256_set1_ps(x1[i]);
+        const __m256 by1 = _mm256_set1_ps(y1[i]);
+        const __m256 bx2 = _mm256_set1_ps(x2[i]);
+        const __m256 by2 = _mm256_set1_ps(y2[i]);
+        const __m256 barea = _mm256_set1_ps(area[i]);
+        const __m256 thr = _mm256_set1_ps(threshold);
+        const __m256 zero = _mm256_setzero_ps();
+
+        for (; keep && k + 8 <= numKept; k += 8) {
+            __m256 w = _mm256_sub_ps(_mm256_min_ps(bx2, _mm256_loadu_ps(x2 + k)),
+                                     _mm256_max_ps(bx1, _mm256_loadu_ps(x1 + k)));
+            __m256 h = _mm256_sub_ps(_mm256_min_ps(by2, _mm256_loadu_ps(y2 + k)),
+                                     _mm256_max_ps(by1, _mm256_loadu_ps(y1 + k)));
+            __m256 inter = _mm256_mul_ps(_mm256_max_ps(w, zero), _mm256_max_ps(h, zero));
+            __m256 uni = _mm256_sub_ps(_mm256_add_ps(barea, _mm256_loadu_ps(area + k)), inter);
+            keep = _mm256_movemask_ps(_mm256_cmp_ps(inter, _mm256_mul_ps(thr, uni), _CMP_GT_OQ)) == 0;
+        }
+#endif
+        for (; keep && k < numKept; ++k) {
+            float w = std::min(x2[i], x2[k]) - std::max(x1[i], x1[k]);
+            float h = std::min(y2[i], y2[k]) - std::max(y1[i], y1[k]);
+            float inter = std::max(w, 0.f) * std::max(h, 0.f);
+            keep = !(inter > threshold * (area[i] + area[k] - inter));
+        }
+
+        if (keep) {
+            x1[numKept] = x1[i];
+            y1[numKept] = y1[i];
+            x2[numKept] = x2[i];
+            y2[numKept] = y2[i];
+            area[numKept] = area[i];
+            kept.push_back(i);
+        }
+    }
+}
+
+DetectionOutput::DetectionOutput(const DetectionParams &params)
+    : params(params)
+{
+}
+
+const DetectionParams& DetectionOutput::getParams() const
+{
+    return params;
+}
+
+bool DetectionOutput::forward(const float *loc, const float *conf, const float *priors,
+                              int batchSize, int numPriors, std::vector< std::vector<Detection> > &detections)
+{
+    if (!loc || !conf || !priors || batchSize <= 0 || numPriors <= 0 || params.numClasses <= 0) {
+        TRTLog(ERROR) << "Invalid detection outputs: batch size " << batchSize << ", " << numPriors << " priors";
+        return false;
+    }
+
+    const int numLocClasses = params.shareLocation ? 1 : params.numClasses;
+    const size_t locPerBatch = (size_t)numPriors * numLocClasses * 4;
+    const size_t confPerBatch = (size_t)numPriors * params.numClasses;
+
+    /* One scratch per thread rather than per image: it is first touched,
+     * hence placed, by the thread which keeps using it, so it stays on
+     * the NUMA node of a pinned worker. Slot 0 is the calling thread. */
+    ThreadPool &pool = ThreadPool::globalInstance();
+    detections.resize(batchSize);
+    if ((int)scratches.size() < pool.getNumWorkers() + 1)
+        scratches.resize(pool.getNumWorkers() + 1);
+
+    pool.parallelFor(0, batchSize, [&](int n) {
+        processImage(loc + n * locPerBatch, conf + n * confPerBatch, priors, numPriors,
+                     scratches.at(pool.currentWorker() + 1), detections.at(n));
+    });
+    return true;
+}
+
+void DetectionOutput::processImage(const float *loc, const float *conf, const float *priors,
+                                   int numPriors, Scratch &scratch, std::vector<Detection> &detections) const
+{
+    const int numClasses = params.numClasses;
+    const int numLocClasses = params.shareLocation ? 1 : numClasses;
+    const float threshold = params.confidenceThreshold;
+    const float *variances = priors + numPriors * 4;
+
+    scratch.candidates.resize(numClasses);
+    for (std::vector<Candidate> &candidates : scratch.candidates)
+        candidates.clear();
+
+    // Prefilter by the confidence threshold, a row of class scores per prior
+    for (int p = 0; p < numPriors; ++p) {
+        const float *row = conf + (size_t)p * numClasses;
+        int c = 0;
+#ifdef __AVX__
+        const __m256 thr = _mm256_set1_ps(threshold);
+        for (; c + 8 <= numClasses; c += 8) {
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row + c), thr, _CMP_GT_OQ));
+            while (mask) {
+                int label = c + __builtin_ctz(mask);
+                if (label != params.backgroundLabel)
+                    scratch.candidates[label].push_back({row[label], p});
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; c < numClasses; ++c)
+            if (row[c] > threshold && c != params.backgroundLabel)
+                scratch.candidates[c].push_back({row[c], p});
+    }
+
+    scratch.decoded.resize((size_t)numPriors * numLocClasses);
+    scratch.isDecoded.assign((size_t)numPriors * numLocClasses, 0);
+    detections.clear();
+
+    // Higher score first, then lower prior index so that ties are deterministic
+    auto byScore = [](const Candidate &a, const Candidate &b) {
+        return a.score > b.score || (a.score == b.score && a.prior < b.prior);
+    };
+
+    for (int c = 0; c < numClasses; ++c) {
+        std::vector<Candidate> &candidates = scratch.candidates[c];
+        if (candidates.empty())
+            continue;
+
+        if (params.topK > 0 && (int)candidates.size() > params.topK) {
+            std::partial_sort(candidates.begin(), candidates.begin() + params.topK, candidates.end(), byScore);
+            candidates.resize(params.topK);
+        } else {
+            std::sort(candidates.begin(), candidates.end(), byScore);
+        }
+
+        // Decode the surviving boxes once and lay them out for the NMS
+        const int count = candidates.size();
+        scratch.x1.resize(count);
+        scratch.y1.resize(count);
+        scratch.x2.resize(count);
+        scratch.y2.resize(count);
+        scratch.area.resize(count);
+
+        for (int k = 0; k < count; ++k) {
+            const int p = candidates[k].prior;
+            const size_t index = params.shareLocation ? p : (size_t)p * numClasses + c;
+            Box &box = scratch.decoded[index];
+            if (!scratch.isDecoded[index]) {
+                box = decodeBox(loc + index * 4, priors + p * 4, variances + p * 4);
+                if (params.clip) {
+                    box.xmin = std::min(std::max(box.xmin, 0.f), 1.f);
+                    box.ymin = std::min(std::max(box.ymin, 0.f), 1.f);
+                    box.xmax = std::min(std::max(box.xmax, 0.f), 1.f);
+                    box.ymax = std::min(std::max(box.ymax, 0.f), 1.f);
+                }
+                scratch.isDecoded[index] = 1;
+            }
+            scratch.x1[k] = box.xmin;
+            scratch.y1[k] = box.ymin;
+            scratch.x2[k] = box.xmax;
+            scratch.y2[k] = box.ymax;
+            scratch.area[k] = boxArea(box);
+        }
+
+        nmsSorted(scratch.x1.data(), scratch.y1.data(), scratch.x2.data(), scratch.y2.data(),
+                  scratch.area.data(), count, params.nmsThreshold, scratch.kept);
+
+        for (int k : scratch.kept) {
+            const int p = candidates[k].prior;
+            const size_t index = params.shareLocation ? p : (size_t)p * numClasses + c;
+            detections.push_back({c, candidates[k].score, scratch.decoded[index]});
+        }
+    }
+
+    // Keep the best detections over all classes
+    std::stable_sort(detections.begin(), detections.end(), [](const Detection &a, const Detection &b) {
+        return a.score > b.score;
+    });
+    if (params.keepTopK > 0 && (int)detections.size() > params.keepTopK)
+        detections.resize(params.keepTopK);
+}
+
+} // namespace trt
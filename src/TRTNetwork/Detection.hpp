@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * This file implements the postprocessing of SSD-style detectors: the
+ * decoding of the location outputs against the prior boxes, followed by
+ * per-class non-maximum suppression, the same as Caffe's DetectionOutput
+ * layer but on the CPU buffers returned by TRTNetwork::forward.
+ */
+
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+namespace trt {
+
+/**
+ * @brief Box in corner form, normalized to [0, 1] like the priors.
+ */
+struct Box
+{
+    float xmin, ymin, xmax, ymax;
+};
+
+struct Detection
+{
+    int label;
+    float score;
+    Box box;
+};
+
+std::ostream& operator<< (std::ostream &os, const Detection &detection);
+
+/**
+ * @brief Parameters of the postprocessing, named after the
+ *        detection_output_param of the Caffe prototxt.
+ */
+struct DetectionParams
+{
+    int numClasses = 21;        // Including the background
+    int backgroundLabel = 0;    // Negative if there is none
+    bool shareLocation = true;  // One box per prior instead of one per prior and class
+    float confidenceThreshold = 0.01f;
+    float nmsThreshold = 0.45f;
+    int topK = 400;             // Candidates per class kept for the NMS
+    int keepTopK = 200;         // Detections per image kept after the NMS
+    bool clip = false;          // Clip the decoded boxes to [0, 1]
+};
+
+/**
+ * @brief Batched detection postprocessing.
+ *
+ *        The inputs are the outputs of the network laid out as
+ *        [batch x sizePerBatch]:
+ *
+ *        loc     [batch x numPriors x numLocClasses x 4], the encoded
+ *                offsets (numLocClasses is 1 with shareLocation)
+ *        conf    [batch x numPriors x numClasses], the softmax scores
+ *        priors  [2 x numPriors x 4], the prior boxes followed by their
+ *                variances, as output by the PriorBox layers (shared by
+ *                the whole batch)
+ *
+ *        Boxes are decoded with the CENTER_SIZE code type. Only the priors
+ *        which pass the confidence threshold for some class are decoded.
+ *        The images of a batch are processed in parallel on the global
+ *        ThreadPool; the threshold prefilter and the overlap computations
+ *        of the NMS are vectorized with AVX when the library is compiled
+ *        with it.
+ *
+ *        Scratch buffers are kept between calls, one per thread of the
+ *        pool, so reuse one instance per network output.
+ */
+class DetectionOutput
+{
+public:
+    explicit DetectionOutput(const DetectionParams &params);
+
+    /**
+     * @param detections    Per image, sorted by decreasing score.
+     */
+    bool forward(const float *loc, const float *conf, const float *priors,
+                 int batchSize, int numPriors, std::vector< std::vector<Detection> > &detections);
+
+    const DetectionParams& getParams() const;
+
+protected:
+    struct Candidate
+    {
+        float score;
+        int prior;
+    };
+
+    /**
+     * @brief Working memory of one thread, reused for each of its images.
+     */
+    struct Scratch
+    {
+        std::vector< std::vector<Candidate> > candidates; // Per class
+        std::vector<Box> decoded;                          // Per prior and location class
+        std::vector<uint8_t> isDecoded;
+        std::vector<float> x1, y1, x2, y2, area;           // Boxes of one class in score order
+        std::vector<int> kept;
+    };
+
+    void processImage(const float *loc, const float *conf, const float *priors,
+                      int numPriors, Scratch &scratch, std::vector<Detection> &detections) const;
+
+    DetectionParams params;
+    std::vector<Scratch> scratches;
+};
+
+/**
+ * @brief Decode one encoded box against its prior (CENTER_SIZE).
+ * @param prior     Prior box in corner form.
+ * @param variance  Variances of the prior.
+ */
+Box decodeBox(const float *loc, const float *prior, const float *variance);
+
+/**
+ * @brief Intersection over union of two boxes, 0 if either is empty.
+ */
+float jaccardOverlap(const Box &a, const Box &b);
+
+/**
+ * @brief Greedy NMS over boxes already sorted by decreasing score, given
+ *        as structure of arrays. A box is kept if it overlaps none of the
+ *        boxes kept before it by more than the threshold.
+ *
+ *        The kept boxes are compacted to the front of the arrays as they
+ *        are found, so that each box is compared with the kept ones in
+ *        contiguous memory without extra buffers.
+ *
+ * @param kept      Indices of the kept boxes, in score order.
+ */
+void nmsSorted(float *x1, float *y1, float *x2, float *y2, float *area,
+               int count, float threshold, std::vector<int> &kept);
+
+} // namespace trt
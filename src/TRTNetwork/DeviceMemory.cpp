@@ -0,0 +1,151 @@
+#include "DeviceMemory.hpp"
+
+#include <algorithm>
+
+#include "cuda_runtime.h"
+
+#include "Logger.hpp"
+
+namespace trt {
+
+void* CudaDeviceAllocator::allocate(size_t bytes)
+{
+    void *ptr = nullptr;
+    cudaError_t err = cudaMalloc(&ptr, bytes);
+    if (err != cudaSuccess) {
+        TRTLog(ERROR) << "cudaMalloc of " << bytes << " bytes failed: " << cudaGetErrorString(err);
+        return nullptr;
+    }
+    return ptr;
+}
+
+void CudaDeviceAllocator::deallocate(void *ptr)
+{
+    cudaFree(ptr);
+}
+
+size_t MemoryFootprint::total() const
+{
+    return engineBytes + workspaceBytes + ioBlobBytes;
+}
+
+std::ostream& operator<< (std::ostream &os, const MemoryFootprint &footprint)
+{
+    os << "engine " << footprint.engineBytes
+       << " workspace " << footprint.workspaceBytes
+       << " IO " << footprint.ioBlobBytes
+       << " total " << footprint.total() << " bytes";
+    return os;
+}
+
+MemoryBudget& MemoryBudget::globalInstance()
+{
+    static MemoryBudget singletonBudget;
+    return singletonBudget;
+}
+
+MemoryBudget::MemoryBudget()
+    : allocator(std::make_shared<CudaDeviceAllocator>())
+{
+}
+
+void MemoryBudget::setLimit(size_t bytes)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    limit = bytes;
+    released.notify_all(); // A larger limit may unblock deferred reservations
+}
+
+void MemoryBudget::setPolicy(BudgetPolicy policy, std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    this->policy = policy;
+    this->timeout = timeout;
+}
+
+void MemoryBudget::setAllocator(std::shared_ptr<DeviceAllocator> allocator)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    this->allocator = allocator;
+}
+
+std::shared_ptr<DeviceAllocator> MemoryBudget::getAllocator() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return allocator;
+}
+
+bool MemoryBudget::reserve(size_t bytes)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+
+    auto fits = [&]() { return limit == 0 || used + bytes <= limit; };
+
+    // A reservation larger than the limit itself would never succeed
+    if (!fits() && (policy == BudgetPolicy::kREJECT || bytes > limit))
+        return false;
+
+    if (!fits()) {
+        if (timeout.count() == 0)
+            released.wait(lock, fits);
+        else if (!released.wait_for(lock, timeout, fits))
+            return false;
+    }
+
+    used += bytes;
+    return true;
+}
+
+void MemoryBudget::release(size_t bytes)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    used = bytes > used ? 0 : used - bytes;
+    released.notify_all();
+}
+
+bool MemoryBudget::resize(size_t reserved, size_t bytes)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (bytes <= reserved) {
+        size_t freed = reserved - bytes;
+        used = freed > used ? 0 : used - freed;
+        released.notify_all();
+        return true;
+    }
+
+    size_t grown = bytes - reserved;
+    if (limit != 0 && used + grown > limit)
+        return false;
+    used += grown;
+    return true;
+}
+
+size_t MemoryBudget::estimateReservation(size_t estimate) const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (policy == BudgetPolicy::kREJECT)
+        return 0;
+    return limit == 0 ? estimate : std::min(estimate, limit);
+}
+
+size_t MemoryBudget::getLimit() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return limit;
+}
+
+size_t MemoryBudget::getUsed() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return used;
+}
+
+size_t MemoryBudget::getAvailable() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (limit == 0)
+        return static_cast<size_t>(-1);
+    return used >= limit ? 0 : limit - used;
+}
+
+} // namespace trt
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+ * This file implements the accounting of device memory used by the
+ * network instances of a process and the enforcement of a global budget,
+ * so that packing several models onto one card fails early with a clear
+ * error instead of an unchecked cudaMalloc.
+ */
+
+#include <string>
+#include <iostream>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+
+namespace trt {
+
+/**
+ * @brief Device allocator interface used for the IOBlobs.
+ *
+ *        The default implementation calls cudaMalloc and cudaFree. A mock
+ *        can be installed on the MemoryBudget to test the accounting
+ *        without a GPU.
+ */
+class DeviceAllocator
+{
+public:
+    virtual ~DeviceAllocator() = default;
+
+    /**
+     * @return ptr      Device pointer, or nullptr on failure.
+     */
+    virtual void* allocate(size_t bytes) = 0;
+    virtual void deallocate(void *ptr) = 0;
+};
+
+class CudaDeviceAllocator : public DeviceAllocator
+{
+public:
+    void* allocate(size_t bytes) override;
+    void deallocate(void *ptr) override;
+};
+
+/**
+ * @brief Device memory used by one network instance.
+ */
+struct MemoryFootprint
+{
+    size_t engineBytes = 0;    // Weights and engine data, measured by serialization
+    size_t workspaceBytes = 0; // Scratch memory of the layers
+    size_t ioBlobBytes = 0;    // IOBlobs for the max batch size
+
+    size_t total() const;
+};
+
+std::ostream& operator<< (std::ostream &os, const MemoryFootprint &footprint);
+
+/**
+ * @brief Thrown by the TRTNetwork constructor when the network does not
+ *        fit into the budget or its memory cannot be allocated.
+ */
+class DeviceMemoryError : public std::runtime_error
+{
+public:
+    explicit DeviceMemoryError(const std::string &what)
+        : std::runtime_error(what) {}
+};
+
+/**
+ * @brief What to do with a reservation which exceeds the budget.
+ */
+enum class BudgetPolicy
+{
+    kREJECT, // Fail immediately
+    kDEFER   // Wait until enough memory is released or the timeout expires
+};
+
+/**
+ * @brief Process-wide device memory budget.
+ *
+ *        Every TRTNetwork reserves its footprint here before allocating
+ *        its IOBlobs and releases it on destruction. For resource saving
+ *        purpose, we use a global singleton like the Logger does.
+ */
+class MemoryBudget
+{
+public:
+    static MemoryBudget& globalInstance();
+
+    MemoryBudget();
+
+    /**
+     * @brief Set the limit in bytes. 0 means unlimited (default).
+     */
+    void setLimit(size_t bytes);
+
+    /**
+     * @param timeout   Max waiting time of kDEFER. Zero waits forever.
+     */
+    void setPolicy(BudgetPolicy policy,
+                   std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    /**
+     * @brief Install the allocator used for the IOBlobs of the networks
+     *        created from now on. Each IOBlob keeps the allocator it was
+     *        allocated with and frees its memory through it.
+     */
+    void setAllocator(std::shared_ptr<DeviceAllocator> allocator);
+    std::shared_ptr<DeviceAllocator> getAllocator() const;
+
+    /**
+     * @return success   False if the reservation does not fit into the
+     *                   limit, after waiting in case of kDEFER.
+     */
+    bool reserve(size_t bytes);
+    void release(size_t bytes);
+
+    /**
+     * @brief Change a reservation of reserved bytes into one of bytes, e.g.
+     *        to true up an estimate. Shrinking always succeeds. Growing
+     *        never waits, even with kDEFER, since the caller holds memory
+     *        which the waiting would keep from the others.
+     * @return success   False if the growth does not fit into the limit,
+     *                   the reservation is left unchanged then.
+     */
+    bool resize(size_t reserved, size_t bytes);
+
+    /**
+     * @brief Part of an estimated footprint to reserve before the measured
+     *        one is known. The estimate is an upper bound at best, so under
+     *        kREJECT nothing is reserved and only the measured footprint
+     *        can be rejected. Under kDEFER the estimate, capped at the limit,
+     *        is reserved so that the wait happens before the engine is built.
+     */
+    size_t estimateReservation(size_t estimate) const;
+
+    size_t getLimit() const;
+    size_t getUsed() const;
+    size_t getAvailable() const;
+
+protected:
+    mutable std::mutex mtx;
+    std::condition_variable released;
+
+    size_t limit = 0;
+    size_t used = 0;
+    BudgetPolicy policy = BudgetPolicy::kREJECT;
+    std::chrono::milliseconds timeout{0};
+
+    std::shared_ptr<DeviceAllocator> allocator;
+};
+
+} // namespace trt
@@ -0,0 +1,26 @@
+#include "Executor.hpp"
+
+#include "TRTNetwork.hpp"
+
+namespace trt {
+
+void NetworkExecutor::addNetwork(TRTNetwork &network)
+{
+    networks[network.getName()] = &network;
+    locks[network.getName()];
+}
+
+bool NetworkExecutor::execute(const std::string &model, int batchSize,
+                              const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    std::map<std::string, TRTNetwork*>::iterator it = networks.find(model);
+    if (it == networks.end()) {
+        TRTLog(ERROR) << "No network named " << model;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> locker(locks.find(model)->second);
+    return it->second->forward(batchSize, feedDict);
+}
+
+} // namespace trt
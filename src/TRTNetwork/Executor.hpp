@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+namespace trt {
+
+class TRTNetwork;
+
+/**
+ * @brief Abstraction of whatever runs an inference.
+ *
+ *        Components which decide when and where inferences happen, e.g.
+ *        the Scheduler, talk to an Executor instead of TRTNetwork so that
+ *        their logic can be exercised with a fake executor on CPU.
+ */
+class Executor
+{
+public:
+    virtual ~Executor() = default;
+
+    /**
+     * @brief Run one inference of the named model. The arguments are the
+     *        same as TRTNetwork::forward.
+     */
+    virtual bool execute(const std::string &model, int batchSize,
+                         const std::vector< std::pair<std::string, void*> > &feedDict) = 0;
+};
+
+/**
+ * @brief Executor which dispatches to TRTNetwork instances by their name.
+ *
+ *        The networks are not owned and must outlive the executor.
+ */
+class NetworkExecutor : public Executor
+{
+public:
+    void addNetwork(TRTNetwork &network);
+
+    bool execute(const std::string &model, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict) override;
+
+protected:
+    std::map<std::string, TRTNetwork*> networks;
+
+    /**
+     * @brief TRTNetwork::forward is not reentrant because the bindings and
+     *        the IOBlobs are shared, so calls are serialized per network.
+     */
+    std::map<std::string, std::mutex> locks;
+};
+
+} // namespace trt
@@ -0,0 +1,101 @@
+#include "Hash.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace trt {
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+/**
+ * @brief MurmurHash3 x64_128 by Austin Appleby (public domain), with the
+ *        two 64-bit lanes seeded from a previous digest.
+ */
+Hash128 hash128(const void *data, size_t len, const Hash128 &seed)
+{
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    const size_t nblocks = len / 16;
+
+    uint64_t h1 = seed.lo;
+    uint64_t h2 = seed.hi;
+
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    for (size_t i = 0; i < nblocks; ++i) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, bytes + i * 16, sizeof(k1));
+        std::memcpy(&k2, bytes + i * 16 + 8, sizeof(k2));
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t *tail = bytes + nblocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+
+    switch (len & 15) {
+    case 15: k2 ^= uint64_t(tail[14]) << 48; // fall through
+    case 14: k2 ^= uint64_t(tail[13]) << 40; // fall through
+    case 13: k2 ^= uint64_t(tail[12]) << 32; // fall through
+    case 12: k2 ^= uint64_t(tail[11]) << 24; // fall through
+    case 11: k2 ^= uint64_t(tail[10]) << 16; // fall through
+    case 10: k2 ^= uint64_t(tail[ 9]) << 8;  // fall through
+    case  9: k2 ^= uint64_t(tail[ 8]) << 0;
+             k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+             // fall through
+    case  8: k1 ^= uint64_t(tail[ 7]) << 56; // fall through
+    case  7: k1 ^= uint64_t(tail[ 6]) << 48; // fall through
+    case  6: k1 ^= uint64_t(tail[ 5]) << 40; // fall through
+    case  5: k1 ^= uint64_t(tail[ 4]) << 32; // fall through
+    case  4: k1 ^= uint64_t(tail[ 3]) << 24; // fall through
+    case  3: k1 ^= uint64_t(tail[ 2]) << 16; // fall through
+    case  2: k1 ^= uint64_t(tail[ 1]) << 8;  // fall through
+    case  1: k1 ^= uint64_t(tail[ 0]) << 0;
+             k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len; h2 ^= len;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+
+    Hash128 digest;
+    digest.lo = h1;
+    digest.hi = h2;
+    return digest;
+}
+
+bool hashFile(const std::string &path, Hash128 &digest)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::vector<char> chunk(1 << 20);
+    while (file) {
+        file.read(chunk.data(), chunk.size());
+        if (file.gcount() > 0)
+            digest = hash128(chunk.data(), (size_t)file.gcount(), digest);
+    }
+    return file.eof();
+}
+
+} // namespace trt
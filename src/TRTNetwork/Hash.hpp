@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace trt {
+
+/**
+ * @brief 128-bit digest used as the content address of an inference.
+ */
+struct Hash128
+{
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator== (const Hash128& other) const
+    {
+        return lo == other.lo && hi == other.hi;
+    }
+};
+
+struct Hash128Hasher
+{
+    size_t operator() (const Hash128& h) const
+    {
+        return static_cast<size_t>(h.lo ^ (h.hi * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+/**
+ * @brief MurmurHash3 x64_128 of a byte range. The seed is a previous
+ *        digest so that several buffers can be chained into one key.
+ */
+Hash128 hash128(const void *data, size_t len, const Hash128 &seed = Hash128());
+
+/**
+ * @brief Chain the content of a file into a digest.
+ * @return success  False if the file cannot be read.
+ */
+bool hashFile(const std::string &path, Hash128 &digest);
+
+} // namespace trt
@@ -0,0 +1,243 @@
+#include "HostTensorPool.hpp"
+
+#include <cstdint>
+
+#include "cuda_runtime.h"
+
+#include "TRTNetwork.hpp"
+#include "Logger.hpp"
+
+namespace trt {
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void* PinnedHostAllocator::allocate(size_t bytes, size_t alignment)
+{
+    void *base = nullptr;
+    cudaError_t err = cudaHostAlloc(&base, bytes + alignment, cudaHostAllocPortable);
+    if (err != cudaSuccess) {
+        TRTLog(ERROR) << "cudaHostAlloc of " << bytes << " bytes failed: " << cudaGetErrorString(err);
+        return nullptr;
+    }
+
+    void *aligned = reinterpret_cast<void*>(alignUp(reinterpret_cast<uintptr_t>(base), alignment));
+    std::lock_guard<std::mutex> locker(mtx);
+    basePtrs[aligned] = base;
+    return aligned;
+}
+
+void PinnedHostAllocator::deallocate(void *ptr)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    std::map<void*, void*>::iterator it = basePtrs.find(ptr);
+    if (it == basePtrs.end())
+        return;
+    cudaError_t err = cudaFreeHost(it->second);
+    if (err != cudaSuccess)
+        TRTLog(ERROR) << "cudaFreeHost failed: " << cudaGetErrorString(err);
+    basePtrs.erase(it);
+}
+
+bool PinnedHostAllocator::registerMemory(void *ptr, size_t bytes)
+{
+    cudaError_t err = cudaHostRegister(ptr, bytes, cudaHostRegisterPortable);
+    if (err != cudaSuccess) {
+        TRTLog(ERROR) << "cudaHostRegister of " << bytes << " bytes failed: " << cudaGetErrorString(err);
+        return false;
+    }
+    return true;
+}
+
+void PinnedHostAllocator::unregisterMemory(void *ptr)
+{
+    cudaError_t err = cudaHostUnregister(ptr);
+    if (err != cudaSuccess)
+        TRTLog(ERROR) << "cudaHostUnregister failed: " << cudaGetErrorString(err);
+}
+
+/**
+ * @brief Process-wide registry of the pinned ranges of every pool.
+ *        Function-local statics avoid the static initialization order
+ *        problem for pools created at namespace scope.
+ */
+static std::mutex& registryMutex()
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+static std::map<uintptr_t, size_t>& registry()
+{
+    static std::map<uintptr_t, size_t> ranges; // Begin -> bytes
+    return ranges;
+}
+
+void HostTensorPool::addPinnedRange(const void *ptr, size_t bytes)
+{
+    std::lock_guard<std::mutex> locker(registryMutex());
+    registry()[reinterpret_cast<uintptr_t>(ptr)] = bytes;
+}
+
+void HostTensorPool::removePinnedRange(const void *ptr)
+{
+    std::lock_guard<std::mutex> locker(registryMutex());
+    registry().erase(reinterpret_cast<uintptr_t>(ptr));
+}
+
+bool HostTensorPool::isPinned(const void *ptr, size_t bytes)
+{
+    uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+
+    std::lock_guard<std::mutex> locker(registryMutex());
+    std::map<uintptr_t, size_t>::const_iterator it = registry().upper_bound(begin);
+    if (it == registry().cbegin())
+        return false;
+    --it;
+    return begin + bytes <= it->first + it->second;
+}
+
+HostTensorPool::HostTensorPool(std::shared_ptr<HostAllocator> allocator, size_t alignment)
+    : allocator(allocator),
+      alignment(alignment)
+{
+}
+
+HostTensorPool::~HostTensorPool()
+{
+    std::lock_guard<std::mutex> locker(mtx);
+
+    /* Freeing buffers which are still checked out would pull the memory
+     * from under their users, e.g. a transfer still in flight, so they
+     * are leaked instead and stay page-locked. */
+    if (!inUse.empty())
+        TRTLog(ERROR) << inUse.size() << " pooled host buffers (" << bytesInUse()
+                      << " bytes) are still in use when the pool is destroyed, they are leaked";
+
+    for (const std::pair<const size_t, void*> &kv : idle) {
+        removePinnedRange(kv.second);
+        allocator->deallocate(kv.second);
+    }
+    for (const std::pair<void* const, size_t> &kv : registered) {
+        removePinnedRange(kv.first);
+        allocator->unregisterMemory(kv.first);
+    }
+}
+
+void* HostTensorPool::acquire(size_t bytes)
+{
+    size_t capacity = alignUp(bytes ? bytes : 1, alignment);
+
+    std::lock_guard<std::mutex> locker(mtx);
+
+    /* Reuse the smallest idle buffer which fits, unless it would waste
+     * more than half of its capacity. */
+    std::multimap<size_t, void*>::iterator it = idle.lower_bound(capacity);
+    if (it != idle.end() && it->first <= 2 * capacity) {
+        void *ptr = it->second;
+        inUse[ptr] = it->first;
+        idle.erase(it);
+        return ptr;
+    }
+
+    void *ptr = allocator->allocate(capacity, alignment);
+    if (!ptr)
+        return nullptr;
+
+    ++numAllocations;
+    bytesAllocated += capacity;
+    inUse[ptr] = capacity;
+    addPinnedRange(ptr, capacity);
+    return ptr;
+}
+
+float* HostTensorPool::acquire(const TRTNetwork &network, const std::string &blob)
+{
+    std::vector<int> shape = network.getBlobShape(blob);
+    if (shape.empty()) {
+        TRTLog(ERROR) << "Network " << network.getName() << " has no blob " << blob;
+        return nullptr;
+    }
+
+    size_t vol = network.getMaxBatchSize();
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return static_cast<float*>(acquire(vol * sizeof(float)));
+}
+
+bool HostTensorPool::release(void *ptr)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    std::map<void*, size_t>::iterator it = inUse.find(ptr);
+    if (it == inUse.end())
+        return false;
+
+    idle.insert(std::make_pair(it->second, ptr));
+    inUse.erase(it);
+    return true;
+}
+
+bool HostTensorPool::registerMemory(void *ptr, size_t bytes)
+{
+    if (!allocator->registerMemory(ptr, bytes))
+        return false;
+
+    std::lock_guard<std::mutex> locker(mtx);
+    registered[ptr] = bytes;
+    addPinnedRange(ptr, bytes);
+    return true;
+}
+
+bool HostTensorPool::unregisterMemory(void *ptr)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    std::map<void*, size_t>::iterator it = registered.find(ptr);
+    if (it == registered.end())
+        return false;
+
+    removePinnedRange(ptr);
+    allocator->unregisterMemory(ptr);
+    registered.erase(it);
+    return true;
+}
+
+size_t HostTensorPool::getAlignment() const
+{
+    return alignment;
+}
+
+size_t HostTensorPool::getNumAllocations() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return numAllocations;
+}
+
+size_t HostTensorPool::getNumInUse() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return inUse.size();
+}
+
+size_t HostTensorPool::getNumIdle() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return idle.size();
+}
+
+size_t HostTensorPool::getBytesAllocated() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return bytesAllocated;
+}
+
+size_t HostTensorPool::bytesInUse() const
+{
+    size_t bytes = 0;
+    for (const std::pair<void* const, size_t> &kv : inUse)
+        bytes += kv.second;
+    return bytes;
+}
+
+} // namespace trt
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <cstddef>
+
+namespace trt {
+
+class TRTNetwork;
+
+/**
+ * @brief Allocator interface of the HostTensorPool.
+ *
+ *        The default implementation allocates page-locked memory through
+ *        the Cuda runtime. A stand-in allocator can be passed to the pool
+ *        to exercise its reuse and alignment logic without a GPU.
+ */
+class HostAllocator
+{
+public:
+    virtual ~HostAllocator() = default;
+
+    /**
+     * @return ptr      Buffer of at least bytes aligned to alignment,
+     *                  or nullptr on failure.
+     */
+    virtual void* allocate(size_t bytes, size_t alignment) = 0;
+    virtual void deallocate(void *ptr) = 0;
+
+    /**
+     * @brief Page-lock an existing caller buffer.
+     */
+    virtual bool registerMemory(void *ptr, size_t bytes) = 0;
+    virtual void unregisterMemory(void *ptr) = 0;
+};
+
+/**
+ * @brief HostAllocator backed by cudaHostAlloc and cudaHostRegister.
+ */
+class PinnedHostAllocator : public HostAllocator
+{
+public:
+    void* allocate(size_t bytes, size_t alignment) override;
+    void deallocate(void *ptr) override;
+    bool registerMemory(void *ptr, size_t bytes) override;
+    void unregisterMemory(void *ptr) override;
+
+protected:
+    std::mutex mtx;
+    std::map<void*, void*> basePtrs; // Aligned pointer -> pointer returned by Cuda
+};
+
+/**
+ * @brief Pool of reusable page-locked host buffers for network IO.
+ *
+ *        Copies from pageable memory (e.g. new float[]) are staged by the
+ *        Cuda driver through an internal pinned buffer and are always
+ *        synchronous. Buffers handed out by the pool, or caller memory
+ *        registered through it, are page-locked so that TRTNetwork::forward
+ *        transfers them asynchronously by DMA without the staging copy.
+ *
+ *        // Input and output buffers for the whole max batch
+ *        trt::HostTensorPool pool;
+ *        float *data_ptr = pool.acquire(network, "data");
+ *        float *prob_ptr = pool.acquire(network, "prob");
+ *        ...
+ *        pool.release(data_ptr);
+ *        pool.release(prob_ptr);
+ *
+ *        Released buffers are kept and handed out again to later requests
+ *        of a similar size and are freed with the pool. Buffers must be
+ *        released before the pool is destroyed: those still in use are
+ *        reported and leaked rather than freed under their users.
+ */
+class HostTensorPool
+{
+public:
+    explicit HostTensorPool(std::shared_ptr<HostAllocator> allocator = std::make_shared<PinnedHostAllocator>(),
+                            size_t alignment = 256);
+
+    HostTensorPool(const HostTensorPool& other) = delete;
+    HostTensorPool& operator= (const HostTensorPool& other) = delete;
+
+    ~HostTensorPool();
+
+    /**
+     * @brief Acquire a buffer of at least bytes.
+     * @return ptr      Aligned buffer, or nullptr if the allocation failed.
+     */
+    void* acquire(size_t bytes);
+
+    /**
+     * @brief Acquire a float buffer sized for a blob of the network at
+     *        its max batch size, i.e. getBlobShape(blob) x maxBatchSize.
+     */
+    float* acquire(const TRTNetwork &network, const std::string &blob);
+
+    /**
+     * @brief Return a buffer to the pool for reuse.
+     */
+    bool release(void *ptr);
+
+    /**
+     * @brief Page-lock caller memory so that forward() treats it the same
+     *        way as pooled buffers. It must be unregistered before freed.
+     */
+    bool registerMemory(void *ptr, size_t bytes);
+    bool unregisterMemory(void *ptr);
+
+    /**
+     * @brief Whether the whole range lies in a pooled or registered buffer
+     *        of any pool in this process.
+     */
+    static bool isPinned(const void *ptr, size_t bytes);
+
+    size_t getAlignment() const;
+    size_t getNumAllocations() const; // Calls made to the allocator
+    size_t getNumInUse() const;
+    size_t getNumIdle() const;
+    size_t getBytesAllocated() const;
+
+protected:
+    static void addPinnedRange(const void *ptr, size_t bytes);
+    static void removePinnedRange(const void *ptr);
+    size_t bytesInUse() const; // Requires mtx
+
+    std::shared_ptr<HostAllocator> allocator;
+    const size_t alignment;
+
+    mutable std::mutex mtx;
+    std::multimap<size_t, void*> idle;  // Capacity -> buffer
+    std::map<void*, size_t> inUse;      // Buffer -> capacity
+    std::map<void*, size_t> registered; // Caller buffer -> bytes
+
+    size_t numAllocations = 0;
+    size_t bytesAllocated = 0;
+};
+
+} // namespace trt
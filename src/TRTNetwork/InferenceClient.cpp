@@ -0,0 +1,149 @@
+#include "InferenceClient.hpp"
+
+#include <cstring>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+/** @note Period at which waiting clients check that the server is alive. */
+static const int CLIENT_POLL_MS = 100;
+
+bool InferenceClient::connect(const std::string &name)
+{
+    if (!channel.open(name))
+        return false;
+    if (!channel.getHeader()->serverAlive.load()) {
+        TRTLog(ERROR) << "Server of " << name << " is not running";
+        channel.close();
+        return false;
+    }
+    return true;
+}
+
+void InferenceClient::disconnect()
+{
+    channel.close();
+}
+
+bool InferenceClient::acquire(uint64_t &ticket)
+{
+    ShmHeader *header = channel.getHeader();
+    if (!header || !header->serverAlive.load()) {
+        TRTLog(ERROR) << "Server is not running";
+        return false;
+    }
+    ticket = header->head.fetch_add(1);
+
+    // The slot is free once the previous lap released it
+    ShmSlot *slot = channel.getSlot(ticket);
+    while (!ShmChannel::waitTurn(slot->turn, channel.turnOf(ticket, ShmChannel::kFREE), CLIENT_POLL_MS)) {
+        if (!header->serverAlive.load()) {
+            TRTLog(ERROR) << "Server quit while waiting for a free slot";
+            return false;
+        }
+    }
+    return true;
+}
+
+void* InferenceClient::getTensor(uint64_t ticket, const std::string &model, const std::string &blob) const
+{
+    const ShmTensor *tensor = channel.findTensor(channel.findModel(model), blob);
+    if (!tensor)
+        return nullptr;
+    return channel.getPayload(ticket) + tensor->offset;
+}
+
+size_t InferenceClient::getTensorBytes(const std::string &model, const std::string &blob, int batchSize) const
+{
+    const ShmTensor *tensor = channel.findTensor(channel.findModel(model), blob);
+    return tensor ? tensor->bytes * batchSize : 0;
+}
+
+int InferenceClient::getMaxBatchSize(const std::string &model) const
+{
+    int index = channel.findModel(model);
+    return index < 0 ? 0 : (int)channel.getHeader()->models[index].maxBatchSize;
+}
+
+bool InferenceClient::run(uint64_t ticket, const std::string &model, int batchSize)
+{
+    ShmHeader *header = channel.getHeader();
+    ShmSlot *slot = channel.getSlot(ticket);
+
+    int index = channel.findModel(model);
+    if (index < 0) {
+        TRTLog(ERROR) << "Server does not serve model " << model;
+    } else if (batchSize <= 0 || batchSize > (int)header->models[index].maxBatchSize) {
+        TRTLog(ERROR) << "Batch size " << batchSize << " of model " << model << " is out of [1, "
+                      << header->models[index].maxBatchSize << "]";
+        index = -1;
+    }
+
+    // Still submit an invalid request, which the server fails, so that the ticket does not stall the ring
+    slot->model = index < 0 ? SHM_MAX_MODELS : index;
+    slot->batchSize = batchSize;
+    slot->status = 0;
+    ShmChannel::setTurn(slot->turn, channel.turnOf(ticket, ShmChannel::kSUBMITTED));
+
+    while (!ShmChannel::waitTurn(slot->turn, channel.turnOf(ticket, ShmChannel::kDONE), CLIENT_POLL_MS)) {
+        if (!header->serverAlive.load()) {
+            TRTLog(ERROR) << "Server quit before serving the request";
+            return false;
+        }
+    }
+    return slot->status == 1;
+}
+
+void InferenceClient::release(uint64_t ticket)
+{
+    // Hand the slot over to the ticket of the next lap
+    ShmChannel::setTurn(channel.getSlot(ticket)->turn, channel.turnOf(ticket + channel.getHeader()->numSlots, ShmChannel::kFREE));
+}
+
+bool InferenceClient::infer(const std::string &model, int batchSize,
+                            const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    // Validate everything before the slot is touched or a ticket is taken
+    int index = channel.findModel(model);
+    if (index < 0) {
+        TRTLog(ERROR) << "Server does not serve model " << model;
+        return false;
+    }
+    if (batchSize <= 0 || batchSize > (int)channel.getHeader()->models[index].maxBatchSize) {
+        TRTLog(ERROR) << "Batch size " << batchSize << " of model " << model << " is out of [1, "
+                      << channel.getHeader()->models[index].maxBatchSize << "]";
+        return false;
+    }
+
+    std::vector<const ShmTensor*> tensors;
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        const ShmTensor *tensor = channel.findTensor(index, kv.first);
+        if (!tensor) {
+            TRTLog(ERROR) << "Model " << model << " has no blob " << kv.first;
+            return false;
+        }
+        tensors.push_back(tensor);
+    }
+
+    uint64_t ticket;
+    if (!acquire(ticket))
+        return false;
+
+    char *payload = channel.getPayload(ticket);
+    for (size_t i = 0; i < feedDict.size(); ++i)
+        if (!tensors.at(i)->isOutput)
+            std::memcpy(payload + tensors.at(i)->offset, feedDict.at(i).second, tensors.at(i)->bytes * batchSize);
+
+    bool success = run(ticket, model, batchSize);
+    if (success) {
+        for (size_t i = 0; i < feedDict.size(); ++i)
+            if (tensors.at(i)->isOutput)
+                std::memcpy(feedDict.at(i).second, payload + tensors.at(i)->offset, tensors.at(i)->bytes * batchSize);
+    }
+
+    release(ticket);
+    return success;
+}
+
+} // namespace trt
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "ShmChannel.hpp"
+
+namespace trt {
+
+/**
+ * @brief Client of an InferenceServer running in another process.
+ *
+ *        Inputs are written directly into the shared slot and outputs are
+ *        read from it, so a request costs no copy besides the ones the
+ *        caller makes itself:
+ *
+ *        trt::InferenceClient client;
+ *        client.connect("trt_server");
+ *
+ *        uint64_t ticket;
+ *        if (client.acquire(ticket)) {
+ *            float *data = (float*)client.getTensor(ticket, "caffenet", "data");
+ *            transformer.preprocess(data, img);
+ *            if (client.run(ticket, "caffenet", 1)) {
+ *                const float *prob = (float*)client.getTensor(ticket, "caffenet", "prob");
+ *                ...
+ *            }
+ *            client.release(ticket);
+ *        }
+ *
+ *        Tickets are served in the order they are acquired, so run() and
+ *        release() should follow acquire() promptly. The client only links
+ *        against the C++ and POSIX runtime, not Cuda nor TensorRT.
+ */
+class InferenceClient
+{
+public:
+    bool connect(const std::string &name);
+    void disconnect();
+
+    /**
+     * @brief Take the next ticket and wait until its slot is free.
+     * @return success  False if the server is not running or quits while
+     *                  waiting. The ticket must not be used then.
+     */
+    bool acquire(uint64_t &ticket);
+
+    /**
+     * @return ptr  Tensor of the model in the slot of the ticket, or
+     *              nullptr if the model or blob is unknown to the server.
+     */
+    void* getTensor(uint64_t ticket, const std::string &model, const std::string &blob) const;
+    size_t getTensorBytes(const std::string &model, const std::string &blob, int batchSize) const;
+
+    /**
+     * @return maxBatchSize  Of the model, 0 if unknown to the server.
+     */
+    int getMaxBatchSize(const std::string &model) const;
+
+    /**
+     * @brief Submit the inputs in the slot and wait for the outputs. An
+     *        unknown model or a batch size out of [1, maxBatchSize] fails
+     *        without reaching the executor.
+     * @return success  False if the inference failed or the server quit.
+     */
+    bool run(uint64_t ticket, const std::string &model, int batchSize);
+
+    /**
+     * @brief Give the slot back to the ring.
+     */
+    void release(uint64_t ticket);
+
+    /**
+     * @brief Copying convenience with the signature of TRTNetwork::forward.
+     *        The inputs of the feed dict, of batchSize samples, are copied
+     *        into the slot before the inference and the outputs out of it
+     *        after. Invalid arguments fail before any ticket is taken.
+     */
+    bool infer(const std::string &model, int batchSize,
+               const std::vector< std::pair<std::string, void*> > &feedDict);
+
+protected:
+    ShmChannel channel;
+};
+
+} // namespace trt
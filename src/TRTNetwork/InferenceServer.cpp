@@ -0,0 +1,146 @@
+#include "InferenceServer.hpp"
+
+#include "TRTNetwork.hpp"
+#include "Logger.hpp"
+
+namespace trt {
+
+/** @note Period at which the serving thread checks for stop(). */
+static const int SERVE_POLL_MS = 100;
+
+InferenceServer::InferenceServer(const std::string &name, Executor &executor, int numSlots,
+                                 std::shared_ptr<HostAllocator> allocator)
+    : name(name),
+      executor(executor),
+      numSlots(numSlots),
+      pool(allocator),
+      running(false),
+      numServed(0),
+      numFailed(0)
+{
+}
+
+InferenceServer::~InferenceServer()
+{
+    stop();
+    if (!channel.isOpen())
+        return;
+
+    // Let the clients waiting for a result give up
+    channel.getHeader()->serverAlive.store(0);
+    for (int i = 0; i < numSlots; ++i)
+        ShmChannel::setTurn(channel.getSlot(i)->turn, channel.getSlot(i)->turn.load());
+
+    pool.unregisterMemory(channel.getBase());
+    channel.close();
+}
+
+void InferenceServer::addModel(const std::string &model, int maxBatchSize,
+                               const std::vector< std::pair<std::string, size_t> > &inputs,
+                               const std::vector< std::pair<std::string, size_t> > &outputs)
+{
+    ShmChannel::ModelSpec spec;
+    spec.name = model;
+    spec.maxBatchSize = maxBatchSize;
+    spec.inputs = inputs;
+    spec.outputs = outputs;
+    models.push_back(spec);
+}
+
+void InferenceServer::addNetwork(const TRTNetwork &network)
+{
+    auto tensorsOf = [&network](const std::vector<std::string> &blobs) {
+        std::vector< std::pair<std::string, size_t> > tensors;
+        for (const std::string &blob : blobs) {
+            size_t vol = 1;
+            for (int d : network.getBlobShape(blob))
+                vol *= d;
+            tensors.push_back(std::make_pair(blob, vol * sizeof(float)));
+        }
+        return tensors;
+    };
+    addModel(network.getName(), network.getMaxBatchSize(),
+             tensorsOf(network.getInputBlobNames()), tensorsOf(network.getOutputBlobNames()));
+}
+
+bool InferenceServer::open()
+{
+    if (!channel.create(name, models, numSlots))
+        return false;
+
+    if (!pool.registerMemory(channel.getBase(), channel.getMappedBytes())) {
+        TRTLog(WARN) << "Shared ring " << name << " is not page-locked, transfers will be staged";
+    }
+
+    TRTLog(INFO) << "Serving " << models.size() << " models on " << name << " with "
+                 << numSlots << " slots of " << channel.getHeader()->slotBytes << " bytes";
+    return true;
+}
+
+bool InferenceServer::serveOne(int timeoutMs)
+{
+    if (!channel.isOpen())
+        return false;
+
+    ShmSlot *slot = channel.getSlot(tail);
+    if (!ShmChannel::waitTurn(slot->turn, channel.turnOf(tail, ShmChannel::kSUBMITTED), timeoutMs))
+        return false;
+
+    bool success = false;
+    const ShmHeader *header = channel.getHeader();
+    if (slot->model < header->numModels && slot->batchSize > 0 &&
+        slot->batchSize <= (int)header->models[slot->model].maxBatchSize) {
+        const ShmModel &model = header->models[slot->model];
+        char *payload = channel.getPayload(tail);
+
+        std::vector< std::pair<std::string, void*> > feedDict;
+        for (uint32_t t = 0; t < model.numTensors; ++t)
+            feedDict.push_back(std::make_pair(std::string(model.tensors[t].name), payload + model.tensors[t].offset));
+
+        success = executor.execute(model.name, slot->batchSize, feedDict);
+    } else {
+        TRTLog(ERROR) << "Invalid request for model index " << slot->model << " with batch size " << slot->batchSize;
+    }
+
+    slot->status = success ? 1 : 0;
+    ShmChannel::setTurn(slot->turn, channel.turnOf(tail, ShmChannel::kDONE));
+    ++tail;
+
+    ++numServed;
+    if (!success)
+        ++numFailed;
+    return true;
+}
+
+void InferenceServer::serveLoop()
+{
+    while (running)
+        serveOne(SERVE_POLL_MS);
+}
+
+void InferenceServer::start()
+{
+    if (running || !channel.isOpen())
+        return;
+    running = true;
+    worker = std::thread(&InferenceServer::serveLoop, this);
+}
+
+void InferenceServer::stop()
+{
+    running = false;
+    if (worker.joinable())
+        worker.join();
+}
+
+size_t InferenceServer::getNumServed() const
+{
+    return numServed;
+}
+
+size_t InferenceServer::getNumFailed() const
+{
+    return numFailed;
+}
+
+} // namespace trt
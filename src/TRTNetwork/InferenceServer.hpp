@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+#include "Executor.hpp"
+#include "ShmChannel.hpp"
+#include "HostTensorPool.hpp"
+
+namespace trt {
+
+/**
+ * @brief Process which owns the networks and serves the inferences of
+ *        client processes through a shared memory ring (ShmChannel).
+ *
+ *        Instead of every worker process building its own TRTNetwork, with
+ *        its own engine and device memory, the workers connect to one
+ *        server with an InferenceClient:
+ *
+ *        trt::NetworkExecutor executor;
+ *        executor.addNetwork(caffenet);
+ *
+ *        trt::InferenceServer server("trt_server", executor);
+ *        server.addNetwork(caffenet);
+ *        server.open();
+ *        server.start();
+ *
+ *        The ring is page-locked through a HostTensorPool, so forward()
+ *        transfers the tensors written by the clients straight from the
+ *        slots by DMA.
+ *
+ *        Requests are served in ticket order, so a client which dies
+ *        between InferenceClient::acquire() and run() stalls the ring.
+ */
+class InferenceServer
+{
+public:
+    /**
+     * @param name          Name of the shared memory segment.
+     * @param numSlots      Max number of requests in flight.
+     * @param allocator     Page-locks the ring. A stand-in allows to run
+     *                      the server without a GPU, e.g. with a fake
+     *                      executor.
+     */
+    InferenceServer(const std::string &name, Executor &executor, int numSlots = 16,
+                    std::shared_ptr<HostAllocator> allocator = std::make_shared<PinnedHostAllocator>());
+
+    InferenceServer(const InferenceServer& other) = delete;
+    InferenceServer& operator= (const InferenceServer& other) = delete;
+
+    ~InferenceServer();
+
+    /**
+     * @brief Declare a model and its input and output tensors (name, bytes
+     *        per sample). Models must be added before open().
+     */
+    void addModel(const std::string &model, int maxBatchSize,
+                  const std::vector< std::pair<std::string, size_t> > &inputs,
+                  const std::vector< std::pair<std::string, size_t> > &outputs);
+
+    /**
+     * @brief Declare a network with all its input and output blobs.
+     */
+    void addNetwork(const TRTNetwork &network);
+
+    /**
+     * @brief Create the shared memory segment for the added models.
+     */
+    bool open();
+
+    /**
+     * @brief Serve the next ticket on the calling thread.
+     * @param timeoutMs     Max time to wait for it, negative to wait forever.
+     * @return served       False if no request was submitted in time.
+     */
+    bool serveOne(int timeoutMs);
+
+    /**
+     * @brief Serve on a background thread until stop() is called.
+     */
+    void start();
+    void stop();
+
+    size_t getNumServed() const;
+    size_t getNumFailed() const;
+
+protected:
+    void serveLoop();
+
+    std::string name;
+    Executor &executor;
+    int numSlots;
+    HostTensorPool pool;
+
+    std::vector<ShmChannel::ModelSpec> models;
+    ShmChannel channel;
+    uint64_t tail = 0; // Next ticket to serve
+
+    std::atomic<bool> running;
+    std::thread worker;
+    std::atomic<size_t> numServed;
+    std::atomic<size_t> numFailed;
+};
+
+} // namespace trt
@@ -0,0 +1,44 @@
+#include "Latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace trt {
+
+LatencyStats summarizeLatencies(std::vector<double> latenciesMs)
+{
+    LatencyStats stats;
+    if (latenciesMs.empty())
+        return stats;
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    auto percentile = [&latenciesMs](double p) {
+        size_t idx = (size_t)std::ceil(p * latenciesMs.size()) - 1;
+        return latenciesMs.at(std::min(idx, latenciesMs.size() - 1));
+    };
+
+    double sum = 0.0;
+    for (double v : latenciesMs)
+        sum += v;
+
+    stats.count = latenciesMs.size();
+    stats.mean = sum / latenciesMs.size();
+    stats.p50 = percentile(0.50);
+    stats.p90 = percentile(0.90);
+    stats.p99 = percentile(0.99);
+    stats.max = latenciesMs.back();
+    return stats;
+}
+
+std::ostream& operator<< (std::ostream &os, const LatencyStats &stats)
+{
+    os << "n " << stats.count
+       << " mean " << stats.mean << " ms"
+       << " p50 " << stats.p50 << " ms"
+       << " p90 " << stats.p90 << " ms"
+       << " p99 " << stats.p99 << " ms"
+       << " max " << stats.max << " ms";
+    return os;
+}
+
+} // namespace trt
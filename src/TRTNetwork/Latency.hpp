@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * This file implements the latency statistics shared by the regression
+ * harness, the Scheduler and the traffic replayer.
+ */
+
+#include <vector>
+#include <iostream>
+#include <cstddef>
+
+namespace trt {
+
+/**
+ * @brief Summary of a list of latencies in milliseconds.
+ */
+struct LatencyStats
+{
+    size_t count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+LatencyStats summarizeLatencies(std::vector<double> latenciesMs);
+
+std::ostream& operator<< (std::ostream &os, const LatencyStats &stats);
+
+} // namespace trt
@@ -0,0 +1,74 @@
+#include "Normalization.hpp"
+
+#include <algorithm>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+bool InputNormalization::validate(int numChannels) const
+{
+    if (numChannels <= 0) {
+        TRTLog(ERROR) << "Input normalization needs an input with channels";
+        return false;
+    }
+    if (!mean.empty() && (int)mean.size() != numChannels) {
+        TRTLog(ERROR) << "Input normalization has " << mean.size() << " means for " << numChannels << " channels";
+        return false;
+    }
+    if (!channelOrder.empty()) {
+        std::vector<int> sorted(channelOrder);
+        std::sort(sorted.begin(), sorted.end());
+        bool permutation = (int)sorted.size() == numChannels;
+        for (int c = 0; permutation && c < numChannels; ++c)
+            permutation = sorted.at(c) == c;
+        if (!permutation) {
+            TRTLog(ERROR) << "Input normalization channel order is not a permutation of " << numChannels << " channels";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InputNormalization::swapsChannels() const
+{
+    for (int c = 0; c < (int)channelOrder.size(); ++c)
+        if (channelOrder.at(c) != c)
+            return true;
+    return false;
+}
+
+void normalizationWeights(const InputNormalization &normalization, int numChannels, std::vector<float> &weights)
+{
+    const int C = numChannels;
+    auto meanOf = [&](int c) { return normalization.mean.empty() ? 0.f : normalization.mean.at(c); };
+
+    if (normalization.swapsChannels()) {
+        // 1x1 convolution whose kernel is the permutation matrix times the scale
+        weights.assign(C * C + C, 0.f);
+        for (int c = 0; c < C; ++c) {
+            weights.at(c * C + normalization.channelOrder.at(c)) = normalization.scale;
+            weights.at(C * C + c) = -normalization.scale * meanOf(c);
+        }
+    } else {
+        weights.assign(2 * C, 0.f);
+        for (int c = 0; c < C; ++c) {
+            weights.at(c) = -normalization.scale * meanOf(c);
+            weights.at(C + c) = normalization.scale;
+        }
+    }
+}
+
+void normalizeReference(const uint8_t *hwc, int height, int width, int numChannels,
+                        const InputNormalization &normalization, float *chw)
+{
+    const int area = height * width;
+    for (int c = 0; c < numChannels; ++c) {
+        const int src = normalization.channelOrder.empty() ? c : normalization.channelOrder.at(c);
+        const float mean = normalization.mean.empty() ? 0.f : normalization.mean.at(c);
+        for (int p = 0; p < area; ++p)
+            chw[c * area + p] = normalization.scale * (hwc[p * numChannels + src] - mean);
+    }
+}
+
+} // namespace trt
@@ -0,0 +1,41 @@
+#include "Normalization.hpp"
+
+#include "Logger.hpp"
+
+namespace trt {
+
+/**
+ * @brief One thread per pixel, which reads its interleaved channels and
+ *        writes them to their planes.
+ */
+__global__ void castToPlanarKernel(const uint8_t *hwc, float *chw, int numChannels, int area, int total)
+{
+    int index = blockIdx.x * blockDim.x + threadIdx.x;
+    if (index >= total)
+        return;
+
+    const int n = index / area, p = index % area;
+    const uint8_t *src = hwc + (size_t)index * numChannels;
+    float *dst = chw + (size_t)n * numChannels * area + p;
+    for (int c = 0; c < numChannels; ++c)
+        dst[c * area] = src[c];
+}
+
+bool castToPlanar(const uint8_t *hwc, float *chw, int batchSize, int numChannels,
+                  int height, int width, cudaStream_t stream)
+{
+    const int area = height * width;
+    const int total = batchSize * area;
+    const int threads = 256;
+
+    castToPlanarKernel<<<(total + threads - 1) / threads, threads, 0, stream>>>(hwc, chw, numChannels, area, total);
+
+    cudaError_t err = cudaGetLastError();
+    if (err != cudaSuccess) {
+        TRTLog(ERROR) << "Unable to convert the input to planar floats: " << cudaGetErrorString(err);
+        return false;
+    }
+    return true;
+}
+
+} // namespace trt
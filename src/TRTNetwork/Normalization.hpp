@@ -0,0 +1,146 @@
+#pragma once
+
+/**
+ * This file implements the folding of the input normalization into the
+ * engine. A per-channel scale and shift, with an optional channel swap, is
+ * prepended to the parsed network, so the host uploads raw 8-bit images
+ * instead of normalized floats: a quarter of the transfer volume and no
+ * float conversion on the CPU.
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "cuda_runtime.h"
+#include "TensorRT/NvInfer.h"
+
+#include "Logger.hpp"
+
+namespace trt {
+
+/**
+ * @brief Normalization of the first input of a network, computed by the
+ *        engine on the raw pixel values:
+ *
+ *        out[c] = scale * (in[channelOrder[c]] - mean[c])
+ *
+ *        The parameters follow the Transformer: the mean is given in the
+ *        channel order of the network, e.g. BGR for the Caffe reference
+ *        models, and channelOrder maps each network channel to a channel
+ *        of the raw image, e.g. {2, 1, 0} for RGB images on a BGR network.
+ */
+struct InputNormalization
+{
+    std::vector<float> mean;        // Per network channel, empty for no shift
+    float scale = 1.f;
+    std::vector<int> channelOrder;  // Empty for the identity
+
+    /**
+     * @brief Check the parameters against the channels of the input.
+     */
+    bool validate(int numChannels) const;
+
+    bool swapsChannels() const;
+};
+
+/**
+ * @brief Weights of the layer added by prependNormalization: the C x C
+ *        kernel then the C biases of a 1x1 convolution when the channels
+ *        are swapped, else the C shifts then the C scales of a scale layer.
+ */
+void normalizationWeights(const InputNormalization &normalization, int numChannels, std::vector<float> &weights);
+
+/**
+ * @brief Rewrite a parsed network to normalize one of its inputs. A scale
+ *        layer is added on the input, or a 1x1 convolution when the
+ *        channels are swapped, and every layer which consumed the input
+ *        is rewired to the normalized tensor. The input keeps its name,
+ *        dims and bindings.
+ *
+ *        Templated on the network so that the rewrite can be tested on a
+ *        mock of nvinfer1::INetworkDefinition.
+ *
+ * @param weights   Storage of the weights of the new layer, which must be
+ *                  kept until the engine is built.
+ * @param inputName Name of the input to normalize, the first input if empty.
+ * @return success  False if the input is missing or the parameters do not
+ *                  fit it. The network is left untouched in that case.
+ */
+template <typename Network>
+bool prependNormalization(Network &network, const InputNormalization &normalization,
+                          std::vector<float> &weights, const std::string &inputName = std::string())
+{
+    typedef decltype(network.getInput(0)) tensor_t;
+    typedef decltype(network.getLayer(0)) layer_t;
+
+    tensor_t input = nullptr;
+    for (int i = 0; i < network.getNbInputs() && !input; ++i)
+        if (inputName.empty() || inputName == network.getInput(i)->getName())
+            input = network.getInput(i);
+    if (!input) {
+        if (inputName.empty())
+            TRTLog(ERROR) << "Input normalization needs a network with an input";
+        else
+            TRTLog(ERROR) << "Input normalization cannot find the input " << inputName << " in the network";
+        return false;
+    }
+
+    const nvinfer1::Dims dims = input->getDimensions();
+    const int C = dims.nbDims > 0 ? dims.d[0] : 0;
+    if (!normalization.validate(C))
+        return false;
+
+    // Find the consumers before the new layer becomes one of them
+    std::vector< std::pair<layer_t, int> > consumers;
+    for (int l = 0; l < network.getNbLayers(); ++l) {
+        layer_t layer = network.getLayer(l);
+        for (int i = 0; i < layer->getNbInputs(); ++i)
+            if (layer->getInput(i) == input)
+                consumers.push_back(std::make_pair(layer, i));
+    }
+
+    normalizationWeights(normalization, C, weights);
+
+    layer_t layer = nullptr;
+    if (normalization.swapsChannels()) {
+        nvinfer1::Weights kernel{nvinfer1::DataType::kFLOAT, weights.data(), C * C};
+        nvinfer1::Weights bias{nvinfer1::DataType::kFLOAT, weights.data() + C * C, C};
+        layer = network.addConvolution(*input, C, nvinfer1::DimsHW(1, 1), kernel, bias);
+    } else {
+        // y = (x * scale + shift) ^ power, with power 1 when left empty
+        nvinfer1::Weights shift{nvinfer1::DataType::kFLOAT, weights.data(), C};
+        nvinfer1::Weights scale{nvinfer1::DataType::kFLOAT, weights.data() + C, C};
+        nvinfer1::Weights power{nvinfer1::DataType::kFLOAT, nullptr, 0};
+        layer = network.addScale(*input, nvinfer1::ScaleMode::kCHANNEL, shift, scale, power);
+    }
+
+    if (!layer) {
+        TRTLog(ERROR) << "Unable to add the input normalization layer";
+        return false;
+    }
+    layer->setName("input_normalization");
+
+    for (const std::pair<layer_t, int> &consumer : consumers)
+        consumer.first->setInput(consumer.second, *layer->getOutput(0));
+    return true;
+}
+
+/**
+ * @brief CPU reference of the normalized input an engine built with
+ *        normalization computes from a raw image.
+ * @param hwc   Raw image of height x width x numChannels, e.g. the data
+ *              of a continuous cv::Mat.
+ * @param chw   Output of numChannels x height x width floats.
+ */
+void normalizeReference(const uint8_t *hwc, int height, int width, int numChannels,
+                        const InputNormalization &normalization, float *chw);
+
+/**
+ * @brief Convert a batch of raw HWC images on the device to planar floats,
+ *        without any normalization, which is left to the engine.
+ */
+bool castToPlanar(const uint8_t *hwc, float *chw, int batchSize, int numChannels,
+                  int height, int width, cudaStream_t stream);
+
+} // namespace trt
@@ -0,0 +1,114 @@
+#include "Oversample.hpp"
+
+#include <algorithm>
+
+#include "TRTNetwork.hpp"
+#include "Logger.hpp"
+
+namespace trt {
+
+static int volumeOf(const std::vector<int> &shape)
+{
+    int vol = 1;
+    for (int d : shape)
+        vol *= d;
+    return vol;
+}
+
+void reduceCrops(const float *outputs, int numCrops, int size, CropReduction reduction, float *result)
+{
+    std::copy(outputs, outputs + size, result);
+
+    // Accumulate crop by crop so that the inner loop is contiguous
+    for (int n = 1; n < numCrops; ++n) {
+        const float *crop = outputs + n * size;
+        if (reduction == CropReduction::kMAX)
+            for (int i = 0; i < size; ++i)
+                result[i] = std::max(result[i], crop[i]);
+        else
+            for (int i = 0; i < size; ++i)
+                result[i] += crop[i];
+    }
+
+    if (reduction == CropReduction::kMEAN) {
+        const float scale = 1.f / numCrops;
+        for (int i = 0; i < size; ++i)
+            result[i] *= scale;
+    }
+}
+
+Oversampler::Oversampler(TRTNetwork &network, Transformer &transformer,
+                         const std::string &inputBlob, const std::string &outputBlob,
+                         const cv::Size &resizeDims, CropReduction reduction,
+                         std::shared_ptr<HostAllocator> allocator)
+    : network(network),
+      transformer(transformer),
+      inputBlob(inputBlob),
+      outputBlob(outputBlob),
+      resizeDims(resizeDims),
+      reduction(reduction),
+      pool(allocator)
+{
+    inputSize = volumeOf(network.getBlobShape(inputBlob));
+    outputSize = volumeOf(network.getBlobShape(outputBlob));
+    input = pool.acquire(network, inputBlob);
+    output = pool.acquire(network, outputBlob);
+}
+
+Oversampler::~Oversampler()
+{
+    // The pool frees the buffers on destruction only once they are released
+    if (input)
+        pool.release(input);
+    if (output)
+        pool.release(output);
+}
+
+int Oversampler::getImagesPerBatch() const
+{
+    return network.getMaxBatchSize() / OVERSAMPLE_CROPS;
+}
+
+bool Oversampler::forward(const std::vector<cv::Mat> &images, std::vector< std::vector<float> > &scores)
+{
+    const int imagesPerBatch = getImagesPerBatch();
+    if (imagesPerBatch == 0 || !input || !output || inputSize == 0 || outputSize == 0) {
+        TRTLog(ERROR) << "Oversampling needs a max batch size of at least " << OVERSAMPLE_CROPS
+                      << " and the blobs " << inputBlob << " and " << outputBlob << " in network "
+                      << network.getName();
+        return false;
+    }
+    if (transformer.get_sample_size() != inputSize) {
+        TRTLog(ERROR) << "Transformer writes " << transformer.get_sample_size() << " floats per sample but blob "
+                      << inputBlob << " has " << inputSize;
+        return false;
+    }
+
+    scores.resize(images.size());
+
+    for (size_t first = 0; first < images.size(); first += imagesPerBatch) {
+        const int numImages = std::min<size_t>(imagesPerBatch, images.size() - first);
+
+        for (int n = 0; n < numImages; ++n) {
+            if (!transformer.preprocessOversample(input + n * OVERSAMPLE_CROPS * inputSize,
+                                                  images.at(first + n), resizeDims)) {
+                TRTLog(ERROR) << "Unable to oversample image " << first + n;
+                return false;
+            }
+        }
+
+        if (!network.forward(numImages * OVERSAMPLE_CROPS, {{inputBlob, input}, {outputBlob, output}}))
+            return false;
+
+        for (int n = 0; n < numImages; ++n) {
+            std::vector<float> &result = scores.at(first + n);
+            result.resize(outputSize);
+            reduceCrops(output + n * OVERSAMPLE_CROPS * outputSize, OVERSAMPLE_CROPS, outputSize,
+                        reduction, result.data());
+        }
+    }
+
+    return true;
+}
+
+} // namespace trt
@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * This file implements test-time augmentation by oversampling: the
+ * predictions of a classifier are averaged over the 10 crops written by
+ * Transformer::preprocessOversample, all of which go through the network
+ * in a single forward pass.
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "opencv2/opencv.hpp"
+
+#include "Transformer.hpp"
+#include "HostTensorPool.hpp"
+
+namespace trt {
+
+class TRTNetwork;
+
+enum class CropReduction
+{
+    kMEAN,
+    kMAX
+};
+
+/**
+ * @brief Reduce the outputs of numCrops consecutive batch slots of size
+ *        floats each into one output.
+ */
+void reduceCrops(const float* outputs, int numCrops, int size, CropReduction reduction, float* result);
+
+/**
+ * @brief Oversampled classification of images.
+ *
+ *        trt::Oversampler oversampler(caffenet, transformer, "data", "prob");
+ *        std::vector< std::vector<float> > scores;
+ *        oversampler.forward(images, scores);
+ *
+ *        Each image takes OVERSAMPLE_CROPS batch slots, so the max batch
+ *        size of the network must be at least that; several images are
+ *        packed into one forward when it is larger. The buffers are
+ *        page-locked and kept between calls.
+ */
+class Oversampler
+{
+public:
+    /**
+     * @param resizeDims    Size the images are resized to before cropping,
+     *                      256 x 256 for the Caffe reference models.
+     * @param allocator     Allocator of the buffers, page-locked by default.
+     */
+    Oversampler(TRTNetwork &network, Transformer &transformer,
+                const std::string &inputBlob, const std::string &outputBlob,
+                const cv::Size &resizeDims = cv::Size(256, 256),
+                CropReduction reduction = CropReduction::kMEAN,
+                std::shared_ptr<HostAllocator> allocator = std::make_shared<PinnedHostAllocator>());
+
+    Oversampler(const Oversampler& other) = delete;
+    Oversampler& operator= (const Oversampler& other) = delete;
+
+    ~Oversampler();
+
+    /**
+     * @param scores    One reduced output per image.
+     * @return success  False if an image is empty or the inference fails.
+     */
+    bool forward(const std::vector<cv::Mat> &images, std::vector< std::vector<float> > &scores);
+
+    /**
+     * @brief Number of images packed into one forward.
+     */
+    int getImagesPerBatch() const;
+
+protected:
+    TRTNetwork &network;
+    Transformer &transformer;
+    const std::string inputBlob;
+    const std::string outputBlob;
+    const cv::Size resizeDims;
+    const CropReduction reduction;
+
+    HostTensorPool pool;
+    float *input = nullptr;
+    float *output = nullptr;
+    int inputSize = 0;      // Floats per crop
+    int outputSize = 0;
+};
+
+} // namespace trt
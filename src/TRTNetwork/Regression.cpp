@@ -0,0 +1,178 @@
+#include "Regression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+void Divergence::accumulate(const Divergence &other)
+{
+    size_t total = samples + other.samples;
+    if (total == 0)
+        return;
+
+    meanAbsError  = (meanAbsError * samples + other.meanAbsError * other.samples) / total;
+    top1Agreement = (top1Agreement * samples + other.top1Agreement * other.samples) / total;
+    top5Agreement = (top5Agreement * samples + other.top5Agreement * other.samples) / total;
+    maxAbsError   = std::max(maxAbsError, other.maxAbsError);
+    samples = total;
+}
+
+std::ostream& operator<< (std::ostream &os, const Divergence &divergence)
+{
+    os << "samples " << divergence.samples
+       << " max_abs_err " << divergence.maxAbsError
+       << " mean_abs_err " << divergence.meanAbsError
+       << " top1_agree " << divergence.top1Agreement
+       << " top5_agree " << divergence.top5Agreement;
+    return os;
+}
+
+Divergence compareOutputs(const float *test, const float *reference,
+                          int numSamples, int sizePerSample)
+{
+    Divergence d;
+    if (numSamples <= 0 || sizePerSample <= 0)
+        return d;
+
+    const int K = std::min(5, sizePerSample);
+    std::vector<int> order(sizePerSample);
+    double sumAbsError = 0.0;
+    int top1 = 0, top5 = 0;
+
+    for (int n = 0; n < numSamples; ++n) {
+        const float *t = test + (size_t)n * sizePerSample;
+        const float *r = reference + (size_t)n * sizePerSample;
+
+        for (int i = 0; i < sizePerSample; ++i) {
+            float err = std::fabs(t[i] - r[i]);
+            d.maxAbsError = std::max(d.maxAbsError, err);
+            sumAbsError += err;
+        }
+
+        int refTop = (int)(std::max_element(r, r + sizePerSample) - r);
+
+        for (int i = 0; i < sizePerSample; ++i)
+            order[i] = i;
+        std::partial_sort(order.begin(), order.begin() + K, order.end(),
+                          [t](int a, int b) { return t[a] > t[b]; });
+
+        top1 += order[0] == refTop;
+        top5 += std::find(order.begin(), order.begin() + K, refTop) != order.begin() + K;
+    }
+
+    d.samples = numSamples;
+    d.meanAbsError = sumAbsError / ((double)numSamples * sizePerSample);
+    d.top1Agreement = (double)top1 / numSamples;
+    d.top5Agreement = (double)top5 / numSamples;
+    return d;
+}
+
+static const char goldenMagic[8] = {'T', 'R', 'T', 'G', 'O', 'L', 'D', '1'};
+
+/** @note Sanity bound against reading garbage as a huge length. */
+static const uint32_t MAX_GOLDEN_FIELD = 1u << 30;
+
+static void writeInt(std::ofstream &file, int32_t value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static bool readInt(std::ifstream &file, int32_t &value)
+{
+    return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+bool writeGolden(const std::string &path, const GoldenSet &golden)
+{
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        TRTLog(ERROR) << "Unable to write golden file " << path;
+        return false;
+    }
+
+    file.write(goldenMagic, sizeof(goldenMagic));
+    writeInt(file, (int32_t)golden.size());
+    for (const std::pair<const std::string, BlobData> &kv : golden) {
+        writeInt(file, (int32_t)kv.first.size());
+        file.write(kv.first.data(), kv.first.size());
+        writeInt(file, (int32_t)kv.second.shape.size());
+        for (int dim : kv.second.shape)
+            writeInt(file, dim);
+        file.write(reinterpret_cast<const char*>(kv.second.data.data()),
+                   kv.second.data.size() * sizeof(float));
+    }
+    return (bool)file;
+}
+
+bool readGolden(const std::string &path, GoldenSet &golden)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        TRTLog(ERROR) << "Unable to open golden file " << path;
+        return false;
+    }
+
+    char magic[sizeof(goldenMagic)];
+    int32_t count = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, goldenMagic, sizeof(magic)) ||
+        !readInt(file, count)) {
+        TRTLog(ERROR) << "Malformed golden file " << path;
+        return false;
+    }
+
+    golden.clear();
+    for (int32_t i = 0; i < count; ++i) {
+        int32_t len = 0, nbDims = 0;
+        std::string name;
+        BlobData blob;
+
+        bool ok = readInt(file, len) && len >= 0 && (uint32_t)len <= MAX_GOLDEN_FIELD;
+        if (ok) {
+            name.resize(len);
+            ok = (bool)file.read(&name[0], len) && readInt(file, nbDims) && nbDims >= 0;
+        }
+        // Bound the bytes of the data before BlobData::count() can overflow
+        size_t bytes = sizeof(float);
+        for (int32_t d = 0; ok && d < nbDims; ++d) {
+            int32_t dim = 0;
+            ok = readInt(file, dim) && dim >= 0 && (dim == 0 || bytes <= MAX_GOLDEN_FIELD / dim);
+            bytes *= dim;
+            blob.shape.push_back(dim);
+        }
+        if (ok) {
+            blob.data.resize(blob.count());
+            ok = (bool)file.read(reinterpret_cast<char*>(blob.data.data()), blob.data.size() * sizeof(float));
+        }
+        if (!ok) {
+            TRTLog(ERROR) << "Malformed golden file " << path;
+            return false;
+        }
+        golden[name] = blob;
+    }
+    return true;
+}
+
+Divergence compareGolden(const GoldenSet &test, const GoldenSet &reference)
+{
+    Divergence total;
+    for (const std::pair<const std::string, BlobData> &kv : reference) {
+        GoldenSet::const_iterator it = test.find(kv.first);
+        if (it == test.end())
+            continue;
+        if (it->second.shape != kv.second.shape) {
+            TRTLog(WARN) << "Shape mismatch of golden entry " << kv.first << ", skipped";
+            continue;
+        }
+        total.accumulate(compareOutputs(it->second.data.data(), kv.second.data.data(),
+                                        1, (int)kv.second.data.size()));
+    }
+    return total;
+}
+
+} // namespace trt
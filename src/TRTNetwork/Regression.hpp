@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * This file implements the building blocks of the accuracy-vs-speed
+ * regression harness: output divergence metrics and the golden file
+ * format which stores reference outputs. The latency statistics are in
+ * Latency.hpp.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+
+#include "CaffeIO.hpp"
+#include "Latency.hpp"
+
+namespace trt {
+
+/**
+ * @brief Divergence of test outputs from reference outputs, e.g. TensorRT
+ *        against Caffe, or an FP16 engine against recorded FP32 results.
+ */
+struct Divergence
+{
+    size_t samples = 0;
+    float maxAbsError = 0.f;
+    double meanAbsError = 0.0;
+    double top1Agreement = 0.0; // Fraction of samples with the same argmax
+    double top5Agreement = 0.0; // Fraction of samples whose reference top-1 is in the test top-5
+
+    /**
+     * @brief Merge the metrics of another set of samples.
+     */
+    void accumulate(const Divergence &other);
+};
+
+std::ostream& operator<< (std::ostream &os, const Divergence &divergence);
+
+/**
+ * @brief Compare a batch of outputs laid out as [numSamples x sizePerSample].
+ */
+Divergence compareOutputs(const float *test, const float *reference,
+                          int numSamples, int sizePerSample);
+
+/**
+ * @brief Named tensors recorded as the golden results of a model,
+ *        one entry per input sample and output blob.
+ */
+typedef std::map<std::string, BlobData> GoldenSet;
+
+/**
+ * @brief Write and read golden tensors in a simple binary format:
+ *
+ *        "TRTGOLD1" | count | { name_len | name | nbDims | dims | floats }...
+ *
+ *        Integers are 32-bit little endian.
+ */
+bool writeGolden(const std::string &path, const GoldenSet &golden);
+bool readGolden(const std::string &path, GoldenSet &golden);
+
+/**
+ * @brief Compare the entries present in both sets. Entries are treated as
+ *        one sample each, so the shapes must be equal.
+ */
+Divergence compareGolden(const GoldenSet &test, const GoldenSet &reference);
+
+} // namespace trt
@@ -0,0 +1,173 @@
+#include "ResultCache.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace trt {
+
+/**
+ * @brief Size in bytes of a blob for the given batch size.
+ */
+static size_t blobBytes(const TRTNetwork &network, const std::string &name, int batchSize)
+{
+    std::vector<int> shape = network.getBlobShape(name);
+    size_t vol = 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return batchSize * vol * sizeof(float);
+}
+
+static bool isInput(const TRTNetwork &network, const std::string &name)
+{
+    const std::vector<std::string> &inputs = network.getInputBlobNames();
+    return std::find(inputs.begin(), inputs.end(), name) != inputs.end();
+}
+
+ResultCache::ResultCache(size_t capacityBytes)
+    : capacityBytes(capacityBytes),
+      hits(0), misses(0), evictions(0)
+{
+}
+
+Hash128 ResultCache::computeKey(const TRTNetwork &network, int batchSize,
+                                const std::vector< std::pair<std::string, void*> > &feedDict) const
+{
+    /* The identity covers the weights and the binding layout, so two
+     * networks only share keys if they compute the same outputs. */
+    Hash128 key = network.getIdentity();
+    key = hash128(&batchSize, sizeof(batchSize), key);
+
+    // The same binding in another order is the same inference
+    std::vector<const std::pair<std::string, void*>*> sorted;
+    for (const std::pair<std::string, void*> &kv : feedDict)
+        sorted.push_back(&kv);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<std::string, void*> *lhs, const std::pair<std::string, void*> *rhs) {
+                  return lhs->first < rhs->first;
+              });
+
+    for (const std::pair<std::string, void*> *kv : sorted) {
+        key = hash128(kv->first.data(), kv->first.size(), key);
+        if (isInput(network, kv->first))
+            key = hash128(kv->second, blobBytes(network, kv->first, batchSize), key);
+    }
+    return key;
+}
+
+bool ResultCache::forward(TRTNetwork &network, int batchSize,
+                          const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    Hash128 key = computeKey(network, batchSize, feedDict);
+
+    if (lookup(key, network, feedDict)) {
+        ++hits;
+        return true;
+    }
+    ++misses;
+
+    if (!network.forward(batchSize, feedDict))
+        return false;
+
+    insert(key, network, batchSize, feedDict);
+    return true;
+}
+
+bool ResultCache::lookup(const Hash128 &key, const TRTNetwork &network,
+                         const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+
+    auto it = index.find(key);
+    if (it == index.end())
+        return false;
+
+    const Entry &entry = *it->second;
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        if (isInput(network, kv.first))
+            continue;
+        for (const std::pair<std::string, std::vector<char> > &out : entry.outputs)
+            if (out.first == kv.first)
+                std::memcpy(kv.second, out.second.data(), out.second.size());
+    }
+
+    lru.splice(lru.begin(), lru, it->second);
+    return true;
+}
+
+void ResultCache::insert(const Hash128 &key, const TRTNetwork &network, int batchSize,
+                         const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    Entry entry;
+    entry.key = key;
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        if (isInput(network, kv.first))
+            continue;
+        size_t bytes = blobBytes(network, kv.first, batchSize);
+        const char *src = static_cast<const char*>(kv.second);
+        entry.outputs.emplace_back(kv.first, std::vector<char>(src, src + bytes));
+        entry.bytes += bytes;
+    }
+
+    // Results which never fit would only flush the whole cache
+    if (entry.bytes > capacityBytes)
+        return;
+
+    std::lock_guard<std::mutex> locker(mtx);
+
+    // Another thread may have inserted the same key in the meantime
+    if (index.count(key))
+        return;
+
+    while (sizeBytes + entry.bytes > capacityBytes && !lru.empty()) {
+        sizeBytes -= lru.back().bytes;
+        index.erase(lru.back().key);
+        lru.pop_back();
+        ++evictions;
+    }
+
+    sizeBytes += entry.bytes;
+    lru.push_front(std::move(entry));
+    index[key] = lru.begin();
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    lru.clear();
+    index.clear();
+    sizeBytes = 0;
+}
+
+size_t ResultCache::getHits() const
+{
+    return hits;
+}
+
+size_t ResultCache::getMisses() const
+{
+    return misses;
+}
+
+size_t ResultCache::getEvictions() const
+{
+    return evictions;
+}
+
+size_t ResultCache::getSizeBytes() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return sizeBytes;
+}
+
+size_t ResultCache::getCapacityBytes() const
+{
+    return capacityBytes;
+}
+
+size_t ResultCache::getNumEntries() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return lru.size();
+}
+
+} // namespace trt
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "TRTNetwork.hpp"
+#include "Hash.hpp"
+
+namespace trt {
+
+/**
+ * @brief Content-addressed LRU cache of inference results.
+ *
+ *        The cache sits in front of a TRTNetwork and short-circuits
+ *        forward() when exactly the same input tensors were seen before
+ *        on the same network. The key is the 128-bit hash of the network
+ *        identity (model files and binding layout, see
+ *        TRTNetwork::getIdentity), the batch size, the requested output
+ *        blobs and the raw bytes of every input blob, in blob name order
+ *        regardless of the order of the feedDict. The outputs
+ *        are kept on the host and evicted in least-recently-used order
+ *        once the total size exceeds the configured capacity.
+ *
+ *        A single cache can be shared by several networks and threads.
+ */
+class ResultCache
+{
+public:
+    /**
+     * @param capacityBytes  Upper bound of the memory spent on stored outputs.
+     */
+    explicit ResultCache(size_t capacityBytes);
+
+    ResultCache(const ResultCache& other) = delete;
+    ResultCache& operator= (const ResultCache& other) = delete;
+
+    /**
+     * @brief Cached version of TRTNetwork::forward. Takes the same feedDict.
+     *        On a hit the stored outputs are copied to the output pointers
+     *        and the network is not invoked at all.
+     *
+     * @return success   True if the outputs are valid, either from the cache
+     *                   or from a successful inference.
+     */
+    bool forward(TRTNetwork &network, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict);
+
+    /**
+     * @brief Compute the cache key of an inference without running it.
+     */
+    Hash128 computeKey(const TRTNetwork &network, int batchSize,
+                       const std::vector< std::pair<std::string, void*> > &feedDict) const;
+
+    void clear();
+
+    size_t getHits() const;
+    size_t getMisses() const;
+    size_t getEvictions() const;
+    size_t getSizeBytes() const;
+    size_t getCapacityBytes() const;
+    size_t getNumEntries() const;
+
+protected:
+    struct Entry
+    {
+        Hash128 key;
+        std::vector< std::pair<std::string, std::vector<char> > > outputs;
+        size_t bytes = 0;
+    };
+
+    typedef std::list<Entry>::iterator entry_it_t;
+
+    bool lookup(const Hash128 &key, const TRTNetwork &network,
+                const std::vector< std::pair<std::string, void*> > &feedDict);
+    void insert(const Hash128 &key, const TRTNetwork &network, int batchSize,
+                const std::vector< std::pair<std::string, void*> > &feedDict);
+
+    const size_t capacityBytes;
+    size_t sizeBytes = 0;
+
+    std::list<Entry> lru; // Front is the most recently used entry
+    std::unordered_map<Hash128, entry_it_t, Hash128Hasher> index;
+    mutable std::mutex mtx;
+
+    std::atomic<size_t> hits;
+    std::atomic<size_t> misses;
+    std::atomic<size_t> evictions;
+};
+
+} // namespace trt
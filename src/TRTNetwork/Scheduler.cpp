@@ -0,0 +1,432 @@
+#include "Scheduler.hpp"
+
+#include <algorithm>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+/** @note Number of recent samples kept for the latency percentiles. */
+static const size_t MAX_LATENCY_SAMPLES = 4096;
+
+/** @note Weight of a new measurement in the moving average of service times. */
+static const double SERVICE_TIME_ALPHA = 0.2;
+
+static double toMs(Duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+static void addSample(std::deque<double> &samples, double value)
+{
+    samples.push_back(value);
+    if (samples.size() > MAX_LATENCY_SAMPLES)
+        samples.pop_front();
+}
+
+const char* toString(AdmissionResult result)
+{
+    switch (result) {
+    case AdmissionResult::kACCEPTED: return "accepted";
+    case AdmissionResult::kREJECTED: return "rejected";
+    case AdmissionResult::kEXPIRED:  return "expired";
+    case AdmissionResult::kINVALID:  return "invalid";
+    }
+    return "unknown";
+}
+
+std::ostream& operator<< (std::ostream &os, const ClassMetrics &metrics)
+{
+    os << "submitted " << metrics.submitted
+       << " accepted " << metrics.accepted
+       << " shed " << metrics.shed
+       << " expired " << metrics.expired
+       << " completed " << metrics.completed
+       << " failed " << metrics.failed
+       << " deadline misses " << metrics.deadlineMisses
+       << " queue " << metrics.queueLength << "/" << metrics.maxQueueLength
+       << ", queue delay " << metrics.queueDelay
+       << ", latency " << metrics.latency;
+    return os;
+}
+
+TimePoint SteadyClock::now() const
+{
+    return std::chrono::steady_clock::now();
+}
+
+TimePoint ManualClock::now() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return current;
+}
+
+void ManualClock::advance(Duration d)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    current += d;
+}
+
+void ManualClock::set(TimePoint t)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    current = t;
+}
+
+Scheduler::Scheduler(Executor &executor, int numPriorityClasses,
+                     std::shared_ptr<SchedulerClock> clock)
+    : executor(executor),
+      clock(clock),
+      classes(std::max(1, numPriorityClasses))
+{
+}
+
+Scheduler::~Scheduler()
+{
+    stop();
+
+    // Nobody will dispatch the remaining requests, so fail them
+    std::vector<InferenceRequest> orphans;
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        for (PriorityClass &c : classes)
+            for (std::pair<const std::string, ModelQueue> &m : c.models)
+                for (std::pair<const order_t, Pending> &p : m.second.requests)
+                    orphans.push_back(std::move(p.second.request));
+    }
+    for (InferenceRequest &request : orphans)
+        if (request.done)
+            request.done(false);
+}
+
+void Scheduler::setModelWeight(const std::string &model, double weight)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    weights[model] = weight > 0.0 ? weight : 1.0;
+}
+
+void Scheduler::setUrgencyWindow(Duration window)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    urgencyWindow = window;
+}
+
+double Scheduler::weightOf(const std::string &model) const
+{
+    std::map<std::string, double>::const_iterator it = weights.find(model);
+    return it == weights.end() ? 1.0 : it->second;
+}
+
+void Scheduler::setQueueCapacity(int priority, size_t capacity)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (priority < 0 || priority >= (int)classes.size()) {
+        TRTLog(ERROR) << "Invalid priority class " << priority;
+        return;
+    }
+    classes.at(priority).capacity = capacity;
+    spaceCond.notify_all();
+}
+
+void Scheduler::setServiceTimeEstimate(const std::string &model, Duration estimate, int batchSize)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    serviceTimes[model] = estimate / std::max(1, batchSize);
+}
+
+Duration Scheduler::serviceTimeOf(const std::string &model, int batchSize) const
+{
+    std::map<std::string, Duration>::const_iterator it = serviceTimes.find(model);
+    return it == serviceTimes.end() ? Duration::zero() : it->second * std::max(1, batchSize);
+}
+
+AdmissionResult Scheduler::submit(InferenceRequest request)
+{
+    return admit(request, true);
+}
+
+AdmissionResult Scheduler::trySubmit(InferenceRequest request)
+{
+    return admit(request, false);
+}
+
+AdmissionResult Scheduler::admit(InferenceRequest &request, bool wait)
+{
+    if (request.priority < 0 || request.priority >= (int)classes.size()) {
+        TRTLog(ERROR) << "Invalid priority class " << request.priority;
+        return AdmissionResult::kINVALID;
+    }
+
+    std::vector<Pending> expired;
+    AdmissionResult result = AdmissionResult::kACCEPTED;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        PriorityClass &c = classes.at(request.priority);
+        ++c.metrics.submitted;
+
+        const Duration service = serviceTimeOf(request.model, request.batchSize);
+        while (true) {
+            if (wait && stopped) {
+                result = AdmissionResult::kREJECTED;
+                break;
+            }
+
+            TimePoint now = clock->now();
+            if (request.deadline != TimePoint::max() && now + service > request.deadline) {
+                result = AdmissionResult::kEXPIRED;
+                break;
+            }
+            if (c.capacity == 0 || c.size < c.capacity)
+                break;
+
+            // Make room by dropping what cannot make it anyway
+            dropExpired(c, now, expired);
+            if (c.size < c.capacity)
+                break;
+
+            if (!wait) {
+                result = AdmissionResult::kREJECTED;
+                break;
+            }
+
+            /* Wait for room, but no longer than the deadline still allows
+             * nor past stop(). The timeout is measured on the steady clock,
+             * so under a ManualClock it only bounds the wait while time is
+             * simulated. */
+            auto wakeUp = [&]() { return stopped || c.capacity == 0 || c.size < c.capacity; };
+            if (request.deadline == TimePoint::max())
+                spaceCond.wait(lock, wakeUp);
+            else
+                spaceCond.wait_for(lock, request.deadline - service - now, wakeUp);
+        }
+
+        if (result == AdmissionResult::kACCEPTED) {
+            ModelQueue &queue = c.models[request.model];
+
+            /* A model which was idle restarts from the current virtual time of
+             * its class, so it cannot save up credit while idle and then
+             * monopolize the executor. */
+            if (queue.requests.empty())
+                queue.virtualTime = std::max(queue.virtualTime, c.virtualTime);
+
+            Pending pending;
+            pending.submitTime = clock->now();
+            order_t order(request.deadline, sequence++);
+            pending.request = std::move(request);
+            queue.requests.insert(std::make_pair(order, std::move(pending)));
+
+            ++c.size;
+            ++c.metrics.accepted;
+            c.metrics.maxQueueLength = std::max(c.metrics.maxQueueLength, c.size);
+        } else {
+            ++c.metrics.shed;
+        }
+    }
+
+    if (result == AdmissionResult::kACCEPTED)
+        pendingCond.notify_one();
+    for (Pending &pending : expired)
+        if (pending.request.done)
+            pending.request.done(false);
+    return result;
+}
+
+void Scheduler::dropExpired(PriorityClass &c, TimePoint now, std::vector<Pending> &expired)
+{
+    size_t dropped = 0;
+    for (std::pair<const std::string, ModelQueue> &m : c.models) {
+        std::map<order_t, Pending> &requests = m.second.requests;
+
+        /* Ordered by deadline, so the heads expire first. A larger batch
+         * behind the head may expire earlier and is caught when it becomes
+         * the head, before it is dispatched. */
+        while (!requests.empty() && requests.begin()->first.first != TimePoint::max() &&
+               now + serviceTimeOf(m.first, requests.begin()->second.request.batchSize) >
+               requests.begin()->first.first) {
+            expired.push_back(std::move(requests.begin()->second));
+            requests.erase(requests.begin());
+            ++dropped;
+        }
+    }
+
+    c.size -= dropped;
+    c.metrics.expired += dropped;
+    if (dropped)
+        spaceCond.notify_all();
+}
+
+bool Scheduler::pick(Pending &next, std::vector<Pending> &expired)
+{
+    const TimePoint now = clock->now();
+    for (PriorityClass &c : classes) {
+        // Requests which would miss their deadline never reach the executor
+        dropExpired(c, now, expired);
+        if (c.size == 0)
+            continue;
+
+        typedef std::map<std::string, ModelQueue>::iterator model_it_t;
+        model_it_t chosen = c.models.end();
+
+        // Urgent requests first, earliest deadline first
+        if (urgencyWindow > Duration::zero()) {
+            TimePoint horizon = now + urgencyWindow;
+            for (model_it_t it = c.models.begin(); it != c.models.end(); ++it) {
+                if (it->second.requests.empty())
+                    continue;
+                TimePoint deadline = it->second.requests.begin()->first.first;
+                if (deadline <= horizon &&
+                    (chosen == c.models.end() || deadline < chosen->second.requests.begin()->first.first))
+                    chosen = it;
+            }
+        }
+
+        // Otherwise the least served model by weight
+        if (chosen == c.models.end()) {
+            for (model_it_t it = c.models.begin(); it != c.models.end(); ++it)
+                if (!it->second.requests.empty() &&
+                    (chosen == c.models.end() || it->second.virtualTime < chosen->second.virtualTime))
+                    chosen = it;
+        }
+
+        ModelQueue &queue = chosen->second;
+        next = std::move(queue.requests.begin()->second);
+        queue.requests.erase(queue.requests.begin());
+        --c.size;
+        spaceCond.notify_one();
+
+        c.virtualTime = queue.virtualTime;
+        queue.virtualTime += next.request.batchSize / weightOf(chosen->first);
+        return true;
+    }
+    return false;
+}
+
+void Scheduler::complete(const Pending &pending, TimePoint dispatchTime, bool success)
+{
+    TimePoint now = clock->now();
+
+    std::lock_guard<std::mutex> locker(mtx);
+    PriorityClass &c = classes.at(pending.request.priority);
+
+    /* Moving average of the service time per sample of the model, seeded
+     * by the first run, so that the expectation scales with the batch. */
+    const Duration service = (now - dispatchTime) / std::max(1, pending.request.batchSize);
+    std::map<std::string, Duration>::iterator it = serviceTimes.find(pending.request.model);
+    if (it == serviceTimes.end())
+        serviceTimes[pending.request.model] = service;
+    else
+        it->second = std::chrono::duration_cast<Duration>(
+            (1.0 - SERVICE_TIME_ALPHA) * it->second + SERVICE_TIME_ALPHA * service);
+
+    if (success)
+        ++c.metrics.completed;
+    else
+        ++c.metrics.failed;
+    if (now > pending.request.deadline)
+        ++c.metrics.deadlineMisses;
+
+    addSample(c.queueDelays, toMs(dispatchTime - pending.submitTime));
+    addSample(c.latencies, toMs(now - pending.submitTime));
+}
+
+bool Scheduler::dispatchOne()
+{
+    Pending pending;
+    std::vector<Pending> expired;
+    bool picked;
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        picked = pick(pending, expired);
+    }
+
+    for (Pending &p : expired)
+        if (p.request.done)
+            p.request.done(false);
+    if (!picked)
+        return !expired.empty();
+
+    TimePoint dispatchTime = clock->now();
+    const InferenceRequest &request = pending.request;
+    bool success = executor.execute(request.model, request.batchSize, request.feedDict);
+
+    complete(pending, dispatchTime, success);
+    if (request.done)
+        request.done(success);
+    return true;
+}
+
+void Scheduler::workerLoop()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            pendingCond.wait(lock, [this]() {
+                if (!running)
+                    return true;
+                for (const PriorityClass &c : classes)
+                    if (c.size)
+                        return true;
+                return false;
+            });
+            if (!running)
+                return;
+        }
+        dispatchOne();
+    }
+}
+
+void Scheduler::start(int numWorkers)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (running)
+        return;
+    running = true;
+    stopped = false;
+    for (int i = 0; i < numWorkers; ++i)
+        workers.emplace_back(&Scheduler::workerLoop, this);
+}
+
+void Scheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        running = false;
+        stopped = true;
+    }
+    pendingCond.notify_all();
+    spaceCond.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+size_t Scheduler::getNumPending() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    size_t total = 0;
+    for (const PriorityClass &c : classes)
+        total += c.size;
+    return total;
+}
+
+int Scheduler::getNumPriorityClasses() const
+{
+    return (int)classes.size();
+}
+
+ClassMetrics Scheduler::getMetrics(int priority) const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (priority < 0 || priority >= (int)classes.size())
+        return ClassMetrics();
+
+    const PriorityClass &c = classes.at(priority);
+    ClassMetrics metrics = c.metrics;
+    metrics.queueLength = c.size;
+    metrics.queueDelay = summarizeLatencies(std::vector<double>(c.queueDelays.begin(), c.queueDelays.end()));
+    metrics.latency = summarizeLatencies(std::vector<double>(c.latencies.begin(), c.latencies.end()));
+    return metrics;
+}
+
+} // namespace trt
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+#include "Executor.hpp"
+#include "Latency.hpp"
+
+namespace trt {
+
+typedef std::chrono::steady_clock::time_point TimePoint;
+typedef std::chrono::steady_clock::duration Duration;
+
+/**
+ * @brief Time source of the Scheduler. Replace it by a ManualClock to
+ *        simulate time in tests and simulations.
+ */
+class SchedulerClock
+{
+public:
+    virtual ~SchedulerClock() = default;
+    virtual TimePoint now() const = 0;
+};
+
+class SteadyClock : public SchedulerClock
+{
+public:
+    TimePoint now() const override;
+};
+
+/**
+ * @brief Clock which only moves when told to.
+ */
+class ManualClock : public SchedulerClock
+{
+public:
+    TimePoint now() const override;
+    void advance(Duration d);
+    void set(TimePoint t);
+
+protected:
+    mutable std::mutex mtx;
+    TimePoint current;
+};
+
+/**
+ * @brief One inference submitted to the Scheduler.
+ */
+struct InferenceRequest
+{
+    std::string model;  // Name of the network to run
+    int priority = 0;   // Priority class, 0 is the most important
+    int batchSize = 1;
+    std::vector< std::pair<std::string, void*> > feedDict;
+
+    /**
+     * @brief Time by which the result is needed. Requests without a
+     *        deadline are ordered after those with one in the same model.
+     */
+    TimePoint deadline = TimePoint::max();
+
+    /**
+     * @brief Called with the result, from the dispatching thread. Requests
+     *        which expire in the queue are completed with false as well.
+     */
+    std::function<void(bool success)> done;
+};
+
+/**
+ * @brief Outcome of submitting a request to the Scheduler.
+ */
+enum class AdmissionResult
+{
+    kACCEPTED, // Queued for dispatch
+    kREJECTED, // The queue of its class is full
+    kEXPIRED,  // The deadline cannot be met anymore, so it was shed
+    kINVALID   // Unknown priority class
+};
+
+const char* toString(AdmissionResult result);
+
+/**
+ * @brief Queueing and latency metrics of one priority class.
+ */
+struct ClassMetrics
+{
+    size_t submitted = 0;
+    size_t accepted = 0;        // Admitted into the queue
+    size_t shed = 0;            // Refused at admission, full queue or unreachable deadline
+    size_t expired = 0;         // Dropped from the queue before reaching the executor
+    size_t completed = 0;
+    size_t failed = 0;
+    size_t deadlineMisses = 0;  // Completed after their deadline
+    size_t queueLength = 0;
+    size_t maxQueueLength = 0;
+    LatencyStats queueDelay;    // From submission to dispatch
+    LatencyStats latency;       // From submission to completion
+};
+
+std::ostream& operator<< (std::ostream &os, const ClassMetrics &metrics);
+
+/**
+ * @brief Priority- and SLA-aware scheduler for several networks sharing
+ *        one accelerator.
+ *
+ *        Requests are picked by the following policy:
+ *
+ *        1) Strict priority between classes. A lower class only runs
+ *           when all higher classes are empty.
+ *        2) Within a class, a request whose deadline falls within the
+ *           urgency window is served first, earliest deadline first.
+ *        3) Otherwise the models of a class share the executor by weighted
+ *           fair queuing: the model with the least weighted service
+ *           (sum of batch sizes / weight) goes next.
+ *        4) Within a model, earliest deadline first, then FIFO.
+ *
+ *        Under overload the queues are bounded and shed load by deadline:
+ *
+ *        - A class with a capacity accepts at most that many queued
+ *          requests. submit() blocks until there is room (backpressure),
+ *          trySubmit() fails immediately with kREJECTED.
+ *        - A request is shed at admission, and dropped from the queue
+ *          before it reaches the executor, as soon as its deadline is
+ *          closer than its expected service time: a moving average of
+ *          the measured time per sample of its model, times its batch
+ *          size.
+ *
+ *        The Scheduler can be driven synchronously by dispatchOne(), which
+ *        makes the policy deterministic under a ManualClock, or by worker
+ *        threads started with start().
+ */
+class Scheduler
+{
+public:
+    Scheduler(Executor &executor, int numPriorityClasses = 3,
+              std::shared_ptr<SchedulerClock> clock = std::make_shared<SteadyClock>());
+
+    Scheduler(const Scheduler& other) = delete;
+    Scheduler& operator= (const Scheduler& other) = delete;
+
+    ~Scheduler();
+
+    /**
+     * @brief Share of a model within its class relative to the other
+     *        models. The default weight is 1.
+     */
+    void setModelWeight(const std::string &model, double weight);
+
+    /**
+     * @brief Requests closer than this to their deadline preempt the fair
+     *        share ordering of their class. Zero (default) disables it.
+     */
+    void setUrgencyWindow(Duration window);
+
+    /**
+     * @brief Max number of queued requests of a class. Zero (default)
+     *        means unbounded.
+     */
+    void setQueueCapacity(int priority, size_t capacity);
+
+    /**
+     * @brief Seed the expected service time of a model until it has been
+     *        measured.
+     * @param batchSize  Batch size the estimate is for.
+     */
+    void setServiceTimeEstimate(const std::string &model, Duration estimate, int batchSize = 1);
+
+    /**
+     * @brief Submit a request, waiting for room in a full queue until the
+     *        deadline of the request can no longer be met. A waiting
+     *        submit() fails with kREJECTED when stop() is called.
+     */
+    AdmissionResult submit(InferenceRequest request);
+
+    /**
+     * @brief Submit a request without waiting.
+     */
+    AdmissionResult trySubmit(InferenceRequest request);
+
+    /**
+     * @brief Pick the next request by the policy and execute it on the
+     *        calling thread.
+     * @return dispatched  False if nothing was pending.
+     */
+    bool dispatchOne();
+
+    /**
+     * @brief Start worker threads which dispatch until stop() is called.
+     *        Use one worker per request that may run concurrently on the
+     *        accelerator.
+     */
+    void start(int numWorkers = 1);
+    void stop();
+
+    size_t getNumPending() const;
+    ClassMetrics getMetrics(int priority) const;
+    int getNumPriorityClasses() const;
+
+protected:
+    struct Pending
+    {
+        InferenceRequest request;
+        TimePoint submitTime;
+    };
+
+    typedef std::pair<TimePoint, uint64_t> order_t; // Deadline, sequence number
+
+    struct ModelQueue
+    {
+        std::map<order_t, Pending> requests;
+        double virtualTime = 0.0; // Weighted service received
+    };
+
+    struct PriorityClass
+    {
+        std::map<std::string, ModelQueue> models;
+        size_t size = 0;
+        size_t capacity = 0;
+        double virtualTime = 0.0; // Virtual time of the last dispatched request
+
+        ClassMetrics metrics;
+        std::deque<double> queueDelays; // Recent samples in milliseconds
+        std::deque<double> latencies;
+    };
+
+    AdmissionResult admit(InferenceRequest &request, bool wait);
+    bool pick(Pending &next, std::vector<Pending> &expired);
+    void dropExpired(PriorityClass &c, TimePoint now, std::vector<Pending> &expired);
+    Duration serviceTimeOf(const std::string &model, int batchSize) const;
+    void complete(const Pending &pending, TimePoint dispatchTime, bool success);
+    void workerLoop();
+    double weightOf(const std::string &model) const;
+
+    Executor &executor;
+    std::shared_ptr<SchedulerClock> clock;
+
+    mutable std::mutex mtx;
+    std::condition_variable pendingCond;
+    std::condition_variable spaceCond;
+
+    std::vector<PriorityClass> classes;
+    std::map<std::string, double> weights;
+    std::map<std::string, Duration> serviceTimes; // Moving average per sample of each model
+    Duration urgencyWindow = Duration::zero();
+    uint64_t sequence = 0;
+
+    bool running = false;
+    bool stopped = false; // Set by stop() to release the waiting submit() calls
+    std::vector<std::thread> workers;
+};
+
+} // namespace trt
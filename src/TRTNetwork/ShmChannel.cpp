@@ -0,0 +1,284 @@
+#include "ShmChannel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+static const uint32_t SHM_MAGIC = 0x32535254; // "TRS2", bumped with the layout
+
+/** @note Tensors are aligned for the DMA engine and the slots to pages. */
+static const size_t SHM_TENSOR_ALIGNMENT = 256;
+static const size_t SHM_SLOT_ALIGNMENT = 4096;
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static void copyName(char *dst, const std::string &src)
+{
+    std::strncpy(dst, src.c_str(), SHM_MAX_NAME - 1);
+    dst[SHM_MAX_NAME - 1] = '\0';
+}
+
+static std::string segmentName(const std::string &name)
+{
+    return name.empty() || name.at(0) == '/' ? name : "/" + name;
+}
+
+ShmChannel::~ShmChannel()
+{
+    close();
+}
+
+bool ShmChannel::create(const std::string &name, const std::vector<ModelSpec> &models, int numSlots)
+{
+    close();
+
+    if (models.empty() || models.size() > SHM_MAX_MODELS || numSlots <= 0) {
+        TRTLog(ERROR) << "Shared channel " << name << " needs 1 to " << SHM_MAX_MODELS
+                      << " models and at least one slot";
+        return false;
+    }
+
+    // Lay out the tensors of every model in a slot; models share the payload
+    ShmModel layout[SHM_MAX_MODELS];
+    std::memset(layout, 0, sizeof(layout));
+    size_t payloadBytes = 0;
+    for (size_t m = 0; m < models.size(); ++m) {
+        const ModelSpec &spec = models.at(m);
+        std::vector< std::pair<std::string, size_t> > tensors = spec.inputs;
+        tensors.insert(tensors.end(), spec.outputs.begin(), spec.outputs.end());
+        if (tensors.size() > SHM_MAX_TENSORS || spec.name.size() >= SHM_MAX_NAME || spec.maxBatchSize <= 0) {
+            TRTLog(ERROR) << "Model " << spec.name << " does not fit in the shared layout";
+            return false;
+        }
+
+        ShmModel &model = layout[m];
+        copyName(model.name, spec.name);
+        model.maxBatchSize = spec.maxBatchSize;
+        model.numTensors = tensors.size();
+
+        size_t offset = 0;
+        for (size_t t = 0; t < tensors.size(); ++t) {
+            copyName(model.tensors[t].name, tensors.at(t).first);
+            model.tensors[t].offset = offset;
+            model.tensors[t].bytes = tensors.at(t).second;
+            model.tensors[t].isOutput = t >= spec.inputs.size();
+            offset = alignUp(offset + tensors.at(t).second * spec.maxBatchSize, SHM_TENSOR_ALIGNMENT);
+        }
+        payloadBytes = std::max(payloadBytes, offset);
+    }
+
+    const size_t payloadOffset = alignUp(sizeof(ShmSlot), SHM_TENSOR_ALIGNMENT);
+    const size_t slotBytes = alignUp(payloadOffset + payloadBytes, SHM_SLOT_ALIGNMENT);
+    const size_t slotsOffset = alignUp(sizeof(ShmHeader), SHM_SLOT_ALIGNMENT);
+    const size_t totalBytes = slotsOffset + slotBytes * numSlots;
+
+    const std::string path = segmentName(name);
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        TRTLog(ERROR) << "shm_open of " << path << " failed: " << std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, totalBytes) != 0) {
+        TRTLog(ERROR) << "Unable to size " << path << " to " << totalBytes << " bytes: " << std::strerror(errno);
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    void *ptr = mmap(nullptr, totalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+        TRTLog(ERROR) << "mmap of " << path << " failed: " << std::strerror(errno);
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    this->name = path;
+    this->owner = true;
+    this->base = ptr;
+    this->mappedBytes = totalBytes;
+
+    // The segment is zero-filled, so every slot starts in lap 0, kFREE
+    ShmHeader *header = new (ptr) ShmHeader;
+    header->numSlots = numSlots;
+    header->numModels = models.size();
+    header->slotBytes = slotBytes;
+    header->payloadOffset = payloadOffset;
+    header->totalBytes = totalBytes;
+    std::memcpy(header->models, layout, sizeof(layout));
+    header->head.store(0);
+    header->serverAlive.store(1);
+
+    for (int i = 0; i < numSlots; ++i)
+        new (static_cast<char*>(ptr) + slotsOffset + i * slotBytes) ShmSlot();
+
+    // Publish the magic last, clients check it before trusting the layout
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SHM_MAGIC;
+    return true;
+}
+
+bool ShmChannel::open(const std::string &name)
+{
+    close();
+
+    const std::string path = segmentName(name);
+    int fd = shm_open(path.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        TRTLog(ERROR) << "shm_open of " << path << " failed: " << std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmHeader)) {
+        TRTLog(ERROR) << "Shared segment " << path << " is not initialized";
+        ::close(fd);
+        return false;
+    }
+
+    void *ptr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+        TRTLog(ERROR) << "mmap of " << path << " failed: " << std::strerror(errno);
+        return false;
+    }
+
+    const ShmHeader *header = static_cast<const ShmHeader*>(ptr);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != SHM_MAGIC || header->totalBytes != (uint64_t)st.st_size) {
+        TRTLog(ERROR) << "Shared segment " << path << " has an unexpected layout";
+        munmap(ptr, st.st_size);
+        return false;
+    }
+
+    this->name = path;
+    this->owner = false;
+    this->base = ptr;
+    this->mappedBytes = st.st_size;
+    return true;
+}
+
+void ShmChannel::close()
+{
+    if (!base)
+        return;
+    munmap(base, mappedBytes);
+    if (owner)
+        shm_unlink(name.c_str());
+    base = nullptr;
+    mappedBytes = 0;
+    owner = false;
+}
+
+bool ShmChannel::isOpen() const
+{
+    return base != nullptr;
+}
+
+void* ShmChannel::getBase() const
+{
+    return base;
+}
+
+size_t ShmChannel::getMappedBytes() const
+{
+    return mappedBytes;
+}
+
+ShmHeader* ShmChannel::getHeader() const
+{
+    return static_cast<ShmHeader*>(base);
+}
+
+ShmSlot* ShmChannel::getSlot(uint64_t ticket) const
+{
+    const ShmHeader *header = getHeader();
+    size_t offset = alignUp(sizeof(ShmHeader), SHM_SLOT_ALIGNMENT) + (ticket % header->numSlots) * header->slotBytes;
+    return reinterpret_cast<ShmSlot*>(static_cast<char*>(base) + offset);
+}
+
+char* ShmChannel::getPayload(uint64_t ticket) const
+{
+    return reinterpret_cast<char*>(getSlot(ticket)) + getHeader()->payloadOffset;
+}
+
+int ShmChannel::findModel(const std::string &model) const
+{
+    const ShmHeader *header = getHeader();
+    for (uint32_t m = 0; m < header->numModels; ++m)
+        if (model == header->models[m].name)
+            return m;
+    return -1;
+}
+
+const ShmTensor* ShmChannel::findTensor(int model, const std::string &blob) const
+{
+    const ShmHeader *header = getHeader();
+    if (model < 0 || model >= (int)header->numModels)
+        return nullptr;
+    const ShmModel &m = header->models[model];
+    for (uint32_t t = 0; t < m.numTensors; ++t)
+        if (blob == m.tensors[t].name)
+            return &m.tensors[t];
+    return nullptr;
+}
+
+uint32_t ShmChannel::turnOf(uint64_t ticket, Phase phase) const
+{
+    uint64_t lap = ticket / getHeader()->numSlots;
+    return static_cast<uint32_t>(lap * 4 + phase);
+}
+
+bool ShmChannel::waitTurn(std::atomic<uint32_t> &turn, uint32_t expected, int timeoutMs)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (true) {
+        uint32_t current = turn.load(std::memory_order_acquire);
+        if (current == expected)
+            return true;
+
+        struct timespec ts, *timeout = nullptr;
+        if (timeoutMs >= 0) {
+            Clock::duration left = deadline - Clock::now();
+            if (left <= Clock::duration::zero())
+                return false;
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+            ts.tv_sec = ns / 1000000000LL;
+            ts.tv_nsec = ns % 1000000000LL;
+            timeout = &ts;
+        }
+
+        // Shared futex, the word lives in memory mapped by several processes
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&turn), FUTEX_WAIT, current, timeout, nullptr, 0);
+    }
+}
+
+void ShmChannel::setTurn(std::atomic<uint32_t> &turn, uint32_t value)
+{
+    turn.store(value, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&turn), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace trt
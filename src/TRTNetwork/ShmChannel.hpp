@@ -0,0 +1,167 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace trt {
+
+/** @note Fixed bounds of the shared layout, which cannot hold pointers **/
+#define SHM_MAX_MODELS  8
+#define SHM_MAX_TENSORS 6
+#define SHM_MAX_NAME    64
+
+/**
+ * @brief Tensor of a model within the payload of a slot.
+ */
+struct ShmTensor
+{
+    char name[SHM_MAX_NAME];
+    uint64_t offset;    // From the beginning of the payload
+    uint64_t bytes;     // Per sample
+    uint32_t isOutput;  // Written by the server rather than by the client
+};
+
+struct ShmModel
+{
+    char name[SHM_MAX_NAME];
+    uint32_t maxBatchSize;
+    uint32_t numTensors;
+    ShmTensor tensors[SHM_MAX_TENSORS];
+};
+
+/**
+ * @brief Header of a slot of the ring. The payload follows at
+ *        ShmHeader::payloadOffset.
+ *
+ *        The turn word is the handshake between the client holding the
+ *        ticket of the slot and the server, see ShmChannel::turnOf.
+ */
+struct ShmSlot
+{
+    std::atomic<uint32_t> turn;
+    uint32_t model;     // Index in ShmHeader::models
+    int32_t batchSize;
+    int32_t status;     // 1 if the inference succeeded
+};
+
+struct ShmHeader
+{
+    uint32_t magic;
+    uint32_t numSlots;
+    uint32_t numModels;
+    uint64_t slotBytes;     // Stride between slots
+    uint64_t payloadOffset; // From the beginning of a slot
+    uint64_t totalBytes;
+    ShmModel models[SHM_MAX_MODELS];
+
+    alignas(64) std::atomic<uint64_t> head;         // Next ticket handed to a client
+    alignas(64) std::atomic<uint32_t> serverAlive;
+};
+
+/**
+ * @brief Ring of request slots in a POSIX shared memory segment.
+ *
+ *        The segment is created by the server, which owns the networks,
+ *        and mapped by any number of client processes. Each slot holds the
+ *        input and output tensors of one request of the largest model, so
+ *        clients write their inputs in place and the server passes the
+ *        slot memory to forward() without another copy.
+ *
+ *        Clients draw tickets from a shared counter; ticket t uses slot
+ *        t % numSlots in lap t / numSlots. The server serves tickets in
+ *        order, so the ring keeps the arrival order. Waiting is done with
+ *        futexes on the turn word of the slot.
+ */
+class ShmChannel
+{
+public:
+    /**
+     * @brief Phases of a slot within one lap.
+     */
+    enum Phase
+    {
+        kFREE = 0,      // Owned by the client holding the ticket
+        kSUBMITTED = 1, // Inputs written, waiting for the server
+        kDONE = 2       // Outputs written, waiting for the client
+    };
+
+    ShmChannel() = default;
+
+    ShmChannel(const ShmChannel& other) = delete;
+    ShmChannel& operator= (const ShmChannel& other) = delete;
+
+    ~ShmChannel();
+
+    /**
+     * @brief Layout of a model requested by the server.
+     */
+    struct ModelSpec
+    {
+        std::string name;
+        int maxBatchSize;
+        std::vector< std::pair<std::string, size_t> > inputs;  // Name, bytes per sample
+        std::vector< std::pair<std::string, size_t> > outputs;
+    };
+
+    /**
+     * @brief Create the segment, replacing a stale one of the same name.
+     */
+    bool create(const std::string &name, const std::vector<ModelSpec> &models, int numSlots);
+
+    /**
+     * @brief Map the segment created by a server.
+     */
+    bool open(const std::string &name);
+
+    /**
+     * @brief Unmap the segment, and remove it if it was created here.
+     */
+    void close();
+
+    bool isOpen() const;
+    void* getBase() const;
+    size_t getMappedBytes() const;
+    ShmHeader* getHeader() const;
+    ShmSlot* getSlot(uint64_t ticket) const;
+    char* getPayload(uint64_t ticket) const;
+
+    /**
+     * @return index    Of the model in the header, or -1 if unknown.
+     */
+    int findModel(const std::string &model) const;
+
+    /**
+     * @return tensor   Of the model, or nullptr if unknown.
+     */
+    const ShmTensor* findTensor(int model, const std::string &blob) const;
+
+    /**
+     * @brief Value of the turn word of the slot of ticket in phase.
+     *        Laps only advance, so equality is enough and the value may
+     *        wrap around.
+     */
+    uint32_t turnOf(uint64_t ticket, Phase phase) const;
+
+    /**
+     * @brief Wait until the turn word of the slot equals expected.
+     * @param timeoutMs     Negative to wait forever.
+     * @return reached      False on timeout.
+     */
+    static bool waitTurn(std::atomic<uint32_t> &turn, uint32_t expected, int timeoutMs);
+
+    /**
+     * @brief Publish a new turn and wake up the waiters on it.
+     */
+    static void setTurn(std::atomic<uint32_t> &turn, uint32_t value);
+
+protected:
+    std::string name;
+    bool owner = false;
+    void *base = nullptr;
+    size_t mappedBytes = 0;
+};
+
+} // namespace trt
@@ -0,0 +1,106 @@
+#include "StreamBatcher.hpp"
+
+#include <chrono>
+
+#include "Logger.hpp"
+#include "ThreadPool.hpp"
+
+namespace trt {
+
+StreamBatcher::StreamBatcher(Transformer &transformer)
+    : transformer(transformer)
+{
+}
+
+void StreamBatcher::notifyReady()
+{
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        ++readyEvents;
+    }
+    readyCond.notify_all();
+}
+
+bool StreamBatcher::addSource(VideoSource &source)
+{
+    source.setReadyCallback([this]() { notifyReady(); });
+    if (!source.start())
+        return false;
+    sources.push_back(&source);
+    return true;
+}
+
+bool StreamBatcher::isFinished() const
+{
+    for (const VideoSource *source : sources)
+        if (!source->isFinished())
+            return false;
+    return true;
+}
+
+int StreamBatcher::nextBatch(float *batch_ptr, int maxBatch, std::vector<FrameInfo> &frames, int timeoutMs)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    const int numStreams = sources.size();
+
+    frames.clear();
+    batch.clear();
+    batchStreams.clear();
+    if (numStreams == 0 || maxBatch <= 0)
+        return 0;
+
+    while (true) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> locker(mtx);
+            seen = readyEvents;
+        }
+
+        // Round-robin over the streams, at most one frame each per round
+        bool progress = true;
+        while ((int)batch.size() < maxBatch && progress) {
+            progress = false;
+            for (int k = 0; k < numStreams && (int)batch.size() < maxBatch; ++k) {
+                int s = (nextStream + k) % numStreams;
+                Frame frame;
+                if (sources.at(s)->tryRead(frame)) {
+                    batch.push_back(frame);
+                    batchStreams.push_back(s);
+                    progress = true;
+                }
+            }
+        }
+        nextStream = (nextStream + 1) % numStreams;
+
+        if (!batch.empty() || isFinished())
+            break;
+
+        // Nothing ready yet, wait for a decoder to signal
+        std::unique_lock<std::mutex> lock(mtx);
+        std::function<bool()> pred = [this, seen]() { return readyEvents != seen; };
+        if (timeoutMs < 0)
+            readyCond.wait(lock, pred);
+        else if (!readyCond.wait_until(lock, deadline, pred))
+            return 0;
+    }
+
+    const int batchSize = batch.size();
+    const int sizePerBatch = transformer.get_sample_size();
+
+    ThreadPool::globalInstance().parallelFor(0, batchSize, [&](int n) {
+        transformer.preprocess(batch_ptr + n * sizePerBatch, batch.at(n).image);
+    });
+
+    // The batch is written, so the buffers can be decoded into again
+    for (int n = 0; n < batchSize; ++n) {
+        FrameInfo info;
+        info.stream = batchStreams.at(n);
+        info.index = batch.at(n).index;
+        frames.push_back(info);
+        sources.at(info.stream)->release(batch.at(n));
+    }
+    return batchSize;
+}
+
+} // namespace trt
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "Transformer.hpp"
+#include "VideoSource.hpp"
+
+namespace trt {
+
+/**
+ * @brief Origin of one sample of a batch assembled by a StreamBatcher.
+ */
+struct FrameInfo
+{
+    int stream;     // Index of the source in the batcher
+    int64_t index;  // Position of the frame in its stream
+};
+
+/**
+ * @brief Assemble network batches from many concurrent VideoSources.
+ *
+ *        trt::StreamBatcher batcher(transformer);
+ *        batcher.addSource(cam01);
+ *        batcher.addSource(cam02);
+ *
+ *        std::vector<trt::FrameInfo> frames;
+ *        while (int n = batcher.nextBatch(data_ptr, maxBatchSize, frames)) {
+ *            network.forward(n, {{"data", data_ptr}, {"prob", prob_ptr}});
+ *            ...
+ *        }
+ *
+ *        Streams are visited round-robin, one frame per stream per round,
+ *        so a fast stream cannot starve the others. The frames of a batch
+ *        are preprocessed in parallel straight from the buffers of their
+ *        pools, which are recycled as soon as the batch is written.
+ */
+class StreamBatcher
+{
+public:
+    explicit StreamBatcher(Transformer &transformer);
+
+    /**
+     * @brief Add a source which has not been started yet; the batcher
+     *        starts it. The source is not owned and must outlive the
+     *        batcher.
+     */
+    bool addSource(VideoSource &source);
+
+    /**
+     * @brief Wait until at least one frame is ready, then preprocess up to
+     *        maxBatch ready frames into consecutive batch slots.
+     * @param frames        Origin of each written sample.
+     * @param timeoutMs     Max time to wait for the first frame, negative
+     *                      to wait forever.
+     * @return batchSize    Number of samples written, 0 on timeout or when
+     *                      every stream has ended.
+     */
+    int nextBatch(float* batch_ptr, int maxBatch, std::vector<FrameInfo>& frames, int timeoutMs = -1);
+
+    /**
+     * @brief Every stream has ended and was consumed.
+     */
+    bool isFinished() const;
+
+protected:
+    void notifyReady();
+
+    Transformer &transformer;
+    std::vector<VideoSource*> sources;
+    int nextStream = 0;
+
+    std::mutex mtx;
+    std::condition_variable readyCond;
+    uint64_t readyEvents = 0;
+
+    std::vector<Frame> batch;   // Reused between calls
+    std::vector<int> batchStreams;
+};
+
+} // namespace trt
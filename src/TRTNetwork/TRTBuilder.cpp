@@ -27,8 +27,10 @@ std::ostream& operator<< (std::ostream& os, const IOBlob& blob)
 
 IOBlob::~IOBlob()
 {
-    // Cuda api knows if ptr == nullptr
-    cudaFree(gpuPtr);
+    if (gpuPtr)
+        allocator->deallocate(gpuPtr);
+    if (rawGpuPtr)
+        allocator->deallocate(rawGpuPtr);
 }
 
 nvinfer1::ICudaEngine* TRTBuilder::createEngine(
@@ -36,7 +38,9 @@ nvinfer1::ICudaEngine* TRTBuilder::createEngine(
     const std::string &model,
     const std::vector<std::string> &outputNames,
     int maxBatchSize, int inputHeight, int inputWidth,
-    size_t maxWorkspaceSize)
+    size_t maxWorkspaceSize,
+    const InputNormalization *normalization,
+    const std::string &normalizedInput)
 {
     nvinfer1::IBuilder *builder = nvinfer1::createInferBuilder(Logger::globalInstance());
     nvinfer1::INetworkDefinition *network = builder->createNetwork();
@@ -44,24 +48,40 @@ nvinfer1::ICudaEngine* TRTBuilder::createEngine(
 
     const nvcaffeparser1::IBlobNameToTensor *mapping =
         parser->parse(deploy.c_str(), model.c_str(), *network, nvinfer1::DataType::kFLOAT);
-    for (const auto& outputName : outputNames)
-        network->markOutput(*mapping->find(outputName.c_str()));
+    bool parsed = mapping != nullptr;
+    if (!parsed)
+        TRTLog(ERROR) << "Unable to parse " << deploy << " with the weights of " << model;
+
+    for (size_t i = 0; parsed && i < outputNames.size(); ++i) {
+        nvinfer1::ITensor *output = mapping->find(outputNames.at(i).c_str());
+        if (!output) {
+            TRTLog(ERROR) << "Unknown output blob " << outputNames.at(i) << " in " << deploy;
+            parsed = false;
+        } else {
+            network->markOutput(*output);
+        }
+    }
 
     /**
      * For image workload, we often need to resize the input blob to the desired size.
      * By convention, the first input blob is the image blob to resize so we just need to
      * retrieve and modify the shape of the tensor accordingly.
      */
-    if (inputHeight && inputWidth) {
+    if (parsed && inputHeight && inputWidth && network->getNbInputs() > 0) {
         nvinfer1::ITensor *inputTensor = network->getInput(0);
         nvinfer1::Dims dims = inputTensor->getDimensions();
         dims.d[1] = inputHeight; dims.d[2] = inputWidth;
         inputTensor->setDimensions(dims);
     }
 
-    builder->setMaxBatchSize(maxBatchSize);
-    builder->setMaxWorkspaceSize(maxWorkspaceSize);
-    nvinfer1::ICudaEngine *engine = builder->buildCudaEngine(*network);
+    // The weights of the normalization are read when the engine is built
+    std::vector<float> normalizationWeights;
+    nvinfer1::ICudaEngine *engine = nullptr;
+    if (parsed && (!normalization || prependNormalization(*network, *normalization, normalizationWeights, normalizedInput))) {
+        builder->setMaxBatchSize(maxBatchSize);
+        builder->setMaxWorkspaceSize(maxWorkspaceSize);
+        engine = builder->buildCudaEngine(*network);
+    }
 
     parser->destroy();
     network->destroy();
@@ -10,6 +10,8 @@
 #include "TensorRT/NvCaffeParser.h"
 
 #include "Logger.hpp"
+#include "Normalization.hpp"
+#include "DeviceMemory.hpp"
 
 namespace trt {
 
@@ -36,6 +38,8 @@ public:
     nvinfer1::Dims dims;
     size_t sizePerBatch;
     void *gpuPtr = nullptr; // On-Gpu pointer for the data
+    void *rawGpuPtr = nullptr; // Raw 8-bit images of an input normalized by the engine
+    std::shared_ptr<DeviceAllocator> allocator; // Allocator of gpuPtr and rawGpuPtr
 };
 
 /**
@@ -49,12 +53,22 @@ std::ostream& operator<< (std::ostream& os, const IOBlob& blob);
 class TRTBuilder
 {
 public:
+    /**
+     * @param normalization  If not null, fold the normalization of an input
+     *                       into the engine, see prependNormalization.
+     * @param normalizedInput Name of that input, the first input of the
+     *                       network if empty.
+     * @return engine        nullptr if the files cannot be parsed, an output
+     *                       blob is unknown or the build fails.
+     */
     static nvinfer1::ICudaEngine* createEngine(
         const std::string &deploy,
         const std::string &model,
         const std::vector<std::string> &outputNames,
         int maxBatchSize = 1, int inputHeight = 0, int inputWidth = 0,
-        size_t maxWorkspaceSize = 1 << 25);
+        size_t maxWorkspaceSize = 1 << 25,
+        const InputNormalization *normalization = nullptr,
+        const std::string &normalizedInput = std::string());
 };
 
 } // namespace trt
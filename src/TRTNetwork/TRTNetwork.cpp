@@ -2,6 +2,10 @@
 
 #include "cuda_runtime.h"
 
+#include "CostModel.hpp"
+#include "HostTensorPool.hpp"
+#include "Traffic.hpp"
+
 namespace trt {
 
 /**
@@ -14,8 +18,10 @@ TRTNetwork::TRTNetwork(
            const std::vector< std::string > &outputBlobs,
            const std::vector< std::string > &inputBlobs,
            int maxBatchSize, int inputHeight, int inputWidth,
-           size_t maxWorkspaceSize)
+           size_t maxWorkspaceSize,
+           const InputNormalization *normalization)
     : name(name),
+      maxBatchSize(maxBatchSize),
       outputBlobNames(outputBlobs),
       inputBlobNames(inputBlobs)
 {
@@ -28,10 +34,47 @@ TRTNetwork::TRTNetwork(
         blobMapping[blob].isOutput = false;
     }
 
+    // The normalized input also needs a buffer for the raw images
+    const bool rawInput = normalization && !inputBlobs.empty();
+
+    /* Reserve an estimate before building, so that a deferred reservation
+     * waits without holding an engine, and true it up once the engine is
+     * built. The cost model is an upper bound for the supported layers
+     * only, so kREJECT reserves nothing and rejects on the measured
+     * footprint, see MemoryBudget::estimateReservation. */
+    MemoryFootprint estimate;
+    NetworkCost cost;
+    if (estimateCost(deploy, outputBlobs, cost, inputHeight, inputWidth)) {
+        estimate = cost.estimateFootprint(maxBatchSize, maxWorkspaceSize);
+        if (rawInput && cost.blobShapes.count(inputBlobs.at(0))) {
+            size_t vol = maxBatchSize;
+            for (int dim : cost.blobShapes.at(inputBlobs.at(0)))
+                vol *= dim;
+            estimate.ioBlobBytes += vol;
+        }
+    } else {
+        TRTLog(WARN) << "Unable to estimate the footprint of network " << name
+                     << ", its memory is only reserved once the engine is built";
+    }
+
+    MemoryBudget &budget = MemoryBudget::globalInstance();
+    const size_t reserved = budget.estimateReservation(estimate.total());
+    if (!budget.reserve(reserved)) {
+        std::stringstream ss;
+        ss << "Network " << name << " (estimated " << estimate << ") exceeds the device memory budget: "
+           << budget.getAvailable() << " of " << budget.getLimit() << " bytes available";
+        TRTLog(ERROR) << ss.str();
+        throw DeviceMemoryError(ss.str());
+    }
+
     engine = TRTBuilder::createEngine(deploy, model, outputBlobs,
                                       maxBatchSize, inputHeight, inputWidth,
-                                      maxWorkspaceSize);
-    contex = engine->createExecutionContext();
+                                      maxWorkspaceSize, rawInput ? normalization : nullptr,
+                                      rawInput ? inputBlobs.at(0) : std::string());
+    if (!engine) {
+        budget.release(reserved);
+        throw std::runtime_error("Unable to build the engine of network " + name);
+    }
 
     for (std::pair<const std::string, IOBlob> &kv : blobMapping) {
         kv.second.index = engine->getBindingIndex(kv.second.name.c_str());
@@ -42,22 +85,116 @@ TRTNetwork::TRTNetwork(
             size *= kv.second.dims.d[i];
         kv.second.sizePerBatch = size;
 
-        cudaMalloc(&kv.second.gpuPtr, maxBatchSize * size * sizeof(float));
+        footprint.ioBlobBytes += maxBatchSize * size * sizeof(float);
+    }
+
+    std::string layout = getBindingInfoString();
+    identity = hash128(layout.data(), layout.size());
+    if (!hashFile(deploy, identity) || !hashFile(model, identity))
+        TRTLog(WARN) << "Unable to read the model files of network " << name << ", its identity is the layout only";
+    if (normalization) {
+        identity = hash128(normalization->mean.data(), normalization->mean.size() * sizeof(float), identity);
+        identity = hash128(&normalization->scale, sizeof(float), identity);
+        identity = hash128(normalization->channelOrder.data(), normalization->channelOrder.size() * sizeof(int),
+                           identity);
+    }
+
+    if (rawInput)
+        footprint.ioBlobBytes += maxBatchSize * blobMapping[inputBlobs.at(0)].sizePerBatch;
+
+    /* TensorRT does not expose the device size of the weights, but the
+     * serialized engine is dominated by them and is a close estimate. */
+    footprint.workspaceBytes = engine->getWorkspaceSize();
+    nvinfer1::IHostMemory *serialized = engine->serialize();
+    if (serialized) {
+        footprint.engineBytes = serialized->size();
+        serialized->destroy();
+    }
+
+    if (!budget.resize(reserved, footprint.total())) {
+        budget.release(reserved);
+        engine->destroy();
+        std::stringstream ss;
+        ss << "Network " << name << " (" << footprint << ") exceeds the device memory budget: "
+           << budget.getAvailable() << " of " << budget.getLimit() << " bytes available";
+        TRTLog(ERROR) << ss.str();
+        throw DeviceMemoryError(ss.str());
+    }
+
+    std::shared_ptr<DeviceAllocator> allocator = budget.getAllocator();
+    for (std::pair<const std::string, IOBlob> &kv : blobMapping) {
+        size_t bytes = maxBatchSize * kv.second.sizePerBatch * sizeof(float);
+        kv.second.allocator = allocator;
+        kv.second.gpuPtr = allocator->allocate(bytes);
+        if (!kv.second.gpuPtr) {
+            // The IOBlobs allocated so far are freed by their destructors
+            budget.release(footprint.total());
+            engine->destroy();
+            std::stringstream ss;
+            ss << "Unable to allocate " << bytes << " bytes for blob " << kv.first << " of network " << name;
+            TRTLog(ERROR) << ss.str();
+            throw DeviceMemoryError(ss.str());
+        }
+    }
+
+    if (rawInput) {
+        IOBlob &blob = blobMapping[inputBlobs.at(0)];
+        blob.rawGpuPtr = allocator->allocate(maxBatchSize * blob.sizePerBatch);
+        if (!blob.rawGpuPtr) {
+            budget.release(footprint.total());
+            engine->destroy();
+            std::stringstream ss;
+            ss << "Unable to allocate the raw input buffer of blob " << blob.name << " of network " << name;
+            TRTLog(ERROR) << ss.str();
+            throw DeviceMemoryError(ss.str());
+        }
+    }
+
+    contex = engine->createExecutionContext();
+    cudaError_t err = cudaStreamCreate(&transferStream);
+    if (err != cudaSuccess) {
+        TRTLog(WARN) << "Unable to create the transfer stream of network " << name << ": " << cudaGetErrorString(err)
+                     << ", page-locked buffers are transferred on the default stream";
+        transferStream = nullptr;
     }
 }
 
 TRTNetwork::~TRTNetwork()
 {
+    if (transferStream)
+        cudaStreamDestroy(transferStream);
     if (contex)
         contex->destroy();
     if (engine)
         engine->destroy();
+    MemoryBudget::globalInstance().release(footprint.total());
 }
 
 bool TRTNetwork::forward(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    if (!recorder)
+        return forwardHost(batchSize, feedDict);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool success = forwardHost(batchSize, feedDict);
+    recorder->record(*this, batchSize, feedDict, start, std::chrono::steady_clock::now(), success);
+    return success;
+}
+
+bool TRTNetwork::forwardHost(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict)
 {
     typedef std::map<std::string, IOBlob>::iterator it_t;
 
+    bool pinned = true;
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        it_t it = blobMapping.find(kv.first);
+        if (it == blobMapping.end())
+            return false;
+        pinned = pinned && HostTensorPool::isPinned(kv.second, batchSize * it->second.sizePerBatch * sizeof(float));
+    }
+    if (pinned)
+        return forwardPinned(batchSize, feedDict);
+
     for (const std::pair<const std::string, void*> &kv : feedDict) {
         it_t it = blobMapping.find(kv.first);
         if (it == blobMapping.end())
@@ -81,6 +218,45 @@ bool TRTNetwork::forward(int batchSize, const std::vector< std::pair<std::string
     return true;
 }
 
+/**
+ * @brief Inference with page-locked host buffers only. All transfers and
+ *        the execution are queued on the stream of the network, which is
+ *        synchronized once at the end instead of after every copy.
+ */
+bool TRTNetwork::forwardPinned(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict)
+{
+    typedef std::map<std::string, IOBlob>::iterator it_t;
+
+    /* Whatever fails, the work queued so far still refers to the buffers
+     * of the caller, so the stream is always synchronized before returning. */
+    cudaError_t err = cudaSuccess;
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        it_t it = blobMapping.find(kv.first);
+        if (!it->second.isOutput && err == cudaSuccess)
+            err = cudaMemcpyAsync(it->second.gpuPtr, kv.second, batchSize * it->second.sizePerBatch * sizeof(float),
+                                  cudaMemcpyHostToDevice, transferStream);
+        bindings[it->second.index] = it->second.gpuPtr;
+    }
+
+    bool executed = err == cudaSuccess && contex->enqueue(batchSize, bindings, transferStream, nullptr);
+
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        it_t it = blobMapping.find(kv.first);
+        if (it->second.isOutput && executed && err == cudaSuccess)
+            err = cudaMemcpyAsync(kv.second, it->second.gpuPtr, batchSize * it->second.sizePerBatch * sizeof(float),
+                                  cudaMemcpyDeviceToHost, transferStream);
+    }
+
+    cudaError_t syncErr = cudaStreamSynchronize(transferStream);
+    if (err == cudaSuccess)
+        err = syncErr;
+    if (err != cudaSuccess) {
+        TRTLog(ERROR) << "Transfer of network " << name << " failed: " << cudaGetErrorString(err);
+        return false;
+    }
+    return executed;
+}
+
 bool TRTNetwork::forward(int batchSize, const std::vector<std::pair<std::string, void*> > &feedDict, cudaStream_t stream)
 {
     typedef std::map<std::string, IOBlob>::iterator it_t;
@@ -96,6 +272,75 @@ bool TRTNetwork::forward(int batchSize, const std::vector<std::pair<std::string,
     return contex->enqueue(batchSize, bindings, stream, nullptr);
 }
 
+bool TRTNetwork::forward(const std::vector< std::pair<std::string, TensorView> > &feedDict)
+{
+    if (!recorder)
+        return forwardViews(feedDict);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool success = forwardViews(feedDict);
+    recorder->record(*this, feedDict, start, std::chrono::steady_clock::now(), success);
+    return success;
+}
+
+bool TRTNetwork::forwardViews(const std::vector< std::pair<std::string, TensorView> > &feedDict)
+{
+    typedef std::map<std::string, IOBlob>::iterator it_t;
+
+    if (feedDict.empty()) {
+        TRTLog(ERROR) << "Empty feedDict for network " << name;
+        return false;
+    }
+
+    int batchSize = 0;
+    for (const std::pair<std::string, TensorView> &kv : feedDict) {
+        it_t it = blobMapping.find(kv.first);
+        if (it == blobMapping.end()) {
+            TRTLog(ERROR) << "Unknown blob " << kv.first << " of network " << name;
+            return false;
+        }
+        const IOBlob &blob = it->second;
+        if (!validateView(kv.second, blob.name, getBlobShape(blob.name), maxBatchSize,
+                          blob.isOutput, blob.rawGpuPtr != nullptr))
+            return false;
+        if (batchSize && batchSize != kv.second.shape.at(0)) {
+            TRTLog(ERROR) << "Inconsistent batch size of blob " << kv.first;
+            return false;
+        }
+        batchSize = kv.second.shape.at(0);
+    }
+
+    for (const std::pair<std::string, TensorView> &kv : feedDict) {
+        it_t it = blobMapping.find(kv.first);
+        const IOBlob &blob = it->second;
+        if (!blob.isOutput && kv.second.dtype == DType::kUINT8) {
+            if (!copyToDevice(blob.rawGpuPtr, kv.second) ||
+                !castToPlanar(static_cast<const uint8_t*>(blob.rawGpuPtr), static_cast<float*>(blob.gpuPtr),
+                              batchSize, blob.dims.d[0], blob.dims.d[1], blob.dims.d[2], 0))
+                return false;
+        } else if (!blob.isOutput && !copyToDevice(blob.gpuPtr, kv.second)) {
+            return false;
+        }
+        bindings[blob.index] = blob.gpuPtr;
+    }
+
+    if (!contex->execute(batchSize, bindings))
+        return false;
+
+    for (const std::pair<std::string, TensorView> &kv : feedDict) {
+        it_t it = blobMapping.find(kv.first);
+        if (it->second.isOutput && !copyFromDevice(kv.second, it->second.gpuPtr))
+            return false;
+    }
+
+    return true;
+}
+
+void TRTNetwork::setRecorder(TrafficRecorder *recorder)
+{
+    this->recorder = recorder;
+}
+
 std::string TRTNetwork::getName() const
 {
     return name;
@@ -113,6 +358,11 @@ std::string TRTNetwork::getBindingInfoString() const
     return ss.str();
 }
 
+Hash128 TRTNetwork::getIdentity() const
+{
+    return identity;
+}
+
 std::vector<int> TRTNetwork::getBlobShape(const std::string& name) const
 {
     typedef std::map<std::string, IOBlob>::const_iterator it_t;
@@ -128,4 +378,24 @@ std::vector<int> TRTNetwork::getBlobShape(const std::string& name) const
     return shape;
 }
 
+MemoryFootprint TRTNetwork::getMemoryFootprint() const
+{
+    return footprint;
+}
+
+int TRTNetwork::getMaxBatchSize() const
+{
+    return maxBatchSize;
+}
+
+const std::vector<std::string>& TRTNetwork::getOutputBlobNames() const
+{
+    return outputBlobNames;
+}
+
+const std::vector<std::string>& TRTNetwork::getInputBlobNames() const
+{
+    return inputBlobNames;
+}
+
 } // namespace trt
@@ -6,12 +6,17 @@
 #include <sstream>
 
 #include "TRTBuilder.hpp"
+#include "TensorView.hpp"
+#include "DeviceMemory.hpp"
+#include "Hash.hpp"
 
 /** @note Assume there are at most 6 input & output blobs **/
 #define TRT_MAX_BINDINGS 6
 
 namespace trt {
 
+class TrafficRecorder;
+
 /**
  * @brief Neural network instance on TensorRT.
  *
@@ -45,6 +50,15 @@ public:
      *                          Resize the width of the first input blob (usually image) to inputWidth.
      *                          Set as 0 to use the default value defined in prototxt.
      * @param maxWorkspaceSize  The maximum workspace size specified in TensorRT.
+     * @param normalization     Fold the normalization of the first blob of inputBlobs into
+     *                          the engine, see InputNormalization, whatever its position
+     *                          among the inputs of the prototxt. The blob then also accepts
+     *                          raw uint8 TensorViews of [N, H, W, C], e.g. the data of
+     *                          continuous cv::Mat, which are converted on the Gpu.
+     *
+     * @throw DeviceMemoryError  If the footprint of the network exceeds the global
+     *                           MemoryBudget, or its IOBlobs cannot be allocated.
+     * @throw std::runtime_error If the engine cannot be built.
      */
     TRTNetwork(const std::string &name,
                const std::string &deploy,
@@ -52,7 +66,8 @@ public:
                const std::vector< std::string > &outputBlobs,
                const std::vector< std::string > &inputBlobs,
                int maxBatchSize = 1, int inputHeight = 0, int inputWidth = 0,
-               size_t maxWorkspaceSize = 1 << 25);
+               size_t maxWorkspaceSize = 1 << 25,
+               const InputNormalization *normalization = nullptr);
 
     TRTNetwork(const TRTNetwork& other) = delete;
     TRTNetwork& operator= (const TRTNetwork& other) = delete;
@@ -74,6 +89,10 @@ public:
      *
      *                   as the feedDict argument to the function.
      *
+     *                   Page-locked pointers from a HostTensorPool, or registered
+     *                   through it, are transferred asynchronously without the
+     *                   staging copy the driver does for pageable memory.
+     *
      * @return success   True if successfully trigger the inference.
      */
     bool forward(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict);
@@ -92,13 +111,57 @@ public:
      * @param stream     Cuda stream used to asynchronous execution.
      */
     bool forward(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict, cudaStream_t stream);
+    /**
+     * @brief An overloaded function which binds strided host tensors instead
+     *        of raw pointers. The batch size is the first dimension of the
+     *        views, which must agree among all views.
+     *
+     * @param feedDict   The binding of input and output in the form of
+     *
+     *                   { {"data", trt::TensorView(data_ptr, {N, C, H, W}, strides)},
+     *                     {"prob", trt::TensorView(prob_ptr, {N, K, 1, 1})} }
+     *
+     *                   Every view is validated against the dims of its blob,
+     *                   see validateView, and an empty feedDict is rejected.
+     *                   The first input of a network built with an InputNormalization
+     *                   also accepts uint8 views of [N, H, W, C].
+     *                   Non-contiguous inputs are gathered and non-contiguous
+     *                   outputs are scattered by 2D copies straight from/to
+     *                   device memory, so no host-side staging copy is needed.
+     */
+    bool forward(const std::vector< std::pair<std::string, TensorView> > &feedDict);
+
+    /**
+     * @brief Record the calls of forward() with host pointers or TensorViews
+     *        to a trace, see TrafficRecorder. The recorder is not owned, pass
+     *        nullptr to stop recording.
+     */
+    void setRecorder(TrafficRecorder *recorder);
 
     std::string getName() const;
     std::string getBindingInfoString() const;
+
+    /**
+     * @brief Digest of what determines the outputs of the network: the
+     *        content of the deploy and model files, the normalization and
+     *        the binding layout. Computed once on construction, so that
+     *        instances of the same model share it and retrained weights
+     *        behind the same path do not.
+     */
+    Hash128 getIdentity() const;
     std::vector<int> getBlobShape(const std::string& name) const;
+    int getMaxBatchSize() const;
+    MemoryFootprint getMemoryFootprint() const;
+    const std::vector<std::string>& getOutputBlobNames() const;
+    const std::vector<std::string>& getInputBlobNames() const;
 
 protected:
+    bool forwardHost(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict);
+    bool forwardPinned(int batchSize, const std::vector< std::pair<std::string, void*> > &feedDict);
+    bool forwardViews(const std::vector< std::pair<std::string, TensorView> > &feedDict);
+
     const std::string name;
+    const int maxBatchSize;
 
     std::vector<std::string> outputBlobNames;
     std::vector<std::string> inputBlobNames;
@@ -108,6 +171,11 @@ protected:
 
     nvinfer1::ICudaEngine *engine = nullptr;
     nvinfer1::IExecutionContext *contex = nullptr;
+    cudaStream_t transferStream = nullptr; // Used for transfers of page-locked buffers
+
+    MemoryFootprint footprint;
+    Hash128 identity;
+    TrafficRecorder *recorder = nullptr;
 };
 
 } // namespace trt
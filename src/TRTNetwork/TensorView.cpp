@@ -0,0 +1,208 @@
+#include "TensorView.hpp"
+
+#include <algorithm>
+
+#include "cuda_runtime.h"
+
+#include "Logger.hpp"
+
+namespace trt {
+
+size_t sizeOf(DType dtype)
+{
+    switch (dtype) {
+    case DType::kUINT8:
+        return 1;
+    case DType::kFLOAT:
+    default:
+        return 4;
+    }
+}
+
+TensorView::TensorView(void *data, const std::vector<int> &shape, DType dtype)
+    : data(data), shape(shape), strides(shape.size()), dtype(dtype)
+{
+    size_t stride = sizeOf(dtype);
+    for (int i = (int)shape.size() - 1; i >= 0; --i) {
+        strides.at(i) = stride;
+        stride *= shape.at(i);
+    }
+}
+
+TensorView::TensorView(void *data, const std::vector<int> &shape, const std::vector<size_t> &strides,
+                       DType dtype)
+    : data(data), shape(shape), strides(strides), dtype(dtype)
+{
+}
+
+bool TensorView::isContiguous() const
+{
+    size_t stride = sizeOf(dtype);
+    for (int i = (int)shape.size() - 1; i >= 0; --i) {
+        if (shape.at(i) != 1 && strides.at(i) != stride)
+            return false;
+        stride *= shape.at(i);
+    }
+    return true;
+}
+
+bool TensorView::hasOverlap() const
+{
+    // Dims of size 1 never step, the others must each step over the inner ones
+    std::vector< std::pair<size_t, int> > dims;
+    for (int i = 0; i < (int)shape.size() && i < (int)strides.size(); ++i)
+        if (shape.at(i) > 1)
+            dims.push_back(std::make_pair(strides.at(i), shape.at(i)));
+    std::sort(dims.begin(), dims.end());
+
+    size_t span = sizeOf(dtype);
+    for (const std::pair<size_t, int> &dim : dims) {
+        if (dim.first < span)
+            return true;
+        span += dim.first * (dim.second - 1);
+    }
+    return false;
+}
+
+size_t TensorView::numElements() const
+{
+    size_t vol = 1;
+    for (int i = 0; i < (int)shape.size(); ++i)
+        vol *= shape.at(i);
+    return vol;
+}
+
+size_t TensorView::numBytes() const
+{
+    return numElements() * sizeOf(dtype);
+}
+
+bool validateView(const TensorView &view, const std::string &blob, const std::vector<int> &dims,
+                  int maxBatchSize, bool isOutput, bool acceptsRaw)
+{
+    const bool raw = view.dtype == DType::kUINT8;
+    if (raw && (!acceptsRaw || isOutput || dims.size() != 3)) {
+        TRTLog(ERROR) << "Blob " << blob << " only accepts float tensors";
+        return false;
+    }
+
+    bool valid = view.shape.size() == dims.size() + 1 && view.strides.size() == view.shape.size();
+    for (int i = 0; valid && i < (int)dims.size(); ++i) {
+        // Raw images are interleaved, i.e. [N, H, W, C] for a blob of [C, H, W]
+        int dim = raw ? dims.at((i + 1) % 3) : dims.at(i);
+        valid = view.shape.at(i + 1) == dim;
+    }
+    if (!valid) {
+        TRTLog(ERROR) << "Tensor " << view << " does not match the dims of blob " << blob;
+        return false;
+    }
+
+    if (view.shape.at(0) <= 0 || view.shape.at(0) > maxBatchSize) {
+        TRTLog(ERROR) << "Batch size " << view.shape.at(0) << " of blob " << blob
+                      << " is not within the max batch size " << maxBatchSize;
+        return false;
+    }
+
+    if (isOutput && view.hasOverlap()) {
+        TRTLog(ERROR) << "Tensor " << view << " of output blob " << blob << " has overlapping elements";
+        return false;
+    }
+    return true;
+}
+
+std::vector<Copy2D> planStridedCopy(const TensorView &view)
+{
+    std::vector<Copy2D> plan;
+    if (view.numElements() == 0 || view.strides.size() != view.shape.size())
+        return plan;
+
+    /* Merge the trailing contiguous dimensions into one row. Dimensions of
+     * size 1 never break contiguity whatever their stride is. */
+    int d = (int)view.shape.size() - 1;
+    size_t width = sizeOf(view.dtype);
+    while (d >= 0 && (view.shape.at(d) == 1 || view.strides.at(d) == width)) {
+        width *= view.shape.at(d);
+        --d;
+    }
+
+    size_t height = 1, pitch = width;
+    if (d >= 0) {
+        height = view.shape.at(d);
+        pitch = view.strides.at(d);
+        --d;
+    }
+
+    // Enumerate the remaining outer dimensions in row-major order
+    const int nbOuter = d + 1;
+    std::vector<int> idx(nbOuter, 0);
+    size_t packedOffset = 0;
+    while (true) {
+        size_t viewOffset = 0;
+        for (int i = 0; i < nbOuter; ++i)
+            viewOffset += idx.at(i) * view.strides.at(i);
+
+        Copy2D copy;
+        copy.viewOffset = viewOffset;
+        copy.packedOffset = packedOffset;
+        copy.width = width;
+        copy.height = height;
+        copy.viewPitch = pitch;
+        plan.push_back(copy);
+        packedOffset += width * height;
+
+        int i = nbOuter - 1;
+        while (i >= 0 && ++idx.at(i) == view.shape.at(i))
+            idx.at(i--) = 0;
+        if (i < 0)
+            break;
+    }
+    return plan;
+}
+
+bool copyToDevice(void *devicePtr, const TensorView &src)
+{
+    const char *host = static_cast<const char*>(src.data);
+    char *device = static_cast<char*>(devicePtr);
+
+    for (const Copy2D &c : planStridedCopy(src)) {
+        cudaError_t err = cudaMemcpy2D(device + c.packedOffset, c.width,
+                                       host + c.viewOffset, c.viewPitch,
+                                       c.width, c.height, cudaMemcpyHostToDevice);
+        if (err != cudaSuccess) {
+            TRTLog(ERROR) << "Strided copy to device failed: " << cudaGetErrorString(err);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool copyFromDevice(const TensorView &dst, const void *devicePtr)
+{
+    char *host = static_cast<char*>(dst.data);
+    const char *device = static_cast<const char*>(devicePtr);
+
+    for (const Copy2D &c : planStridedCopy(dst)) {
+        cudaError_t err = cudaMemcpy2D(host + c.viewOffset, c.viewPitch,
+                                       device + c.packedOffset, c.width,
+                                       c.width, c.height, cudaMemcpyDeviceToHost);
+        if (err != cudaSuccess) {
+            TRTLog(ERROR) << "Strided copy from device failed: " << cudaGetErrorString(err);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::ostream& operator<< (std::ostream &os, const TensorView &view)
+{
+    os << "[";
+    for (int i = 0; i < (int)view.shape.size(); ++i)
+        os << (i ? ", " : "") << view.shape.at(i);
+    os << "] strides [";
+    for (int i = 0; i < (int)view.strides.size(); ++i)
+        os << (i ? ", " : "") << view.strides.at(i);
+    os << "]";
+    return os;
+}
+
+} // namespace trt
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <iostream>
+
+namespace trt {
+
+/**
+ * @brief Element type of a TensorView.
+ */
+enum class DType
+{
+    kFLOAT,
+    kUINT8
+};
+
+size_t sizeOf(DType dtype);
+
+/**
+ * @brief Lightweight non-owning view of a host tensor.
+ *
+ *        The first dimension is the batch, the remaining ones must match
+ *        the dims of the IOBlob it is bound to, e.g. [N, C, H, W]. Strides
+ *        are in bytes like numpy, so pitched images, ROIs inside a larger
+ *        frame and interleaved batches can be described without copying:
+ *
+ *        // Batch of 4 images whose rows are padded to a 512-byte pitch
+ *        trt::TensorView view(ptr, {4, 3, 227, 227},
+ *                             {3 * 227 * 512, 227 * 512, 512, 4});
+ */
+struct TensorView
+{
+    TensorView() = default;
+
+    /**
+     * @brief View over a contiguous (row-major) tensor.
+     */
+    TensorView(void *data, const std::vector<int> &shape, DType dtype = DType::kFLOAT);
+
+    /**
+     * @brief View over a strided tensor. Strides are in bytes.
+     */
+    TensorView(void *data, const std::vector<int> &shape, const std::vector<size_t> &strides,
+               DType dtype = DType::kFLOAT);
+
+    bool isContiguous() const;
+
+    /**
+     * @brief True if two elements share bytes, e.g. a broadcast with a
+     *        zero stride. Such views can be read but not written.
+     */
+    bool hasOverlap() const;
+    size_t numElements() const;
+    size_t numBytes() const; // Bytes of the tensor when packed contiguously
+
+    void *data = nullptr;
+    std::vector<int> shape;
+    std::vector<size_t> strides;
+    DType dtype = DType::kFLOAT;
+};
+
+/**
+ * @brief Check a view against the dims of the blob it is bound to, i.e.
+ *        [N, dims...] with 0 < N <= maxBatchSize. A uint8 view is only
+ *        valid if the blob accepts raw images, as [N, H, W, C] of a blob
+ *        of [C, H, W]. Output views must not overlap.
+ */
+bool validateView(const TensorView &view, const std::string &blob, const std::vector<int> &dims,
+                  int maxBatchSize, bool isOutput, bool acceptsRaw = false);
+
+/**
+ * @brief One 2D copy between a strided view and a packed buffer,
+ *        in the argument order of cudaMemcpy2D.
+ */
+struct Copy2D
+{
+    size_t viewOffset;   // Byte offset into the strided view
+    size_t packedOffset; // Byte offset into the packed buffer
+    size_t width;        // Bytes per row
+    size_t height;       // Number of rows
+    size_t viewPitch;    // Bytes between rows in the view
+};
+
+/**
+ * @brief Decompose the transfer of a strided view into the minimum number
+ *        of 2D copies.
+ *
+ *        Trailing dimensions which are contiguous are merged into the row
+ *        width, the next dimension becomes the row count and the remaining
+ *        outer dimensions are enumerated. A contiguous view yields a single
+ *        copy with height 1.
+ */
+std::vector<Copy2D> planStridedCopy(const TensorView &view);
+
+/**
+ * @brief Gather a strided host view into a packed device buffer.
+ */
+bool copyToDevice(void *devicePtr, const TensorView &src);
+
+/**
+ * @brief Scatter a packed device buffer into a strided host view.
+ */
+bool copyFromDevice(const TensorView &dst, const void *devicePtr);
+
+/**
+ * @brief Helper ostream function for TensorView shapes and strides.
+ */
+std::ostream& operator<< (std::ostream &os, const TensorView &view);
+
+} // namespace trt
@@ -0,0 +1,441 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <sstream>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local int currentIndex = -1;
+
+bool parseCpuList(const std::string &list, std::vector<int> &cpus)
+{
+    cpus.clear();
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty())
+            continue;
+
+        char *end = nullptr;
+        long first = std::strtol(range.c_str(), &end, 10);
+        long last = first;
+        if (*end == '-')
+            last = std::strtol(end + 1, &end, 10);
+        if (*end != '\0' || first < 0 || last < first)
+            return false;
+        for (long cpu = first; cpu <= last; ++cpu)
+            cpus.push_back((int)cpu);
+    }
+    return !cpus.empty();
+}
+
+static std::vector<int> onlineCpus()
+{
+    std::vector<int> cpus;
+    std::ifstream file("/sys/devices/system/cpu/online");
+    std::string list;
+    if (std::getline(file, list) && parseCpuList(list, cpus))
+        return cpus;
+
+    cpus.clear();
+    for (int cpu = 0; cpu < (int)std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+        cpus.push_back(cpu);
+    return cpus;
+}
+
+static std::vector<int> allowedCpus()
+{
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+    }
+    return cpus.empty() ? onlineCpus() : cpus;
+}
+
+NumaTopology NumaTopology::detect()
+{
+    NumaTopology topology;
+    if (DIR *dir = opendir("/sys/devices/system/node")) {
+        while (struct dirent *entry = readdir(dir)) {
+            int node = 0;
+            char suffix = 0;
+            if (std::sscanf(entry->d_name, "node%d%c", &node, &suffix) != 1 || node < 0)
+                continue;
+
+            std::ifstream file(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist");
+            std::string list;
+            std::vector<int> cpus;
+            if (!std::getline(file, list) || !parseCpuList(list, cpus))
+                continue; // Memory-only node
+
+            if ((int)topology.nodeCpus.size() <= node)
+                topology.nodeCpus.resize(node + 1);
+            topology.nodeCpus.at(node) = cpus;
+        }
+        closedir(dir);
+    }
+
+    if (topology.nodeCpus.empty())
+        topology.nodeCpus.push_back(onlineCpus());
+    return topology;
+}
+
+int NumaTopology::nodeOf(int cpu) const
+{
+    for (int node = 0; node < (int)nodeCpus.size(); ++node) {
+        const std::vector<int> &cpus = nodeCpus.at(node);
+        if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end())
+            return node;
+    }
+    return -1;
+}
+
+int NumaTopology::numNodes() const
+{
+    return (int)nodeCpus.size();
+}
+
+/* The global instance is created on first use with the options set
+ * before, if any. */
+static std::mutex globalMtx;
+static std::unique_ptr<ThreadPoolOptions> globalOptions;
+static std::unique_ptr<ThreadPool> globalPool;
+
+ThreadPool& ThreadPool::globalInstance()
+{
+    std::lock_guard<std::mutex> locker(globalMtx);
+    if (!globalPool)
+        globalPool.reset(new ThreadPool(globalOptions ? *globalOptions : ThreadPoolOptions()));
+    return *globalPool;
+}
+
+bool ThreadPool::setGlobalOptions(const ThreadPoolOptions &options)
+{
+    std::lock_guard<std::mutex> locker(globalMtx);
+    if (globalPool) {
+        TRTLog(ERROR) << "The global thread pool is already running, set its options before any stage runs";
+        return false;
+    }
+    globalOptions.reset(new ThreadPoolOptions(options));
+    return true;
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions &options)
+    : topology(NumaTopology::detect())
+{
+    std::vector<int> cpus = options.cpus.empty() ? allowedCpus() : options.cpus;
+    std::stable_sort(cpus.begin(), cpus.end(), [this](int lhs, int rhs) {
+        return topology.nodeOf(lhs) < topology.nodeOf(rhs);
+    });
+
+    numThreads = options.numThreads > 0 ? options.numThreads : (int)cpus.size();
+    for (int node = 0; node < topology.numNodes(); ++node)
+        pendingNode.emplace_back(new std::atomic<int>(0));
+
+    // The caller of parallelFor is one of the threads, the others are workers
+    const int numWorkers = numThreads - 1;
+    for (int w = 0; w < numWorkers; ++w) {
+        std::unique_ptr<Worker> worker(new Worker);
+        const int cpu = cpus.at((size_t)w * cpus.size() / numWorkers);
+        if (options.affinity == Affinity::kCORES) {
+            worker->cpus = {cpu};
+            worker->node = topology.nodeOf(cpu);
+        } else if (options.affinity == Affinity::kNODES) {
+            worker->node = topology.nodeOf(cpu);
+            for (int other : cpus)
+                if (topology.nodeOf(other) == worker->node)
+                    worker->cpus.push_back(other);
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    for (int w = 0; w < numWorkers; ++w) {
+        std::vector<int> &victims = workers.at(w)->victims;
+        for (int local = 1; local >= 0; --local) {
+            for (int i = 1; i < numWorkers; ++i) {
+                int v = (w + i) % numWorkers;
+                if ((workers.at(v)->node == workers.at(w)->node) == (bool)local)
+                    victims.push_back(v);
+            }
+        }
+    }
+
+    for (int w = 0; w < numWorkers; ++w)
+        workers.at(w)->thread = std::thread(&ThreadPool::run, this, w);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> locker(sleepMtx);
+        stop = true;
+    }
+    wake.notify_all();
+
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->thread.join();
+}
+
+/**
+ * @brief Run a submitted task. Nobody waits for it, so its exception ends
+ *        here instead of terminating the worker.
+ */
+static void runTask(const std::function<void()> &task)
+{
+    try {
+        task();
+    } catch (const std::exception &e) {
+        TRTLog(ERROR) << "A task of the thread pool failed: " << e.what();
+    } catch (...) {
+        TRTLog(ERROR) << "A task of the thread pool failed";
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task, int node)
+{
+    if (workers.empty()) {
+        runTask(task);
+        return;
+    }
+
+    int target = -1;
+    const int self = currentWorker();
+    if (node < 0) {
+        target = self >= 0 ? self : (int)(nextWorker++ % workers.size());
+    } else {
+        std::vector<int> candidates;
+        for (int w = 0; w < (int)workers.size(); ++w)
+            if (workers.at(w)->node == node)
+                candidates.push_back(w);
+        if (candidates.empty()) {
+            runTask(task);
+            return;
+        }
+        target = std::find(candidates.begin(), candidates.end(), self) != candidates.end()
+               ? self : candidates.at(nextWorker++ % candidates.size());
+    }
+
+    {
+        Worker &worker = *workers.at(target);
+        std::lock_guard<std::mutex> locker(worker.mtx);
+        worker.tasks.push_back({std::move(task), node});
+        ++(node < 0 ? pendingAny : *pendingNode.at(node));
+    }
+
+    // Synchronize with the predicate of the sleeping workers
+    { std::lock_guard<std::mutex> locker(sleepMtx); }
+    if (node < 0)
+        wake.notify_one();
+    else
+        wake.notify_all();
+}
+
+void ThreadPool::parallelFor(int begin, int end, const std::function<void(int)> &body)
+{
+    const int count = end - begin;
+    if (count <= 0)
+        return;
+    if (count == 1 || workers.empty()) {
+        for (int i = begin; i < end; ++i)
+            body(i);
+        return;
+    }
+
+    /* Helpers which start after the loop is finished find no index left,
+     * so they never touch the body of a returned parallelFor. The caller
+     * waits for every index taken even if one throws, and the indices
+     * left after a failure are skipped but still counted as done. */
+    struct Loop
+    {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::atomic<bool> failed{false};
+        int end = 0;
+        int count = 0;
+        const std::function<void(int)> *body = nullptr;
+        std::exception_ptr error; // The first exception thrown by the body
+        std::mutex mtx;
+        std::condition_variable finished;
+    };
+
+    std::shared_ptr<Loop> loop = std::make_shared<Loop>();
+    loop->next = begin;
+    loop->end = end;
+    loop->count = count;
+    loop->body = &body;
+
+    std::function<void()> work = [loop]() {
+        int i;
+        while ((i = loop->next.fetch_add(1)) < loop->end) {
+            if (!loop->failed.load()) {
+                try {
+                    (*loop->body)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> locker(loop->mtx);
+                    if (!loop->error)
+                        loop->error = std::current_exception();
+                    loop->failed = true;
+                }
+            }
+            if (loop->done.fetch_add(1) + 1 == loop->count) {
+                std::lock_guard<std::mutex> locker(loop->mtx);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    const int helpers = std::min(count - 1, (int)workers.size());
+    for (int h = 0; h < helpers; ++h)
+        submit(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(loop->mtx);
+    loop->finished.wait(lock, [&]() { return loop->done.load() == count; });
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
+
+void* ThreadPool::allocateOnNode(size_t bytes, int node)
+{
+    void *ptr = nullptr;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (posix_memalign(&ptr, page, std::max(bytes, (size_t)1)) != 0) {
+        TRTLog(ERROR) << "Cannot allocate " << bytes << " bytes for NUMA node " << node;
+        return nullptr;
+    }
+
+    const int self = currentWorker();
+    bool pinned = false;
+    for (const std::unique_ptr<Worker> &worker : workers)
+        pinned |= worker->node == node;
+
+    if (!pinned || (self >= 0 && workers.at(self)->node == node)) {
+        std::memset(ptr, 0, bytes);
+        return ptr;
+    }
+
+    std::promise<void> touched;
+    std::future<void> done = touched.get_future();
+    submit([&]() {
+        std::memset(ptr, 0, bytes);
+        touched.set_value();
+    }, node);
+    done.wait();
+    return ptr;
+}
+
+int ThreadPool::currentWorker() const
+{
+    return currentPool == this ? currentIndex : -1;
+}
+
+int ThreadPool::getNumThreads() const
+{
+    return numThreads;
+}
+
+int ThreadPool::getNumWorkers() const
+{
+    return (int)workers.size();
+}
+
+int ThreadPool::getWorkerNode(int worker) const
+{
+    return workers.at(worker)->node;
+}
+
+const NumaTopology& ThreadPool::getTopology() const
+{
+    return topology;
+}
+
+void ThreadPool::run(int index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    Worker &self = *workers.at(index);
+    if (!self.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : self.cpus)
+            CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            TRTLog(WARN) << "Cannot pin worker " << index << " to CPU " << self.cpus.front()
+                         << (self.cpus.size() > 1 ? " and its node" : "");
+    }
+
+    Task task;
+    for (;;) {
+        if (pop(index, task) || steal(index, task)) {
+            runTask(task.fn);
+            task.fn = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMtx);
+        wake.wait(lock, [&]() { return stop || hasWork(self.node); });
+        if (stop && !hasWork(self.node))
+            return;
+    }
+}
+
+bool ThreadPool::pop(int index, Task &task)
+{
+    Worker &self = *workers.at(index);
+    std::lock_guard<std::mutex> locker(self.mtx);
+    if (self.tasks.empty())
+        return false;
+
+    task = std::move(self.tasks.back());
+    self.tasks.pop_back();
+    --(task.node < 0 ? pendingAny : *pendingNode.at(task.node));
+    return true;
+}
+
+bool ThreadPool::steal(int index, Task &task)
+{
+    const int node = workers.at(index)->node;
+    for (int v : workers.at(index)->victims) {
+        Worker &victim = *workers.at(v);
+        std::lock_guard<std::mutex> locker(victim.mtx);
+
+        typedef std::deque<Task>::iterator it_t;
+        for (it_t it = victim.tasks.begin(); it != victim.tasks.end(); ++it) {
+            if (it->node >= 0 && it->node != node)
+                continue;
+            task = std::move(*it);
+            victim.tasks.erase(it);
+            --(task.node < 0 ? pendingAny : *pendingNode.at(task.node));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::hasWork(int node) const
+{
+    return pendingAny.load() > 0 || (node >= 0 && pendingNode.at(node)->load() > 0);
+}
+
+} // namespace trt
@@ -0,0 +1,171 @@
+#pragma once
+
+/**
+ * This file implements the executor of the CPU-side stages of the library
+ * (preprocessing, batching and postprocessing): a work-stealing thread pool
+ * whose workers can be pinned to cores or NUMA nodes, so that they keep
+ * their caches and their memory local on multi-socket hosts.
+ */
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+namespace trt {
+
+/**
+ * @brief Parse a Linux CPU list, e.g. "0-3,8,10-11".
+ */
+bool parseCpuList(const std::string &list, std::vector<int> &cpus);
+
+/**
+ * @brief CPUs of each NUMA node of the host.
+ */
+struct NumaTopology
+{
+    std::vector< std::vector<int> > nodeCpus;
+
+    /**
+     * @brief Read the topology from /sys/devices/system/node. A single
+     *        node holding every online CPU if it is not available.
+     */
+    static NumaTopology detect();
+
+    /**
+     * @return node     The node of the CPU, -1 if unknown.
+     */
+    int nodeOf(int cpu) const;
+    int numNodes() const;
+};
+
+/**
+ * @brief Pinning of the workers.
+ */
+enum class Affinity
+{
+    kNONE,  // Let the OS schedule the workers anywhere
+    kCORES, // Each worker on one CPU, spread evenly over the nodes
+    kNODES  // Each worker on every CPU of its node
+};
+
+struct ThreadPoolOptions
+{
+    int numThreads = 0;                 // Threads running a parallelFor, the caller included. 0 for one per CPU
+    Affinity affinity = Affinity::kNONE;
+    std::vector<int> cpus;              // CPUs to run on, empty for every CPU allowed to the process
+};
+
+/**
+ * @brief Work-stealing thread pool.
+ *
+ *        Each worker owns a deque of tasks: it pops its newest task first
+ *        and, when idle, steals the oldest task of another worker, trying
+ *        the workers of its own NUMA node before the remote ones. Tasks
+ *        submitted from a worker go to its own deque, so nested parallel
+ *        loops stay on the same worker as long as nobody is idle.
+ *
+ *        The library stages run on globalInstance(). For resource saving
+ *        purpose, we use a global singleton like the Logger does.
+ */
+class ThreadPool
+{
+public:
+    static ThreadPool& globalInstance();
+
+    /**
+     * @brief Configure the global instance. Must be called before any
+     *        stage runs, the global instance is created on first use.
+     * @return success  False if the global instance already exists.
+     */
+    static bool setGlobalOptions(const ThreadPoolOptions &options);
+
+    explicit ThreadPool(const ThreadPoolOptions &options = ThreadPoolOptions());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    /**
+     * @brief Run a task asynchronously. An exception thrown by the task
+     *        is logged and dropped, it never terminates the worker.
+     * @param node  Only run it on a worker of that node, -1 for any. The
+     *              task runs inline if no worker is pinned to the node.
+     */
+    void submit(std::function<void()> task, int node = -1);
+
+    /**
+     * @brief Run body(i) for every i in [begin, end) and wait for all of
+     *        them. The calling thread takes part, so a parallelFor may be
+     *        nested in another one. Indices are handed out one at a time,
+     *        which balances iterations of uneven cost.
+     *
+     *        If body throws, no further index is started and the first
+     *        exception is rethrown to the caller once the running
+     *        iterations are finished.
+     */
+    void parallelFor(int begin, int end, const std::function<void(int)> &body);
+
+    /**
+     * @brief Allocate memory whose pages are first touched, i.e. placed,
+     *        on a NUMA node, by a worker pinned to it. The memory is
+     *        zeroed, page aligned and freed with std::free.
+     * @return ptr  nullptr on failure.
+     */
+    void* allocateOnNode(size_t bytes, int node);
+
+    /**
+     * @return worker   Index of the calling thread among the workers of
+     *                  this pool, -1 if it is not one of them.
+     */
+    int currentWorker() const;
+
+    int getNumThreads() const;
+    int getNumWorkers() const;
+
+    /**
+     * @return node     The node the worker is pinned to, -1 if not pinned.
+     */
+    int getWorkerNode(int worker) const;
+    const NumaTopology& getTopology() const;
+
+protected:
+    struct Task
+    {
+        std::function<void()> fn;
+        int node;
+    };
+
+    struct Worker
+    {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+        std::vector<int> cpus;      // Affinity, empty if not pinned
+        int node = -1;
+        std::vector<int> victims;   // Steal order, local node first
+        std::thread thread;
+    };
+
+    void run(int index);
+    bool pop(int index, Task &task);
+    bool steal(int index, Task &task);
+    bool hasWork(int node) const;
+
+    NumaTopology topology;
+    int numThreads = 1;
+    std::vector< std::unique_ptr<Worker> > workers;
+
+    std::mutex sleepMtx;
+    std::condition_variable wake;
+    std::atomic<int> pendingAny{0};
+    std::vector< std::unique_ptr< std::atomic<int> > > pendingNode;
+    std::atomic<unsigned> nextWorker{0};
+    bool stop = false;
+};
+
+} // namespace trt
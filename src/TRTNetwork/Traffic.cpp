@@ -0,0 +1,391 @@
+#include "Traffic.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <map>
+
+#include "TRTNetwork.hpp"
+#include "Logger.hpp"
+
+namespace trt {
+
+typedef std::chrono::steady_clock Clock;
+
+static const char traceMagic[8] = {'T', 'R', 'T', 'T', 'R', 'C', 'E', '1'};
+
+/** @note Sanity bound against reading garbage as a huge length. */
+static const uint32_t MAX_TRACE_FIELD = 1u << 30;
+
+template <typename T>
+static void writeValue(std::ofstream &file, T value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool readValue(std::ifstream &file, T &value)
+{
+    return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+static void writeString(std::ofstream &file, const std::string &str)
+{
+    writeValue(file, (uint32_t)str.size());
+    file.write(str.data(), str.size());
+}
+
+static bool readString(std::ifstream &file, std::string &str)
+{
+    uint32_t len = 0;
+    if (!readValue(file, len) || len > MAX_TRACE_FIELD)
+        return false;
+    str.resize(len);
+    return len == 0 || (bool)file.read(&str[0], len);
+}
+
+static size_t volumeOf(const std::vector<int> &shape)
+{
+    size_t vol = 1;
+    for (int d : shape)
+        vol *= d;
+    return vol;
+}
+
+TrafficRecorder::TrafficRecorder(const std::string &path, bool captureInputs)
+    : file(path.c_str(), std::ios::binary),
+      origin(Clock::now()),
+      captureInputs(captureInputs)
+{
+    if (!file) {
+        TRTLog(ERROR) << "Unable to write trace file " << path;
+        return;
+    }
+    file.write(traceMagic, sizeof(traceMagic));
+}
+
+TrafficRecorder::~TrafficRecorder()
+{
+    flush();
+}
+
+bool TrafficRecorder::isOpen() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return (bool)file;
+}
+
+void TrafficRecorder::record(const TRTNetwork &network, int batchSize,
+                             const std::vector< std::pair<std::string, void*> > &feedDict,
+                             Clock::time_point start, Clock::time_point end, bool success)
+{
+    TraceRecord rec;
+    rec.model = network.getName();
+    rec.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count();
+    rec.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    rec.batchSize = batchSize;
+    rec.success = success;
+
+    const std::vector<std::string> &outputs = network.getOutputBlobNames();
+    for (const std::pair<std::string, void*> &kv : feedDict) {
+        TraceTensor tensor;
+        tensor.name = kv.first;
+        tensor.isOutput = std::find(outputs.begin(), outputs.end(), kv.first) != outputs.end();
+        tensor.shape = network.getBlobShape(kv.first);
+        tensor.shape.insert(tensor.shape.begin(), batchSize);
+
+        if (captureInputs && !tensor.isOutput && kv.second) {
+            const char *data = static_cast<const char*>(kv.second);
+            tensor.data.assign(data, data + volumeOf(tensor.shape) * sizeof(float));
+        }
+        rec.tensors.push_back(tensor);
+    }
+
+    record(rec);
+}
+
+/**
+ * @brief Pack an input view into the floats the host pointer call takes,
+ *        casting raw [N, H, W, C] images to planar [N, C, H, W].
+ */
+static void captureView(const TensorView &view, const std::vector<int> &shape, std::vector<char> &data)
+{
+    std::vector<Copy2D> plan = planStridedCopy(view);
+    if (plan.empty() || view.numElements() != volumeOf(shape))
+        return;
+
+    std::vector<char> packed(view.numBytes());
+    const char *src = static_cast<const char*>(view.data);
+    for (const Copy2D &c : plan)
+        for (size_t row = 0; row < c.height; ++row)
+            std::memcpy(packed.data() + c.packedOffset + row * c.width, src + c.viewOffset + row * c.viewPitch,
+                        c.width);
+
+    if (view.dtype == DType::kFLOAT) {
+        data.swap(packed);
+        return;
+    }
+    if (shape.size() != 4)
+        return;
+
+    const int N = shape.at(0), C = shape.at(1), H = shape.at(2), W = shape.at(3);
+    std::vector<float> planar(packed.size());
+    for (int n = 0; n < N; ++n)
+        for (int c = 0; c < C; ++c)
+            for (int y = 0; y < H; ++y)
+                for (int x = 0; x < W; ++x)
+                    planar[((n * C + c) * H + y) * W + x] = (uint8_t)packed[((n * H + y) * W + x) * C + c];
+
+    const char *bytes = reinterpret_cast<const char*>(planar.data());
+    data.assign(bytes, bytes + planar.size() * sizeof(float));
+}
+
+void TrafficRecorder::record(const TRTNetwork &network,
+                             const std::vector< std::pair<std::string, TensorView> > &feedDict,
+                             Clock::time_point start, Clock::time_point end, bool success)
+{
+    TraceRecord rec;
+    rec.model = network.getName();
+    rec.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count();
+    rec.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    rec.batchSize = feedDict.empty() || feedDict.front().second.shape.empty() ? 0
+                  : feedDict.front().second.shape.at(0);
+    rec.success = success;
+
+    const std::vector<std::string> &outputs = network.getOutputBlobNames();
+    for (const std::pair<std::string, TensorView> &kv : feedDict) {
+        TraceTensor tensor;
+        tensor.name = kv.first;
+        tensor.isOutput = std::find(outputs.begin(), outputs.end(), kv.first) != outputs.end();
+        tensor.shape = network.getBlobShape(kv.first);
+        tensor.shape.insert(tensor.shape.begin(), rec.batchSize);
+
+        if (captureInputs && !tensor.isOutput && kv.second.data)
+            captureView(kv.second, tensor.shape, tensor.data);
+        rec.tensors.push_back(tensor);
+    }
+
+    record(rec);
+}
+
+void TrafficRecorder::record(const TraceRecord &rec)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (!file)
+        return;
+
+    writeString(file, rec.model);
+    writeValue(file, (int64_t)rec.startNs);
+    writeValue(file, (int64_t)rec.durationNs);
+    writeValue(file, (int32_t)rec.batchSize);
+    writeValue(file, (uint8_t)rec.success);
+    writeValue(file, (uint8_t)rec.tensors.size());
+
+    for (const TraceTensor &tensor : rec.tensors) {
+        writeString(file, tensor.name);
+        writeValue(file, (uint8_t)tensor.isOutput);
+        writeValue(file, (uint8_t)tensor.shape.size());
+        for (int d : tensor.shape)
+            writeValue(file, (int32_t)d);
+        writeValue(file, (uint32_t)tensor.data.size());
+        file.write(tensor.data.data(), tensor.data.size());
+    }
+    ++numRecords;
+}
+
+void TrafficRecorder::flush()
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    if (file)
+        file.flush();
+}
+
+size_t TrafficRecorder::getNumRecords() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return numRecords;
+}
+
+bool readTrace(const std::string &path, std::vector<TraceRecord> &records)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        TRTLog(ERROR) << "Unable to open trace file " << path;
+        return false;
+    }
+
+    char magic[sizeof(traceMagic)];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, traceMagic, sizeof(magic))) {
+        TRTLog(ERROR) << "Malformed trace file " << path;
+        return false;
+    }
+
+    records.clear();
+    while (file.peek() != std::ifstream::traits_type::eof()) {
+        TraceRecord rec;
+        int32_t batchSize = 0;
+        uint8_t success = 0, numTensors = 0;
+
+        bool ok = readString(file, rec.model) && readValue(file, rec.startNs) && readValue(file, rec.durationNs) &&
+                  readValue(file, batchSize) && readValue(file, success) && readValue(file, numTensors);
+        rec.batchSize = batchSize;
+        rec.success = success;
+
+        for (uint8_t t = 0; ok && t < numTensors; ++t) {
+            TraceTensor tensor;
+            uint8_t isOutput = 0, nbDims = 0;
+            uint32_t bytes = 0;
+
+            ok = readString(file, tensor.name) && readValue(file, isOutput) && readValue(file, nbDims);
+            for (uint8_t d = 0; ok && d < nbDims; ++d) {
+                int32_t dim = 0;
+                ok = readValue(file, dim) && dim >= 0;
+                tensor.shape.push_back(dim);
+            }
+            ok = ok && readValue(file, bytes) && bytes <= MAX_TRACE_FIELD;
+            if (ok && bytes) {
+                tensor.data.resize(bytes);
+                ok = (bool)file.read(tensor.data.data(), bytes);
+            }
+            tensor.isOutput = isOutput;
+            rec.tensors.push_back(tensor);
+        }
+
+        if (!ok) {
+            // A recorder killed mid-write leaves a truncated last record
+            TRTLog(WARN) << "Trace file " << path << " is truncated after " << records.size() << " records";
+            break;
+        }
+        records.push_back(rec);
+    }
+    return true;
+}
+
+std::ostream& operator<< (std::ostream &os, const ReplayResult &result)
+{
+    os << result.requests << " requests (" << result.failed << " failed, " << result.delayed << " delayed) in "
+       << result.seconds << " s, "
+       << result.requests / result.seconds << " req/s, "
+       << result.samples / result.seconds << " samples/s, latency " << result.latency
+       << ", service " << result.service;
+    return os;
+}
+
+int openLoopWorkers(const std::vector<TraceRecord> &records, double speed)
+{
+    if (speed <= 0.0)
+        speed = 1.0;
+
+    // Sweep over the arrivals and completions, completions first on ties
+    std::vector< std::pair<double, int> > events;
+    for (const TraceRecord &rec : records) {
+        const double arrival = rec.startNs / speed;
+        events.push_back(std::make_pair(arrival, 1));
+        events.push_back(std::make_pair(arrival + rec.durationNs, -1));
+    }
+    std::sort(events.begin(), events.end());
+
+    int inFlight = 0, peak = 0;
+    for (const std::pair<double, int> &event : events) {
+        inFlight += event.second;
+        peak = std::max(peak, inFlight);
+    }
+    return std::max(1, 2 * peak);
+}
+
+ReplayResult replayTrace(Executor &executor, const std::vector<TraceRecord> &records,
+                         const ReplayOptions &options)
+{
+    ReplayResult result;
+    if (records.empty())
+        return result;
+
+    const double speed = options.speed > 0.0 ? options.speed : 1.0;
+    const int numWorkers = options.numWorkers > 0 ? options.numWorkers
+                         : options.realtime ? openLoopWorkers(records, speed) : 1;
+
+    /* Records are written when their call completes, so concurrent callers
+     * leave them in completion order: issue them in arrival order. */
+    std::vector<size_t> order(records.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order.at(i) = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return records.at(lhs).startNs < records.at(rhs).startNs;
+    });
+    const int64_t firstNs = records.at(order.front()).startNs;
+
+    std::atomic<size_t> next(0);
+    std::mutex mtx;
+    std::vector<double> latencies, services;
+
+    const Clock::time_point begin = Clock::now();
+
+    auto worker = [&]() {
+        std::map<std::string, std::vector<float> > buffers; // Reused across requests
+        std::vector< std::pair<std::string, void*> > feedDict;
+        std::vector<double> workerLatencies, workerServices;
+        size_t failed = 0, samples = 0, delayed = 0;
+
+        for (size_t i = next++; i < records.size(); i = next++) {
+            const TraceRecord &rec = records.at(order.at(i));
+
+            // Prepare the buffers before the request is due
+            feedDict.clear();
+            for (const TraceTensor &tensor : rec.tensors) {
+                std::vector<float> &buffer = buffers[tensor.name];
+                size_t count = volumeOf(tensor.shape);
+                if (buffer.size() < count)
+                    buffer.resize(count);
+                if (!tensor.isOutput) {
+                    // The buffer holds the previous request, zero what the trace does not cover
+                    const size_t bytes = std::min(tensor.data.size(), count * sizeof(float));
+                    if (bytes)
+                        std::memcpy(buffer.data(), tensor.data.data(), bytes);
+                    std::fill(buffer.begin() + bytes / sizeof(float), buffer.begin() + count, 0.f);
+                }
+                feedDict.push_back(std::make_pair(tensor.name, static_cast<void*>(buffer.data())));
+            }
+
+            Clock::time_point due = begin;
+            if (options.realtime) {
+                due += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::nanoseconds((int64_t)((rec.startNs - firstNs) / speed)));
+                std::this_thread::sleep_until(due);
+            }
+
+            Clock::time_point start = Clock::now();
+            if (!options.realtime)
+                due = start;
+            delayed += start - due > std::chrono::milliseconds(1);
+            bool success = executor.execute(rec.model, rec.batchSize, feedDict);
+            Clock::time_point end = Clock::now();
+
+            failed += !success;
+            samples += rec.batchSize;
+            workerLatencies.push_back(std::chrono::duration<double, std::milli>(end - due).count());
+            workerServices.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::lock_guard<std::mutex> locker(mtx);
+        result.failed += failed;
+        result.samples += samples;
+        result.delayed += delayed;
+        latencies.insert(latencies.end(), workerLatencies.begin(), workerLatencies.end());
+        services.insert(services.end(), workerServices.begin(), workerServices.end());
+    };
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < numWorkers; ++w)
+        workers.emplace_back(worker);
+    for (std::thread &t : workers)
+        t.join();
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    result.requests = records.size();
+    result.latency = summarizeLatencies(latencies);
+    result.service = summarizeLatencies(services);
+    return result;
+}
+
+} // namespace trt
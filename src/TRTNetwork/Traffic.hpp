@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ * This file implements the capture and the replay of inference traffic:
+ * a compact binary trace of the calls of TRTNetwork::forward (timing,
+ * batch size, tensor shapes and optionally the input tensors), and a
+ * replayer which drives an Executor with the recorded request mix.
+ */
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+
+#include "Executor.hpp"
+#include "Latency.hpp"
+#include "TensorView.hpp"
+
+namespace trt {
+
+class TRTNetwork;
+
+struct TraceTensor
+{
+    std::string name;
+    bool isOutput = false;
+    std::vector<int> shape;     // Including the batch dimension
+    std::vector<char> data;     // Captured inputs only, empty otherwise
+};
+
+/**
+ * @brief One recorded call.
+ */
+struct TraceRecord
+{
+    std::string model;
+    int64_t startNs = 0;        // Since the recorder was created
+    int64_t durationNs = 0;
+    int batchSize = 0;
+    bool success = false;
+    std::vector<TraceTensor> tensors;
+};
+
+/**
+ * @brief Writes a trace of inference calls to a file.
+ *
+ *        trt::TrafficRecorder recorder("/tmp/caffenet.trace");
+ *        network.setRecorder(&recorder);
+ *        ...
+ *        network.setRecorder(nullptr);
+ *
+ *        The recorder is thread-safe and can be shared by several
+ *        networks. Capturing the inputs makes the replay use real data,
+ *        at the cost of a copy of every input per call.
+ *
+ *        The calls with host pointers and with TensorViews are recorded.
+ *        The overload with device pointers and a stream is not: it only
+ *        enqueues the work, so neither its duration nor its inputs are
+ *        known without synchronizing the stream of the caller.
+ */
+class TrafficRecorder
+{
+public:
+    explicit TrafficRecorder(const std::string &path, bool captureInputs = false);
+
+    TrafficRecorder(const TrafficRecorder& other) = delete;
+    TrafficRecorder& operator= (const TrafficRecorder& other) = delete;
+
+    ~TrafficRecorder();
+
+    bool isOpen() const;
+
+    /**
+     * @brief Record a call of TRTNetwork::forward with host pointers.
+     */
+    void record(const TRTNetwork &network, int batchSize,
+                const std::vector< std::pair<std::string, void*> > &feedDict,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end, bool success);
+
+    /**
+     * @brief Record a call of TRTNetwork::forward with TensorViews. The
+     *        inputs are captured packed like the host pointer call takes
+     *        them, raw [N, H, W, C] images as planar [N, C, H, W] floats.
+     */
+    void record(const TRTNetwork &network, const std::vector< std::pair<std::string, TensorView> > &feedDict,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end, bool success);
+
+    void record(const TraceRecord &record);
+    void flush();
+
+    size_t getNumRecords() const;
+
+protected:
+    mutable std::mutex mtx;
+    std::ofstream file;
+    const std::chrono::steady_clock::time_point origin;
+    const bool captureInputs;
+    size_t numRecords = 0;
+};
+
+/**
+ * @brief Read a whole trace written by a TrafficRecorder. The records are
+ *        in the order their calls completed, which differs from the order
+ *        of their startNs with concurrent callers. A truncated last record,
+ *        as left by a killed recorder, is dropped with a warning.
+ */
+bool readTrace(const std::string &path, std::vector<TraceRecord> &records);
+
+/**
+ * @brief Workers for an open-loop replay of a trace: twice the peak number
+ *        of recorded requests in flight at the given speed, at least 1.
+ */
+int openLoopWorkers(const std::vector<TraceRecord> &records, double speed = 1.0);
+
+struct ReplayOptions
+{
+    bool realtime = true;   // Keep the recorded inter-arrival times, else as fast as possible
+    double speed = 1.0;     // Time scale of the realtime replay, 2 replays twice as fast
+    int numWorkers = 0;     // Requests in flight, 0 for openLoopWorkers() in realtime and 1 otherwise
+};
+
+struct ReplayResult
+{
+    size_t requests = 0;
+    size_t failed = 0;
+    size_t samples = 0;     // Sum of the batch sizes
+    size_t delayed = 0;     // Issued more than 1 ms late because every worker was busy
+    double seconds = 0.0;
+    LatencyStats latency;   // From the scheduled arrival to the completion
+    LatencyStats service;   // Time spent in the executor
+};
+
+std::ostream& operator<< (std::ostream &os, const ReplayResult &result);
+
+/**
+ * @brief Replay a trace against an executor, in the order of the start
+ *        times of the records. Inputs which were not captured are
+ *        zero-filled.
+ *
+ *        In realtime mode the requests are issued open-loop at their
+ *        recorded times, so a slow executor shows as queueing in the
+ *        latency instead of slowing down the arrivals. This only holds
+ *        while a worker is free: with every worker busy the next request
+ *        waits for one, i.e. the replay turns closed-loop. Such requests
+ *        are counted as delayed, their latency still starts at their
+ *        recorded time.
+ */
+ReplayResult replayTrace(Executor &executor, const std::vector<TraceRecord> &records,
+                         const ReplayOptions &options);
+
+} // namespace trt
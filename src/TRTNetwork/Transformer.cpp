@@ -1,5 +1,11 @@
 #include "Transformer.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "ThreadPool.hpp"
+
 namespace trt {
 
 /**
@@ -31,6 +37,8 @@ Transformer::Transformer()
     channel_order = {2, 1, 0};
     mean_vec = {0.f, 0.f, 0.f};
     raw_scale = 255.f;
+    num_channels_ = 0;
+    roi_border_type_ = cv::BORDER_CONSTANT;
 }
 
 bool Transformer::set_transpose(const std::vector<int> &order)
@@ -78,21 +86,25 @@ bool Transformer::set_input_shape(const std::vector<int>& shape)
     return true;
 }
 
-bool Transformer::preprocess(float *input_data, const cv::Mat &img)
+bool Transformer::set_roi_border(int border_type)
 {
-    /* Wrap the input layer of the network in separate cv::Mat objects
-     * (one per channel). This way we save one memcpy operation and we
-     * don't need to rely on cudaMemcpy2D. The last preprocessing
-     * operation will write the separate channels directly to the input
-     * layer. */
+    if (border_type != cv::BORDER_CONSTANT && border_type != cv::BORDER_REPLICATE &&
+        border_type != cv::BORDER_REFLECT)
+        return false;
+    roi_border_type_ = border_type;
+    return true;
+}
 
-    std::vector<cv::Mat> input_channels;
-    for (int i = 0; i < num_channels_; ++i) {
-        cv::Mat channel(input_geometry_, CV_32FC1, input_data + i * input_geometry_.area());
-        input_channels.push_back(channel);
-    }
+int Transformer::get_sample_size() const
+{
+    return num_channels_ * input_geometry_.area();
+}
 
-    /* Convert the input image to the input image format of the network. */
+/**
+ * @brief Convert the input image to the channel layout of the network.
+ */
+cv::Mat Transformer::convertChannels(const cv::Mat &img) const
+{
     cv::Mat sample;
     if (img.channels() == 3 && num_channels_ == 1)
         cv::cvtColor(img, sample, cv::COLOR_BGR2GRAY);
@@ -104,26 +116,158 @@ bool Transformer::preprocess(float *input_data, const cv::Mat &img)
         cv::cvtColor(img, sample, cv::COLOR_GRAY2BGR);
     else
         sample = img;
+    return sample;
+}
 
+/**
+ * @brief Resize and normalize an already converted sample into one batch slot.
+ * @param mean  Subtracted per channel, zero for an already normalized sample.
+ */
+void Transformer::writeSample(float *data_ptr, const cv::Mat &sample, const cv::Scalar &mean) const
+{
     cv::Mat sample_resized;
     if (sample.size() != input_geometry_)
         cv::resize(sample, sample_resized, input_geometry_);
     else
         sample_resized = sample;
 
-    cv::Mat sample_float;
-    if (num_channels_ == 3)
-        sample_resized.convertTo(sample_float, CV_32FC3);
+    /* Split before the float conversion so that the conversion and the
+     * mean subtraction are fused in one pass per channel. Each pass
+     * writes directly to the input layer through a cv::Mat wrapping its
+     * channel plane, so no float temporaries are needed. */
+    std::vector<cv::Mat> planes;
+    cv::split(sample_resized, planes);
+
+    for (int i = 0; i < num_channels_; ++i) {
+        cv::Mat channel(input_geometry_, CV_32FC1, data_ptr + i * input_geometry_.area());
+        planes.at(i).convertTo(channel, CV_32F, 1.0, -mean[i]);
+    }
+}
+
+bool Transformer::preprocess(float *input_data, const cv::Mat &img)
+{
+    writeSample(input_data, convertChannels(img), mean_);
+    return true;
+}
+
+bool Transformer::preprocessRaw(uint8_t *data_ptr, const cv::Mat &img)
+{
+    if (img.empty() || img.depth() != CV_8U)
+        return false;
+
+    const cv::Mat sample = convertChannels(img);
+    cv::Mat raw(input_geometry_, CV_MAKETYPE(CV_8U, num_channels_), data_ptr);
+    if (sample.size() != input_geometry_)
+        cv::resize(sample, raw, input_geometry_);
     else
-        sample_resized.convertTo(sample_float, CV_32FC1);
+        sample.copyTo(raw);
+    return true;
+}
+
+bool Transformer::preprocessROIs(float *batch_ptr, const cv::Mat &img, const std::vector<cv::Rect> &rois)
+{
+    if (img.empty())
+        return false;
+
+    /* Convert the whole frame once instead of once per box. */
+    const cv::Mat sample = convertChannels(img);
+    const cv::Rect bounds(0, 0, sample.cols, sample.rows);
+    const int sizePerBatch = num_channels_ * input_geometry_.area();
+    const int normalizedType = CV_MAKETYPE(CV_32F, sample.channels());
+
+    std::atomic<int> invalid(0);
+
+    ThreadPool::globalInstance().parallelFor(0, (int)rois.size(), [&](int n) {
+        const cv::Rect &roi = rois.at(n);
+        float *slot = batch_ptr + n * sizePerBatch;
+        if (roi.width <= 0 || roi.height <= 0) {
+            // Leave no stale data of a previous batch in the slot
+            std::fill(slot, slot + sizePerBatch, 0.f);
+            ++invalid;
+            return;
+        }
+
+        cv::Rect inside = roi & bounds;
+        const int top = inside.y - roi.y, bottom = (roi.y + roi.height) - (inside.y + inside.height);
+        const int left = inside.x - roi.x, right = (roi.x + roi.width) - (inside.x + inside.width);
+        cv::Mat crop;
+        if (inside == roi) {
+            writeSample(slot, sample(roi), mean_);
+        } else if (inside.area() == 0) {
+            // Nothing to replicate from, so the whole box is padding
+            std::fill(slot, slot + sizePerBatch, 0.f);
+        } else if (roi_border_type_ == cv::BORDER_CONSTANT) {
+            /* Pad after the mean subtraction, since a mean padded into the
+             * 8-bit image would be rounded and not normalize to zero. */
+            cv::Mat normalized;
+            sample(inside).convertTo(normalized, normalizedType);
+            cv::subtract(normalized, mean_, normalized);
+            cv::copyMakeBorder(normalized, crop, top, bottom, left, right, cv::BORDER_CONSTANT, cv::Scalar());
+            writeSample(slot, crop, cv::Scalar());
+        } else {
+            cv::copyMakeBorder(sample(inside), crop, top, bottom, left, right, roi_border_type_);
+            writeSample(slot, crop, mean_);
+        }
+    });
+
+    return invalid == 0;
+}
+
+std::vector<cv::Point> oversampleOrigins(const cv::Size &dims, const cv::Size &crop_dims)
+{
+    // caffe.io.oversample truncates the center minus half the crop, i.e. (dims - crop) / 2
+    const int x_end = dims.width - crop_dims.width, y_end = dims.height - crop_dims.height;
+    return {cv::Point(0, 0), cv::Point(x_end, 0), cv::Point(0, y_end), cv::Point(x_end, y_end),
+            cv::Point(x_end / 2, y_end / 2)};
+}
 
-    cv::Mat sample_normalized;
-    sample_normalized = sample_float - mean_;
+void copyOversampledCrops(const float *planes, int num_channels, const cv::Size &dims, const cv::Size &crop_dims,
+                          float *batch_ptr)
+{
+    const std::vector<cv::Point> origins = oversampleOrigins(dims, crop_dims);
+    const int crop_w = crop_dims.width, crop_h = crop_dims.height;
+    const int area = dims.area();
+    const int sizePerBatch = num_channels * crop_dims.area();
+
+    ThreadPool::globalInstance().parallelFor(0, OVERSAMPLE_CROPS / 2, [&](int n) {
+        float *crop = batch_ptr + n * sizePerBatch;
+        float *mirror = batch_ptr + (n + OVERSAMPLE_CROPS / 2) * sizePerBatch;
+
+        for (int i = 0; i < num_channels; ++i) {
+            for (int y = 0; y < crop_h; ++y) {
+                const float *src = planes + i * area + (origins.at(n).y + y) * dims.width + origins.at(n).x;
+                float *dst = crop + (i * crop_h + y) * crop_w;
+                std::memcpy(dst, src, crop_w * sizeof(float));
+                std::reverse_copy(src, src + crop_w, mirror + (i * crop_h + y) * crop_w);
+            }
+        }
+    });
+}
+
+bool Transformer::preprocessOversample(float *batch_ptr, const cv::Mat &img, const cv::Size &resize_dims)
+{
+    const int crop_w = input_geometry_.width, crop_h = input_geometry_.height;
+    if (img.empty() || resize_dims.width < crop_w || resize_dims.height < crop_h)
+        return false;
+
+    const cv::Mat sample = convertChannels(img);
+    cv::Mat sample_resized;
+    if (sample.size() != resize_dims)
+        cv::resize(sample, sample_resized, resize_dims);
+    else
+        sample_resized = sample;
+
+    // Normalize the whole image once into planar floats
+    const int area = resize_dims.area();
+    std::vector<float> normalized(num_channels_ * area);
+    std::vector<cv::Mat> planes;
+    cv::split(sample_resized, planes);
+    for (int i = 0; i < num_channels_; ++i) {
+        cv::Mat channel(resize_dims, CV_32FC1, normalized.data() + i * area);
+        planes.at(i).convertTo(channel, CV_32F, 1.0, -mean_[i]);
+    }
 
-    /* This operation will write the separate BGR planes directly to the
-     * input layer of the network because it is wrapped by the cv::Mat
-     * objects in input_channels. */
-    cv::split(sample_normalized, input_channels);
+    copyOversampledCrops(normalized.data(), num_channels_, resize_dims, input_geometry_, batch_ptr);
     return true;
 }
 
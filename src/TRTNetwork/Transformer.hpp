@@ -1,11 +1,31 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 
 #include "opencv2/opencv.hpp"
 
 namespace trt {
 
+/**
+ * @brief Number of crops written by Transformer::preprocessOversample.
+ */
+const int OVERSAMPLE_CROPS = 10;
+
+/**
+ * @brief Top-left corners of the crops of caffe.io.oversample in slot
+ *        order: the 4 corners of the image, then its center.
+ */
+std::vector<cv::Point> oversampleOrigins(const cv::Size &dims, const cv::Size &crop_dims);
+
+/**
+ * @brief Copy the crops at oversampleOrigins() out of planar images of
+ *        num_channels x dims into batch slots 0-4, and their horizontal
+ *        mirrors into slots 5-9.
+ */
+void copyOversampledCrops(const float *planes, int num_channels, const cv::Size &dims, const cv::Size &crop_dims,
+                          float *batch_ptr);
+
 /**
  * @brief This class serves as a helper for data transformation before
  *        feeding it into the network.
@@ -28,6 +48,12 @@ public:
     bool set_mean(const std::vector<float>& vec);
     bool set_raw_scale(float value);
     bool set_input_shape(const std::vector<int>& shape);
+    bool set_roi_border(int border_type);
+
+    /**
+     * @brief Number of floats written per sample, i.e. C * H * W.
+     */
+    int get_sample_size() const;
 
     /**
      * @brief Process data for network input. Currently only OpenCV to
@@ -39,7 +65,53 @@ public:
      */
     bool preprocess(float* data_ptr, const cv::Mat& img);
 
+    /**
+     * @brief Only resize and convert the channels of an 8-bit image into
+     *        raw interleaved pixels of H x W x C, for networks which
+     *        normalize their input in the engine (see InputNormalization).
+     *        The mean and the channel swap are not applied.
+     */
+    bool preprocessRaw(uint8_t* data_ptr, const cv::Mat& img);
+
+    /**
+     * @brief Crop and resize a list of boxes of one image into consecutive
+     *        batch slots, i.e. box n is written to batch_ptr + n * C * H * W.
+     *
+     *        The color conversion of the source image is done only once
+     *        and the boxes are processed in parallel. Boxes crossing the
+     *        image border are padded according to set_roi_border(). With
+     *        cv::BORDER_CONSTANT (default) the padding is applied after the
+     *        mean subtraction, so padded pixels are exactly zero before the
+     *        resize to the input shape.
+     *
+     *        Boxes entirely outside the image and empty boxes leave a
+     *        zero slot.
+     *
+     * @return success   False if the image or any of the boxes is empty.
+     *                   Valid boxes are still written in that case.
+     */
+    bool preprocessROIs(float* batch_ptr, const cv::Mat& img, const std::vector<cv::Rect>& rois);
+
+    /**
+     * @brief Write the oversampled crops of an image into consecutive batch
+     *        slots, the same as caffe.io.oversample: the image is resized to
+     *        resize_dims and cropped to the input shape at the 4 corners and
+     *        the center (slots 0-4), followed by the horizontal mirrors of
+     *        these crops (slots 5-9).
+     *
+     *        The image is resized and normalized only once and the crops
+     *        are copied out of the normalized planes, so the cost is close
+     *        to a single preprocess() instead of OVERSAMPLE_CROPS of them.
+     *
+     * @return success   False if the image is empty or resize_dims is
+     *                   smaller than the input shape.
+     */
+    bool preprocessOversample(float* batch_ptr, const cv::Mat& img, const cv::Size& resize_dims);
+
 private:
+    cv::Mat convertChannels(const cv::Mat& img) const;
+    void writeSample(float* data_ptr, const cv::Mat& sample, const cv::Scalar& mean) const;
+
     std::vector<int> dim_order;
     std::vector<int> channel_order;
     std::vector<float> mean_vec;
@@ -48,6 +120,7 @@ private:
     cv::Scalar mean_;
     int num_channels_;
     cv::Size input_geometry_;
+    int roi_border_type_;
 };
 
 } // namespace trt
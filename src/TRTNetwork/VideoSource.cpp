@@ -0,0 +1,260 @@
+#include "VideoSource.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+
+#include "Logger.hpp"
+
+namespace trt {
+
+FramePool::FramePool(int numBuffers)
+    : buffers(std::max(1, numBuffers)),
+      lastData(buffers.size(), nullptr)
+{
+    for (int i = (int)buffers.size() - 1; i >= 0; --i)
+        freeSlots.push_back(i);
+}
+
+int FramePool::acquire()
+{
+    if (freeSlots.empty())
+        return -1;
+    int slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+void FramePool::release(int slot)
+{
+    freeSlots.push_back(slot);
+}
+
+cv::Mat& FramePool::getBuffer(int slot)
+{
+    return buffers.at(slot);
+}
+
+void FramePool::track(int slot)
+{
+    const uchar *data = buffers.at(slot).data;
+    if (data != lastData.at(slot)) {
+        ++numAllocations;
+        lastData.at(slot) = data;
+    }
+}
+
+int FramePool::getNumBuffers() const
+{
+    return buffers.size();
+}
+
+int FramePool::getNumFree() const
+{
+    return freeSlots.size();
+}
+
+size_t FramePool::getNumAllocations() const
+{
+    return numAllocations;
+}
+
+VideoSource::VideoSource(const std::string &uri, int numBuffers, int stride, SkipPolicy policy)
+    : uri(uri),
+      stride(std::max(1, stride)),
+      policy(policy),
+      pool(numBuffers),
+      running(false)
+{
+}
+
+VideoSource::~VideoSource()
+{
+    stop();
+}
+
+/**
+ * @brief A uri made of digits only is the index of a capture device.
+ */
+static bool isDeviceIndex(const std::string &uri)
+{
+    if (uri.empty())
+        return false;
+    for (char c : uri)
+        if (!std::isdigit(static_cast<unsigned char>(c)))
+            return false;
+    return true;
+}
+
+bool VideoSource::start()
+{
+    if (running)
+        return true;
+
+    bool opened = isDeviceIndex(uri) ? capture.open(std::atoi(uri.c_str())) : capture.open(uri);
+    if (!opened || !capture.isOpened()) {
+        TRTLog(ERROR) << "Unable to open video source " << uri;
+        return false;
+    }
+
+    ended = false;
+    running = true;
+    decoder = std::thread(&VideoSource::decodeLoop, this);
+    return true;
+}
+
+void VideoSource::stop()
+{
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        running = false;
+    }
+    freeCond.notify_all();
+    readyCond.notify_all();
+    if (decoder.joinable())
+        decoder.join();
+    capture.release();
+}
+
+void VideoSource::decodeLoop()
+{
+    while (running) {
+        // Frames between the strides are grabbed without being decoded
+        bool eof = false;
+        for (int i = 1; i < stride && !eof; ++i) {
+            eof = !capture.grab();
+            if (!eof) {
+                ++position;
+                std::lock_guard<std::mutex> locker(mtx);
+                ++numSkipped;
+            }
+        }
+
+        int slot = -1;
+        if (!eof) {
+            std::unique_lock<std::mutex> lock(mtx);
+            slot = pool.acquire();
+            if (slot < 0 && policy == SkipPolicy::kDROP_OLDEST && !ready.empty()) {
+                slot = ready.front().slot;
+                ready.pop_front();
+                ++numDropped;
+            }
+            while (slot < 0 && running) {
+                freeCond.wait(lock);
+                slot = pool.acquire();
+            }
+            if (slot < 0)
+                break;
+        }
+
+        /* Decoding happens outside of the lock. The buffer is owned by
+         * this thread until it is queued, and read() reuses its memory. */
+        if (!eof)
+            eof = !capture.read(pool.getBuffer(slot));
+
+        {
+            std::lock_guard<std::mutex> locker(mtx);
+            if (eof) {
+                if (slot >= 0)
+                    pool.release(slot);
+                ended = true;
+            } else {
+                pool.track(slot);
+                Frame frame;
+                frame.slot = slot;
+                frame.index = position++;
+                frame.image = pool.getBuffer(slot);
+                ready.push_back(frame);
+                ++numDecoded;
+            }
+        }
+
+        readyCond.notify_one();
+        if (readyCallback)
+            readyCallback();
+        if (eof)
+            break;
+    }
+}
+
+bool VideoSource::popReady(Frame &frame)
+{
+    if (ready.empty())
+        return false;
+    frame = ready.front();
+    ready.pop_front();
+    return true;
+}
+
+bool VideoSource::read(Frame &frame, int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    std::function<bool()> pred = [this]() { return !ready.empty() || ended || !running; };
+    if (timeoutMs < 0)
+        readyCond.wait(lock, pred);
+    else
+        readyCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), pred);
+    return popReady(frame);
+}
+
+bool VideoSource::tryRead(Frame &frame)
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return popReady(frame);
+}
+
+void VideoSource::release(Frame &frame)
+{
+    if (frame.slot < 0)
+        return;
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        pool.release(frame.slot);
+    }
+    freeCond.notify_one();
+    frame.slot = -1;
+    frame.image = cv::Mat();
+}
+
+void VideoSource::setReadyCallback(std::function<void()> callback)
+{
+    readyCallback = callback;
+}
+
+bool VideoSource::isFinished() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return (ended || !running) && ready.empty();
+}
+
+std::string VideoSource::getUri() const
+{
+    return uri;
+}
+
+size_t VideoSource::getNumDecoded() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return numDecoded;
+}
+
+size_t VideoSource::getNumSkipped() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return numSkipped;
+}
+
+size_t VideoSource::getNumDropped() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return numDropped;
+}
+
+size_t VideoSource::getNumAllocations() const
+{
+    std::lock_guard<std::mutex> locker(mtx);
+    return pool.getNumAllocations();
+}
+
+} // namespace trt
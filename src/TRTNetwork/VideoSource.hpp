@@ -0,0 +1,175 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+
+#include "opencv2/opencv.hpp"
+
+namespace trt {
+
+/**
+ * @brief Decoded frame lent by a VideoSource. The image refers to a
+ *        buffer of the pool of the source and must be given back with
+ *        VideoSource::release().
+ */
+struct Frame
+{
+    int slot = -1;          // Buffer of the pool
+    int64_t index = -1;     // Position of the frame in the stream
+    cv::Mat image;
+};
+
+/**
+ * @brief What the decoder does when every buffer of the pool is taken.
+ */
+enum class SkipPolicy
+{
+    kBLOCK,         // Wait for a free buffer, no frame is lost. For files.
+    kDROP_OLDEST    // Recycle the oldest undelivered frame. For live cameras,
+                    // so that a slow consumer always gets recent frames.
+};
+
+/**
+ * @brief Fixed pool of frame buffers which are decoded into again and
+ *        again, so that steady streaming does not allocate.
+ *
+ *        cv::VideoCapture::read() reuses the destination cv::Mat when the
+ *        size and type match, so a buffer is only allocated on its first
+ *        frame or when the stream changes resolution. Those allocations
+ *        are counted.
+ */
+class FramePool
+{
+public:
+    explicit FramePool(int numBuffers);
+
+    /**
+     * @return slot     Free buffer, or -1 if all are taken.
+     */
+    int acquire();
+    void release(int slot);
+
+    cv::Mat& getBuffer(int slot);
+
+    /**
+     * @brief Call after decoding into a buffer to count reallocations.
+     */
+    void track(int slot);
+
+    int getNumBuffers() const;
+    int getNumFree() const;
+    size_t getNumAllocations() const;
+
+protected:
+    std::vector<cv::Mat> buffers;
+    std::vector<const uchar*> lastData;
+    std::vector<int> freeSlots;
+    size_t numAllocations = 0;
+};
+
+/**
+ * @brief Streaming source of frames from a video file or a capture
+ *        device, decoded on its own thread into a FramePool.
+ *
+ *        trt::VideoSource source("/data/cam01.mp4", 4, 2); // Every 2nd frame
+ *        source.start();
+ *
+ *        trt::Frame frame;
+ *        while (source.read(frame)) {
+ *            transformer.preprocess(data_ptr, frame.image);
+ *            source.release(frame);
+ *            ...
+ *        }
+ *
+ *        Skipped frames are only grabbed, not decoded.
+ */
+class VideoSource
+{
+public:
+    /**
+     * @param uri           Path of a video file, or the index of a capture
+     *                      device such as "0".
+     * @param numBuffers    Size of the frame pool, i.e. the max number of
+     *                      frames decoded ahead or held by the consumer.
+     * @param stride        Deliver every stride-th frame of the stream.
+     */
+    VideoSource(const std::string &uri, int numBuffers = 4, int stride = 1,
+                SkipPolicy policy = SkipPolicy::kBLOCK);
+
+    VideoSource(const VideoSource& other) = delete;
+    VideoSource& operator= (const VideoSource& other) = delete;
+
+    ~VideoSource();
+
+    /**
+     * @brief Open the stream and start decoding.
+     */
+    bool start();
+    void stop();
+
+    /**
+     * @brief Wait for the next frame.
+     * @param timeoutMs     Negative to wait forever.
+     * @return success      False on timeout or at the end of the stream.
+     */
+    bool read(Frame &frame, int timeoutMs = -1);
+
+    /**
+     * @brief Take the next frame if one is already decoded.
+     */
+    bool tryRead(Frame &frame);
+
+    void release(Frame &frame);
+
+    /**
+     * @brief Called from the decoding thread whenever a frame is ready or
+     *        the stream ends. Set before start().
+     */
+    void setReadyCallback(std::function<void()> callback);
+
+    /**
+     * @brief The stream ended and every decoded frame was delivered.
+     */
+    bool isFinished() const;
+
+    std::string getUri() const;
+    size_t getNumDecoded() const;
+    size_t getNumSkipped() const;    // By the stride
+    size_t getNumDropped() const;    // By the skip policy
+    size_t getNumAllocations() const;
+
+protected:
+    void decodeLoop();
+    bool popReady(Frame &frame);
+
+    const std::string uri;
+    const int stride;
+    const SkipPolicy policy;
+
+    cv::VideoCapture capture;
+    FramePool pool;
+
+    mutable std::mutex mtx;
+    std::condition_variable readyCond;
+    std::condition_variable freeCond;
+    std::deque<Frame> ready;
+    std::function<void()> readyCallback;
+
+    std::thread decoder;
+    std::atomic<bool> running;
+    bool ended = false;
+
+    int64_t position = 0;
+    size_t numDecoded = 0;
+    size_t numSkipped = 0;
+    size_t numDropped = 0;
+};
+
+} // namespace trt
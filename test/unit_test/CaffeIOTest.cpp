@@ -0,0 +1,198 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/CaffeIO.hpp"
+
+namespace {
+
+/**
+ * @brief Hand encoder of the protobuf wire format, to write BlobProtos
+ *        without depending on protobuf.
+ */
+class WireWriter
+{
+public:
+    WireWriter& varint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            buffer.push_back(char(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(char(value));
+        return *this;
+    }
+
+    WireWriter& key(int field, int wireType) { return varint(uint64_t(field) << 3 | wireType); }
+
+    template <typename T>
+    WireWriter& fixed(T value)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        buffer.append(bytes, sizeof(T));
+        return *this;
+    }
+
+    WireWriter& bytes(int field, const WireWriter &sub)
+    {
+        key(field, 2).varint(sub.buffer.size());
+        buffer += sub.buffer;
+        return *this;
+    }
+
+    std::string buffer;
+};
+
+/**
+ * @brief Write the buffer to a temporary blob file and read it back.
+ */
+bool readBlob(const std::string &buffer, trt::BlobData &blob, size_t truncate = 0)
+{
+    const std::string path = testing::TempDir() + "trt_blob.binaryproto";
+    {
+        std::ofstream file(path.c_str(), std::ios::binary);
+        file.write(buffer.data(), buffer.size() - truncate);
+    }
+    bool ok = trt::readBlobProto(path, blob);
+    std::remove(path.c_str());
+    return ok;
+}
+
+WireWriter shapeOf(const std::vector<int> &dims, bool packed)
+{
+    WireWriter shape;
+    if (packed) {
+        WireWriter values;
+        for (int d : dims)
+            values.varint(d);
+        shape.bytes(1, values);
+    } else {
+        for (int d : dims)
+            shape.key(1, 0).varint(d);
+    }
+    return shape;
+}
+
+} // namespace
+
+TEST(ReadLines, SkipsBlankAndCommentLines)
+{
+    const std::string path = testing::TempDir() + "trt_read_lines.txt";
+    {
+        std::ofstream file(path.c_str());
+        file << "# models\n"
+             << "alexnet deploy.prototxt\r\n"
+             << "\n"
+             << "   \t\n"
+             << "  images/cat.jpg  \n"
+             << "  # indented comment\n"
+             << "last";
+    }
+
+    std::vector<std::string> lines;
+    ASSERT_TRUE(trt::readLines(path, lines));
+    EXPECT_EQ(lines, (std::vector<std::string>{"alexnet deploy.prototxt", "images/cat.jpg", "last"}));
+
+    // Labels keep every line, their index is the class
+    std::vector<std::string> labels;
+    ASSERT_TRUE(trt::readLabels(path, labels));
+    EXPECT_EQ(labels.size(), 7u);
+    std::remove(path.c_str());
+}
+
+TEST(ReadLines, MissingFile)
+{
+    std::vector<std::string> lines;
+    EXPECT_FALSE(trt::readLines(testing::TempDir() + "trt_no_such_list.txt", lines));
+}
+
+TEST(ReadBlobProto, LegacyDimensions)
+{
+    WireWriter blob;
+    blob.key(1, 0).varint(1).key(2, 0).varint(2).key(3, 0).varint(1).key(4, 0).varint(2);
+    for (float v : {1.f, 2.f, 3.f, 4.f})
+        blob.key(5, 5).fixed(v);
+
+    trt::BlobData data;
+    ASSERT_TRUE(readBlob(blob.buffer, data));
+    EXPECT_EQ(data.shape, (std::vector<int>{1, 2, 1, 2}));
+    EXPECT_EQ(data.data, (std::vector<float>{1.f, 2.f, 3.f, 4.f}));
+    EXPECT_EQ(trt::channelMean(data), (std::vector<float>{1.5f, 3.5f}));
+}
+
+TEST(ReadBlobProto, ShapeAndPackedData)
+{
+    WireWriter values;
+    for (float v : {1.f, 2.f, 3.f, 4.f, 5.f, 6.f})
+        values.fixed(v);
+
+    // Unknown fields are skipped, and the shape wins over the legacy fields
+    WireWriter blob;
+    blob.key(2, 0).varint(6).key(9, 2).varint(3).fixed<char>('a').fixed<char>('b').fixed<char>('c')
+        .bytes(7, shapeOf({3, 1, 2}, true)).bytes(5, values);
+
+    trt::BlobData data;
+    ASSERT_TRUE(readBlob(blob.buffer, data));
+    EXPECT_EQ(data.shape, (std::vector<int>{3, 1, 2}));
+    EXPECT_EQ(data.data, (std::vector<float>{1.f, 2.f, 3.f, 4.f, 5.f, 6.f}));
+
+    WireWriter unpacked;
+    unpacked.bytes(7, shapeOf({2}, false)).key(5, 5).fixed(7.f).key(5, 5).fixed(8.f);
+    ASSERT_TRUE(readBlob(unpacked.buffer, data));
+    EXPECT_EQ(data.shape, (std::vector<int>{2}));
+    EXPECT_EQ(data.data, (std::vector<float>{7.f, 8.f}));
+}
+
+TEST(ReadBlobProto, DoubleData)
+{
+    WireWriter values;
+    values.fixed(0.5).fixed(-1.5);
+
+    WireWriter blob;
+    blob.bytes(7, shapeOf({1, 3}, false)).bytes(8, values).key(8, 1).fixed(2.25);
+
+    trt::BlobData data;
+    ASSERT_TRUE(readBlob(blob.buffer, data));
+    EXPECT_EQ(data.shape, (std::vector<int>{1, 3}));
+    EXPECT_EQ(data.data, (std::vector<float>{0.5f, -1.5f, 2.25f}));
+}
+
+TEST(ReadBlobProto, MalformedBlobs)
+{
+    WireWriter blob;
+    blob.bytes(7, shapeOf({2, 2}, true));
+    for (float v : {1.f, 2.f, 3.f, 4.f})
+        blob.key(5, 5).fixed(v);
+
+    trt::BlobData data;
+    ASSERT_TRUE(readBlob(blob.buffer, data));
+    EXPECT_FALSE(readBlob(blob.buffer, data, 1));
+    EXPECT_FALSE(readBlob(blob.buffer, data, 5));
+
+    // More values than the shape holds
+    WireWriter extra = blob;
+    extra.key(5, 5).fixed(5.f);
+    EXPECT_FALSE(readBlob(extra.buffer, data));
+
+    // Values whose wire type does not match their size are rejected, even
+    // when the bytes which follow would decode to the expected count
+    WireWriter floatAsDouble;
+    floatAsDouble.bytes(7, shapeOf({2}, true)).key(5, 1).fixed(1.f).key(5, 5).fixed(2.f);
+    EXPECT_FALSE(readBlob(floatAsDouble.buffer, data));
+    WireWriter doubleAsFloat;
+    doubleAsFloat.bytes(7, shapeOf({1}, true)).key(8, 5).fixed(1.0);
+    EXPECT_FALSE(readBlob(doubleAsFloat.buffer, data));
+
+    // A packed field whose length is not a multiple of the value size
+    WireWriter odd;
+    odd.bytes(7, shapeOf({1}, true)).key(5, 2).varint(5).fixed(1.f).fixed<char>(0);
+    EXPECT_FALSE(readBlob(odd.buffer, data));
+
+    EXPECT_FALSE(trt::readBlobProto(testing::TempDir() + "trt_no_such_blob.binaryproto", data));
+}
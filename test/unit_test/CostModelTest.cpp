@@ -0,0 +1,307 @@
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/CostModel.hpp"
+
+namespace {
+
+/**
+ * @brief Parse the prototxt and estimate its cost, which must succeed.
+ */
+void estimate(const std::string &prototxt, trt::NetworkCost &cost, int inputHeight = 0, int inputWidth = 0)
+{
+    trt::ProtoMessage root;
+    ASSERT_TRUE(trt::parsePrototxt(prototxt, root));
+    ASSERT_TRUE(trt::estimateCost(root, {}, cost, inputHeight, inputWidth));
+}
+
+bool estimates(const std::string &prototxt)
+{
+    trt::ProtoMessage root;
+    trt::NetworkCost cost;
+    return trt::parsePrototxt(prototxt, root) && trt::estimateCost(root, {}, cost);
+}
+
+std::string withInput(int c, int h, int w, const std::string &layers)
+{
+    return "input: \"data\"\ninput_shape { dim: 1 dim: " + std::to_string(c) + " dim: " + std::to_string(h) +
+           " dim: " + std::to_string(w) + " }\n" + layers;
+}
+
+const trt::LayerCost& layerNamed(const trt::NetworkCost &cost, const std::string &name)
+{
+    for (const trt::LayerCost &layer : cost.layers)
+        if (layer.name == name)
+            return layer;
+    throw std::runtime_error("No layer " + name);
+}
+
+typedef std::vector<int> Shape;
+
+} // namespace
+
+TEST(Prototxt, CommentsAndQuotedStrings)
+{
+    trt::ProtoMessage root;
+    ASSERT_TRUE(trt::parsePrototxt(
+        "# A comment at the top\n"
+        "name: \"net # not a comment\"  # a trailing comment\n"
+        "note: 'single \"quoted\"'\n"
+        "escaped: \"say \\\"hi\\\"\"\n"
+        "layer {\n"
+        "  name: \"conv\"; type: \"Convolution\",\n"
+        "  convolution_param { num_output: 8 kernel_size: 3 kernel_size: 5 bias_term: false }\n"
+        "}\n"
+        "layer { name: \"relu\" }\n", root));
+
+    EXPECT_EQ(root.get("name"), "net # not a comment");
+    EXPECT_EQ(root.get("note"), "single \"quoted\"");
+    EXPECT_EQ(root.get("escaped"), "say \"hi\"");
+    EXPECT_FALSE(root.has("missing"));
+    EXPECT_EQ(root.get("missing", "fallback"), "fallback");
+
+    std::vector<const trt::ProtoMessage*> layers = root.getMessages("layer");
+    ASSERT_EQ(layers.size(), 2u);
+    EXPECT_EQ(layers.at(0)->get("type"), "Convolution");
+    EXPECT_EQ(layers.at(1)->get("name"), "relu");
+
+    const trt::ProtoMessage *param = layers.at(0)->getMessage("convolution_param");
+    ASSERT_NE(param, nullptr);
+    EXPECT_EQ(param->getInt("num_output"), 8);
+    EXPECT_EQ(param->getAll("kernel_size"), std::vector<std::string>({"3", "5"}));
+    EXPECT_FALSE(param->getBool("bias_term", true));
+    EXPECT_TRUE(param->getBool("missing", true));
+    EXPECT_EQ(layers.at(1)->getMessage("convolution_param"), nullptr);
+}
+
+TEST(Prototxt, MalformedInput)
+{
+    trt::ProtoMessage root;
+    EXPECT_FALSE(trt::parsePrototxt("name: \"unterminated", root));
+    EXPECT_FALSE(trt::parsePrototxt("layer { name: \"a\"", root));
+    EXPECT_FALSE(trt::parsePrototxt("layer { name: \"a\" } }", root));
+    EXPECT_FALSE(trt::parsePrototxt("name: }", root));
+    EXPECT_FALSE(trt::parsePrototxt("name \"a\"", root));
+    EXPECT_FALSE(trt::parsePrototxt("\"a\": 1", root));
+    EXPECT_FALSE(trt::parsePrototxt("name: @", root));
+    EXPECT_FALSE(trt::readPrototxt(testing::TempDir() + "/missing.prototxt", root));
+
+    EXPECT_TRUE(trt::parsePrototxt("", root));
+    EXPECT_TRUE(root.fields.empty() && root.messages.empty());
+}
+
+TEST(CostModel, ConvolutionWithPadding)
+{
+    trt::NetworkCost cost;
+    estimate(withInput(3, 11, 11,
+        "layer { name: \"conv\" type: \"Convolution\" bottom: \"data\" top: \"conv\"\n"
+        "  convolution_param { num_output: 4 kernel_size: 3 stride: 2 pad: 1 } }\n"
+        "layer { name: \"rect\" type: \"Convolution\" bottom: \"data\" top: \"rect\"\n"
+        "  convolution_param { num_output: 2 kernel_h: 3 kernel_w: 1 pad_h: 1 bias_term: false } }\n"
+        "layer { name: \"dilated\" type: \"Convolution\" bottom: \"data\" top: \"dilated\"\n"
+        "  convolution_param { num_output: 3 group: 3 kernel_size: 3 dilation: 2 } }\n"), cost);
+
+    ASSERT_EQ(cost.blobShapes.at("data"), Shape({3, 11, 11}));
+
+    // (11 + 2 - 3) / 2 + 1 = 6
+    const trt::LayerCost &conv = layerNamed(cost, "conv");
+    EXPECT_EQ(conv.outputShape, Shape({4, 6, 6}));
+    EXPECT_DOUBLE_EQ(conv.flops, 2.0 * 4 * 6 * 6 * 3 * 9 + 4 * 6 * 6);
+    EXPECT_EQ(conv.paramBytes, (4 * 3 * 9 + 4) * sizeof(float));
+
+    const trt::LayerCost &rect = layerNamed(cost, "rect");
+    EXPECT_EQ(rect.outputShape, Shape({2, 11, 11}));
+    EXPECT_DOUBLE_EQ(rect.flops, 2.0 * 2 * 11 * 11 * 3 * 3);
+    EXPECT_EQ(rect.paramBytes, 2 * 3 * 3 * sizeof(float));
+
+    // The dilated kernel spans 5 pixels, and each group sees one channel
+    const trt::LayerCost &dilated = layerNamed(cost, "dilated");
+    EXPECT_EQ(dilated.outputShape, Shape({3, 7, 7}));
+    EXPECT_EQ(dilated.paramBytes, (3 * 1 * 9 + 3) * sizeof(float));
+
+    EXPECT_FALSE(estimates(withInput(3, 11, 11,
+        "layer { name: \"conv\" type: \"Convolution\" bottom: \"data\" top: \"conv\"\n"
+        "  convolution_param { num_output: 4 kernel_size: 3 group: 2 } }\n")));
+    EXPECT_FALSE(estimates(withInput(3, 11, 11,
+        "layer { name: \"conv\" type: \"Convolution\" bottom: \"data\" top: \"conv\"\n"
+        "  convolution_param { num_output: 4 } }\n")));
+}
+
+TEST(CostModel, Deconvolution)
+{
+    trt::NetworkCost cost;
+    estimate(withInput(4, 6, 6,
+        "layer { name: \"up\" type: \"Deconvolution\" bottom: \"data\" top: \"up\"\n"
+        "  convolution_param { num_output: 2 kernel_size: 4 stride: 2 pad: 1 } }\n"), cost);
+
+    // 2 * (6 - 1) + 4 - 2 = 12
+    const trt::LayerCost &up = layerNamed(cost, "up");
+    EXPECT_EQ(up.outputShape, Shape({2, 12, 12}));
+    EXPECT_DOUBLE_EQ(up.flops, 2.0 * 4 * 6 * 6 * 2 * 16 + 2 * 12 * 12);
+    EXPECT_EQ(up.paramBytes, (2 * 4 * 16 + 2) * sizeof(float));
+}
+
+TEST(CostModel, PoolingRoundsUp)
+{
+    trt::NetworkCost cost;
+    estimate(withInput(3, 12, 12,
+        "layer { name: \"ceil\" type: \"Pooling\" bottom: \"data\" top: \"ceil\"\n"
+        "  pooling_param { pool: MAX kernel_size: 3 stride: 2 } }\n"
+        "layer { name: \"padded\" type: \"Pooling\" bottom: \"data\" top: \"padded\"\n"
+        "  pooling_param { pool: AVE kernel_size: 2 stride: 2 pad: 1 } }\n"
+        "layer { name: \"global\" type: \"Pooling\" bottom: \"data\" top: \"global\"\n"
+        "  pooling_param { pool: AVE global_pooling: true } }\n"), cost);
+
+    // ceil((12 - 3) / 2) + 1 = 6 where a convolution would give 5
+    const trt::LayerCost &ceil = layerNamed(cost, "ceil");
+    EXPECT_EQ(ceil.outputShape, Shape({3, 6, 6}));
+    EXPECT_DOUBLE_EQ(ceil.flops, 3.0 * 6 * 6 * 9);
+    EXPECT_EQ(ceil.paramBytes, 0u);
+
+    EXPECT_EQ(layerNamed(cost, "padded").outputShape, Shape({3, 7, 7}));
+    EXPECT_EQ(layerNamed(cost, "global").outputShape, Shape({3, 1, 1}));
+
+    // ceil((5 + 2 - 3) / 3) + 1 = 3, but the last window would start in the padding
+    estimate(withInput(1, 5, 5,
+        "layer { name: \"clipped\" type: \"Pooling\" bottom: \"data\" top: \"clipped\"\n"
+        "  pooling_param { kernel_size: 3 stride: 3 pad: 1 } }\n"), cost);
+    EXPECT_EQ(layerNamed(cost, "clipped").outputShape, Shape({1, 2, 2}));
+}
+
+TEST(CostModel, ReshapeSliceConcat)
+{
+    trt::NetworkCost cost;
+    estimate(withInput(6, 2, 2,
+        "layer { name: \"slice\" type: \"Slice\" bottom: \"data\" top: \"a\" top: \"b\" top: \"c\"\n"
+        "  slice_param { axis: 1 slice_point: 1 slice_point: 4 } }\n"
+        "layer { name: \"even\" type: \"Slice\" bottom: \"data\" top: \"d\" top: \"e\" top: \"f\" }\n"
+        "layer { name: \"concat\" type: \"Concat\" bottom: \"c\" bottom: \"a\" bottom: \"b\" top: \"concat\" }\n"
+        "layer { name: \"wide\" type: \"Concat\" bottom: \"d\" bottom: \"e\" top: \"wide\"\n"
+        "  concat_param { axis: 3 } }\n"
+        "layer { name: \"reshape\" type: \"Reshape\" bottom: \"concat\" top: \"reshape\"\n"
+        "  reshape_param { shape { dim: 0 dim: -1 dim: 8 } } }\n"
+        "layer { name: \"keep\" type: \"Reshape\" bottom: \"concat\" top: \"keep\"\n"
+        "  reshape_param { shape { dim: 0 dim: 12 dim: 0 dim: 1 } } }\n"), cost);
+
+    EXPECT_EQ(cost.blobShapes.at("a"), Shape({1, 2, 2}));
+    EXPECT_EQ(cost.blobShapes.at("b"), Shape({3, 2, 2}));
+    EXPECT_EQ(cost.blobShapes.at("c"), Shape({2, 2, 2}));
+    EXPECT_EQ(cost.blobShapes.at("d"), Shape({2, 2, 2}));
+    EXPECT_EQ(cost.blobShapes.at("f"), Shape({2, 2, 2}));
+    EXPECT_EQ(cost.blobShapes.at("concat"), Shape({6, 2, 2}));
+    EXPECT_EQ(cost.blobShapes.at("wide"), Shape({2, 2, 4}));
+
+    // The batch is the first dim: 24 values make 3 rows of 8
+    EXPECT_EQ(cost.blobShapes.at("reshape"), Shape({3, 8}));
+    EXPECT_EQ(cost.blobShapes.at("keep"), Shape({12, 2, 1}));
+
+    EXPECT_FALSE(estimates(withInput(6, 2, 2,
+        "layer { name: \"reshape\" type: \"Reshape\" bottom: \"data\" top: \"reshape\"\n"
+        "  reshape_param { shape { dim: 0 dim: 5 dim: -1 } } }\n")));
+    EXPECT_FALSE(estimates(withInput(6, 2, 2,
+        "layer { name: \"slice\" type: \"Slice\" bottom: \"data\" top: \"a\" top: \"b\" top: \"c\"\n"
+        "  slice_param { slice_point: 1 } }\n")));
+    EXPECT_FALSE(estimates(withInput(6, 2, 2,
+        "layer { name: \"concat\" type: \"Concat\" bottom: \"data\" bottom: \"data\" top: \"concat\"\n"
+        "  concat_param { axis: 0 } }\n")));
+}
+
+TEST(CostModel, V1Layers)
+{
+    trt::NetworkCost cost;
+    estimate(
+        "input: \"data\"\n"
+        "input_dim: 1 input_dim: 3 input_dim: 8 input_dim: 8\n"
+        "layers { name: \"conv\" type: CONVOLUTION bottom: \"data\" top: \"conv\"\n"
+        "  convolution_param { num_output: 2 kernel_size: 3 } }\n"
+        "layers { name: \"relu\" type: RELU bottom: \"conv\" top: \"conv\" }\n"
+        "layers { name: \"drop\" type: DROPOUT bottom: \"conv\" top: \"conv\" include { phase: TRAIN } }\n"
+        "layers { name: \"fc\" type: INNER_PRODUCT bottom: \"conv\" top: \"fc\"\n"
+        "  inner_product_param { num_output: 10 } }\n", cost);
+
+    ASSERT_EQ(cost.layers.size(), 3u);
+    EXPECT_EQ(cost.layers.at(0).type, "Convolution");
+    EXPECT_EQ(cost.layers.at(1).type, "ReLU");
+    EXPECT_EQ(cost.layers.at(2).type, "InnerProduct");
+    for (const trt::LayerCost &layer : cost.layers)
+        EXPECT_TRUE(layer.supported);
+
+    EXPECT_EQ(cost.inputs, std::vector<std::string>({"data"}));
+    EXPECT_EQ(cost.outputs, std::vector<std::string>({"fc"}));
+    EXPECT_EQ(cost.blobShapes.at("conv"), Shape({2, 6, 6}));
+    EXPECT_EQ(cost.blobShapes.at("fc"), Shape({10, 1, 1}));
+    EXPECT_EQ(cost.layers.at(2).paramBytes, (72 * 10 + 10) * sizeof(float));
+
+    // Only the input and the output cross the boundary of the engine
+    EXPECT_EQ(cost.ioBytes, (3 * 8 * 8 + 10) * sizeof(float));
+    EXPECT_EQ(cost.peakActivationBytes, 72 * sizeof(float));
+}
+
+TEST(CostModel, InputSizeOverride)
+{
+    const std::string prototxt =
+        "layer { name: \"data\" type: \"Input\" top: \"data\"\n"
+        "  input_param { shape { dim: 1 dim: 3 dim: 10 dim: 10 } } }\n"
+        "layer { name: \"conv\" type: \"Convolution\" bottom: \"data\" top: \"conv\"\n"
+        "  convolution_param { num_output: 4 kernel_size: 3 pad: 1 } }\n";
+
+    trt::NetworkCost cost;
+    estimate(prototxt, cost);
+    EXPECT_EQ(cost.blobShapes.at("data"), Shape({3, 10, 10}));
+    EXPECT_EQ(cost.blobShapes.at("conv"), Shape({4, 10, 10}));
+
+    trt::NetworkCost resized;
+    estimate(prototxt, resized, 20, 30);
+    EXPECT_EQ(resized.blobShapes.at("data"), Shape({3, 20, 30}));
+    EXPECT_EQ(resized.blobShapes.at("conv"), Shape({4, 20, 30}));
+    EXPECT_DOUBLE_EQ(resized.flops, cost.flops * 6);
+    EXPECT_EQ(resized.paramBytes, cost.paramBytes);
+    EXPECT_EQ(resized.ioBytes, cost.ioBytes * 6);
+
+    // Both are needed to override the size
+    estimate(prototxt, resized, 20, 0);
+    EXPECT_EQ(resized.blobShapes.at("data"), Shape({3, 10, 10}));
+}
+
+TEST(CostModel, UnknownBlobs)
+{
+    trt::ProtoMessage root;
+    trt::NetworkCost cost;
+    ASSERT_TRUE(trt::parsePrototxt(withInput(3, 4, 4,
+        "layer { name: \"relu\" type: \"ReLU\" bottom: \"missing\" top: \"relu\" }\n"), root));
+    EXPECT_FALSE(trt::estimateCost(root, {}, cost));
+
+    ASSERT_TRUE(trt::parsePrototxt(withInput(3, 4, 4,
+        "layer { name: \"relu\" type: \"ReLU\" bottom: \"data\" top: \"relu\" }\n"), root));
+    EXPECT_FALSE(trt::estimateCost(root, {"prob"}, cost));
+    EXPECT_TRUE(trt::estimateCost(root, {"relu"}, cost));
+}
+
+TEST(CostModel, Capacity)
+{
+    trt::NetworkCost cost;
+    cost.paramBytes = 1000;
+    cost.peakActivationBytes = 100;
+    cost.ioBytes = 50;
+
+    // 1000 bytes of weights and 500 of workspace, then 150 bytes per sample
+    const size_t workspace = 500;
+    EXPECT_EQ(cost.estimateFootprint(4, workspace).total(), 1000u + 500 + 4 * 150);
+    EXPECT_EQ(cost.maxBatchSizeWithin(1000, workspace), 0);
+    EXPECT_EQ(cost.maxBatchSizeWithin(1649, workspace), 0);
+    EXPECT_EQ(cost.maxBatchSizeWithin(1650, workspace), 1);
+    EXPECT_EQ(cost.maxBatchSizeWithin(1500 + 4 * 150 + 149, workspace), 4);
+
+    const size_t perInstance = 1000 + 500 + 4 * 150;
+    EXPECT_EQ(cost.maxInstancesWithin(perInstance - 1, 4, workspace), 0);
+    EXPECT_EQ(cost.maxInstancesWithin(3 * perInstance, 4, workspace), 3);
+    EXPECT_EQ(cost.maxInstancesWithin(3 * perInstance - 1, 4, workspace), 2);
+
+    trt::NetworkCost empty;
+    EXPECT_EQ(empty.maxBatchSizeWithin(0, 0), INT_MAX);
+    EXPECT_EQ(empty.maxInstancesWithin(1 << 20, 4, 0), 0);
+}
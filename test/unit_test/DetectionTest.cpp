@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/Detection.hpp"
+
+namespace {
+
+void expectBox(const trt::Box &box, float xmin, float ymin, float xmax, float ymax)
+{
+    EXPECT_NEAR(box.xmin, xmin, 1e-5f);
+    EXPECT_NEAR(box.ymin, ymin, 1e-5f);
+    EXPECT_NEAR(box.xmax, xmax, 1e-5f);
+    EXPECT_NEAR(box.ymax, ymax, 1e-5f);
+}
+
+/**
+ * @brief Textbook greedy NMS with the division, as Caffe does it.
+ */
+std::vector<int> referenceNms(const std::vector<trt::Box> &boxes, float threshold)
+{
+    std::vector<int> kept;
+    for (int i = 0; i < (int)boxes.size(); ++i) {
+        bool keep = true;
+        for (int k : kept)
+            keep = keep && trt::jaccardOverlap(boxes.at(i), boxes.at(k)) <= threshold;
+        if (keep)
+            kept.push_back(i);
+    }
+    return kept;
+}
+
+std::vector<int> runNms(const std::vector<trt::Box> &boxes, float threshold)
+{
+    std::vector<float> x1, y1, x2, y2, area;
+    for (const trt::Box &b : boxes) {
+        x1.push_back(b.xmin);
+        y1.push_back(b.ymin);
+        x2.push_back(b.xmax);
+        y2.push_back(b.ymax);
+        area.push_back((b.xmax - b.xmin) * (b.ymax - b.ymin));
+    }
+    std::vector<int> kept;
+    trt::nmsSorted(x1.data(), y1.data(), x2.data(), y2.data(), area.data(), boxes.size(), threshold, kept);
+    return kept;
+}
+
+/**
+ * @brief Priors given in corner form, with the usual SSD variances.
+ */
+std::vector<float> makePriors(const std::vector<trt::Box> &boxes)
+{
+    std::vector<float> priors;
+    for (const trt::Box &b : boxes)
+        priors.insert(priors.end(), {b.xmin, b.ymin, b.xmax, b.ymax});
+    for (size_t p = 0; p < boxes.size(); ++p)
+        priors.insert(priors.end(), {0.1f, 0.1f, 0.2f, 0.2f});
+    return priors;
+}
+
+} // namespace
+
+TEST(DecodeBox, CenterSize)
+{
+    const float prior[4] = {0.1f, 0.2f, 0.5f, 0.6f};
+    const float variance[4] = {0.1f, 0.1f, 0.2f, 0.2f};
+
+    const float zero[4] = {0.f, 0.f, 0.f, 0.f};
+    expectBox(trt::decodeBox(zero, prior, variance), 0.1f, 0.2f, 0.5f, 0.6f);
+
+    // Center moved by variance * offset * size: (0.3, 0.4) + (0.04, -0.04)
+    const float shift[4] = {1.f, -1.f, 0.f, 0.f};
+    expectBox(trt::decodeBox(shift, prior, variance), 0.14f, 0.16f, 0.54f, 0.56f);
+
+    // Width scaled by exp(0.2 * ln(2) / 0.2) = 2 around the same center
+    const float scale[4] = {0.f, 0.f, std::log(2.f) / 0.2f, 0.f};
+    expectBox(trt::decodeBox(scale, prior, variance), -0.1f, 0.2f, 0.7f, 0.6f);
+}
+
+TEST(JaccardOverlap, HandComputed)
+{
+    EXPECT_NEAR(trt::jaccardOverlap({0, 0, 2, 2}, {1, 1, 3, 3}), 1.f / 7.f, 1e-6f);
+    EXPECT_NEAR(trt::jaccardOverlap({0, 0, 2, 2}, {0, 0, 2, 2}), 1.f, 1e-6f);
+    EXPECT_NEAR(trt::jaccardOverlap({0, 0, 2, 2}, {0, 0, 1, 2}), 0.5f, 1e-6f);
+    EXPECT_EQ(trt::jaccardOverlap({0, 0, 1, 1}, {1, 0, 2, 1}), 0.f); // Touching
+    EXPECT_EQ(trt::jaccardOverlap({0, 0, 1, 1}, {2, 2, 3, 3}), 0.f);
+    EXPECT_EQ(trt::jaccardOverlap({1, 1, 0, 0}, {0, 0, 1, 1}), 0.f); // Empty
+}
+
+TEST(NmsSorted, HandComputed)
+{
+    std::vector<trt::Box> boxes = {
+        {0.f, 0.f, 1.f, 1.f},   // Kept
+        {0.1f, 0.f, 1.1f, 1.f}, // IoU 0.9 / 1.1 with the first, suppressed
+        {2.f, 2.f, 3.f, 3.f},   // Disjoint, kept
+        {0.f, 0.f, 1.f, 0.5f}   // IoU exactly 0.5, kept since not above
+    };
+
+    std::vector<float> x1, y1, x2, y2, area;
+    for (const trt::Box &b : boxes) {
+        x1.push_back(b.xmin);
+        y1.push_back(b.ymin);
+        x2.push_back(b.xmax);
+        y2.push_back(b.ymax);
+        area.push_back((b.xmax - b.xmin) * (b.ymax - b.ymin));
+    }
+    std::vector<int> kept;
+    trt::nmsSorted(x1.data(), y1.data(), x2.data(), y2.data(), area.data(), 4, 0.5f, kept);
+
+    EXPECT_EQ(kept, (std::vector<int>{0, 2, 3}));
+    // The kept boxes are compacted to the front
+    EXPECT_EQ(x1.at(1), 2.f);
+    EXPECT_EQ(y2.at(2), 0.5f);
+    EXPECT_EQ(area.at(2), 0.5f);
+}
+
+TEST(NmsSorted, MatchesReferenceAcrossVectorWidths)
+{
+    /* Up to 40 kept boxes, so that the comparisons with the kept ones run
+     * through whole 8-wide AVX blocks and the scalar tail when the library
+     * is built with AVX, and through the scalar loop only otherwise. */
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(0.f, 1.f);
+    std::uniform_real_distribution<float> size(0.02f, 0.3f);
+
+    for (int count : {1, 7, 8, 9, 16, 17, 40, 100}) {
+        for (float threshold : {0.3f, 0.45f, 0.7f}) {
+            std::vector<trt::Box> boxes(count);
+            for (trt::Box &b : boxes) {
+                b.xmin = position(rng);
+                b.ymin = position(rng);
+                b.xmax = b.xmin + size(rng);
+                b.ymax = b.ymin + size(rng);
+            }
+            EXPECT_EQ(runNms(boxes, threshold), referenceNms(boxes, threshold))
+                << count << " boxes, threshold " << threshold;
+        }
+    }
+}
+
+TEST(NmsSorted, SuppressionInEveryLane)
+{
+    // Nine disjoint boxes, then one overlapping each of them in turn
+    std::vector<trt::Box> grid;
+    for (int i = 0; i < 9; ++i)
+        grid.push_back({(float)i, 0.f, i + 1.f, 1.f});
+
+    for (int lane = 0; lane < 9; ++lane) {
+        std::vector<trt::Box> boxes = grid;
+        boxes.push_back({lane + 0.05f, 0.f, lane + 1.05f, 1.f});
+        std::vector<int> kept = runNms(boxes, 0.5f);
+        EXPECT_EQ(kept.size(), 9u) << "lane " << lane;
+        EXPECT_EQ(kept.back(), 8);
+    }
+}
+
+TEST(DetectionOutput, PerClassNmsAndKeepTopK)
+{
+    // Priors 0 and 1 overlap by IoU 0.8 / 1.2, prior 2 is apart
+    std::vector<float> priors = makePriors({{0.f, 0.f, 0.5f, 0.5f}, {0.05f, 0.f, 0.55f, 0.5f},
+                                            {0.6f, 0.6f, 0.9f, 0.9f}});
+    std::vector<float> loc(3 * 4, 0.f); // Boxes are the priors
+
+    // Background, class 1, class 2 per prior
+    std::vector<float> conf = {
+        0.1f, 0.8f, 0.1f,
+        0.1f, 0.7f, 0.6f,
+        0.5f, 0.3f, 0.2f,
+    };
+
+    trt::DetectionParams params;
+    params.numClasses = 3;
+    params.confidenceThreshold = 0.15f;
+    params.nmsThreshold = 0.45f;
+
+    trt::DetectionOutput output(params);
+    std::vector< std::vector<trt::Detection> > detections;
+    ASSERT_TRUE(output.forward(loc.data(), conf.data(), priors.data(), 1, 3, detections));
+    ASSERT_EQ(detections.size(), 1u);
+
+    // Class 1 suppresses prior 1 by prior 0, class 2 keeps prior 1 on its own
+    const std::vector<trt::Detection> &d = detections.at(0);
+    ASSERT_EQ(d.size(), 4u);
+    EXPECT_EQ(d.at(0).label, 1);
+    EXPECT_FLOAT_EQ(d.at(0).score, 0.8f);
+    expectBox(d.at(0).box, 0.f, 0.f, 0.5f, 0.5f);
+    EXPECT_EQ(d.at(1).label, 2);
+    EXPECT_FLOAT_EQ(d.at(1).score, 0.6f);
+    expectBox(d.at(1).box, 0.05f, 0.f, 0.55f, 0.5f);
+    EXPECT_EQ(d.at(2).label, 1);
+    EXPECT_FLOAT_EQ(d.at(2).score, 0.3f);
+    EXPECT_EQ(d.at(3).label, 2);
+    EXPECT_FLOAT_EQ(d.at(3).score, 0.2f);
+
+    // The best two over all classes
+    params.keepTopK = 2;
+    trt::DetectionOutput top2(params);
+    ASSERT_TRUE(top2.forward(loc.data(), conf.data(), priors.data(), 1, 3, detections));
+    ASSERT_EQ(detections.at(0).size(), 2u);
+    EXPECT_FLOAT_EQ(detections.at(0).at(0).score, 0.8f);
+    EXPECT_FLOAT_EQ(detections.at(0).at(1).score, 0.6f);
+
+    // Only the best candidate per class enters the NMS
+    params.keepTopK = 200;
+    params.topK = 1;
+    trt::DetectionOutput top1(params);
+    ASSERT_TRUE(top1.forward(loc.data(), conf.data(), priors.data(), 1, 3, detections));
+    ASSERT_EQ(detections.at(0).size(), 2u);
+    EXPECT_FLOAT_EQ(detections.at(0).at(0).score, 0.8f);
+    EXPECT_FLOAT_EQ(detections.at(0).at(1).score, 0.6f);
+}
+
+TEST(DetectionOutput, ThresholdAcrossVectorWidths)
+{
+    // Ten classes: labels below 8 go through the AVX prefilter, 8 and 9 through the tail
+    const int numClasses = 10;
+    std::vector<float> priors = makePriors({{0.f, 0.f, 0.2f, 0.2f}});
+    std::vector<float> loc(4, 0.f);
+    std::vector<float> conf(numClasses, 0.01f);
+    conf.at(0) = 0.9f; // Background, never reported
+    conf.at(3) = 0.5f;
+    conf.at(7) = 0.2f;
+    conf.at(8) = 0.05f; // Equal to the threshold, not above
+    conf.at(9) = 0.3f;
+
+    trt::DetectionParams params;
+    params.numClasses = numClasses;
+    params.confidenceThreshold = 0.05f;
+
+    trt::DetectionOutput output(params);
+    std::vector< std::vector<trt::Detection> > detections;
+    ASSERT_TRUE(output.forward(loc.data(), conf.data(), priors.data(), 1, 1, detections));
+
+    std::vector<int> labels;
+    for (const trt::Detection &d : detections.at(0))
+        labels.push_back(d.label);
+    EXPECT_EQ(labels, (std::vector<int>{3, 9, 7}));
+}
+
+TEST(DetectionOutput, PerClassLocationsAndBatch)
+{
+    std::vector<float> priors = makePriors({{0.2f, 0.2f, 0.6f, 0.6f}});
+    const float dx = 1.f; // Moves the center by 0.1 * 1 * 0.4
+
+    // Two images, loc per class: background, class 1, class 2
+    std::vector<float> loc = {
+        0, 0, 0, 0,   0, 0, 0, 0,   dx, 0, 0, 0,
+        0, 0, 0, 0,   -dx, 0, 0, 0, 0, 0, 0, 0,
+    };
+    std::vector<float> conf = {
+        0.f, 0.f, 0.9f,
+        0.f, 0.7f, 0.f,
+    };
+
+    trt::DetectionParams params;
+    params.numClasses = 3;
+    params.shareLocation = false;
+
+    trt::DetectionOutput output(params);
+    std::vector< std::vector<trt::Detection> > detections;
+    ASSERT_TRUE(output.forward(loc.data(), conf.data(), priors.data(), 2, 1, detections));
+    ASSERT_EQ(detections.size(), 2u);
+    ASSERT_EQ(detections.at(0).size(), 1u);
+    ASSERT_EQ(detections.at(1).size(), 1u);
+
+    EXPECT_EQ(detections.at(0).at(0).label, 2);
+    expectBox(detections.at(0).at(0).box, 0.24f, 0.2f, 0.64f, 0.6f);
+    EXPECT_EQ(detections.at(1).at(0).label, 1);
+    expectBox(detections.at(1).at(0).box, 0.16f, 0.2f, 0.56f, 0.6f);
+}
+
+TEST(DetectionOutput, RejectsInvalidArguments)
+{
+    trt::DetectionOutput output{trt::DetectionParams()};
+    std::vector<float> buffer(4 * 21 * 2, 0.f);
+    std::vector< std::vector<trt::Detection> > detections;
+    EXPECT_FALSE(output.forward(nullptr, buffer.data(), buffer.data(), 1, 1, detections));
+    EXPECT_FALSE(output.forward(buffer.data(), buffer.data(), buffer.data(), 0, 1, detections));
+    EXPECT_FALSE(output.forward(buffer.data(), buffer.data(), buffer.data(), 1, 0, detections));
+}
@@ -0,0 +1,189 @@
+#include <chrono>
+#include <future>
+#include <memory>
+#include <set>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/DeviceMemory.hpp"
+#include "TRTNetwork/TRTBuilder.hpp"
+
+namespace {
+
+/**
+ * @brief Stand-in for cudaMalloc: host memory, keeping track of the live
+ *        buffers.
+ */
+class MockAllocator : public trt::DeviceAllocator
+{
+public:
+    void* allocate(size_t bytes) override
+    {
+        void *ptr = ::operator new(bytes);
+        live.insert(ptr);
+        return ptr;
+    }
+
+    void deallocate(void *ptr) override
+    {
+        ASSERT_EQ(live.erase(ptr), 1u) << "Freed by the wrong allocator";
+        ::operator delete(ptr);
+    }
+
+    std::set<void*> live;
+};
+
+} // namespace
+
+TEST(MemoryBudget, RejectsBeyondLimit)
+{
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+    EXPECT_TRUE(budget.reserve(600));
+    EXPECT_FALSE(budget.reserve(600));
+    EXPECT_EQ(budget.getUsed(), 600u);
+    EXPECT_EQ(budget.getAvailable(), 400u);
+
+    budget.release(600);
+    EXPECT_TRUE(budget.reserve(600));
+}
+
+TEST(MemoryBudget, DeferredReservationWaitsForRelease)
+{
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+    budget.setPolicy(trt::BudgetPolicy::kDEFER, std::chrono::milliseconds(5000));
+    ASSERT_TRUE(budget.reserve(800));
+
+    std::future<bool> deferred = std::async(std::launch::async, [&]() { return budget.reserve(500); });
+    EXPECT_EQ(deferred.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    budget.release(800);
+    EXPECT_TRUE(deferred.get());
+    EXPECT_EQ(budget.getUsed(), 500u);
+
+    // Larger than the limit itself, never waits
+    EXPECT_FALSE(budget.reserve(2000));
+}
+
+TEST(MemoryBudget, DeferredReservationTimesOut)
+{
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+    budget.setPolicy(trt::BudgetPolicy::kDEFER, std::chrono::milliseconds(20));
+    ASSERT_TRUE(budget.reserve(800));
+    EXPECT_FALSE(budget.reserve(500));
+    EXPECT_EQ(budget.getUsed(), 800u);
+}
+
+TEST(MemoryBudget, ResizeTruesUpAnEstimate)
+{
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+    budget.setPolicy(trt::BudgetPolicy::kDEFER, std::chrono::milliseconds(0));
+
+    ASSERT_TRUE(budget.reserve(600));
+    EXPECT_TRUE(budget.resize(600, 400));
+    EXPECT_EQ(budget.getUsed(), 400u);
+    EXPECT_TRUE(budget.resize(400, 900));
+    EXPECT_EQ(budget.getUsed(), 900u);
+
+    // Growth beyond the limit fails at once, even though waiting forever is allowed
+    EXPECT_FALSE(budget.resize(900, 1100));
+    EXPECT_EQ(budget.getUsed(), 900u);
+}
+
+TEST(MemoryBudget, EstimateReservation)
+{
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+
+    // Rejection only happens on the measured footprint
+    EXPECT_EQ(budget.estimateReservation(5000), 0u);
+    EXPECT_EQ(budget.estimateReservation(300), 0u);
+
+    // Deferred reservations wait on the estimate, which an over-estimate cannot exceed
+    budget.setPolicy(trt::BudgetPolicy::kDEFER);
+    EXPECT_EQ(budget.estimateReservation(300), 300u);
+    EXPECT_EQ(budget.estimateReservation(5000), 1000u);
+
+    budget.setLimit(0);
+    EXPECT_EQ(budget.estimateReservation(5000), 5000u);
+}
+
+TEST(MemoryBudget, OverEstimateOfAFittingNetworkIsNotRejected)
+{
+    // What the TRTNetwork constructor does with an estimate of 1500 and a measured 700
+    for (trt::BudgetPolicy policy : {trt::BudgetPolicy::kREJECT, trt::BudgetPolicy::kDEFER}) {
+        trt::MemoryBudget budget;
+        budget.setLimit(1000);
+        budget.setPolicy(policy, std::chrono::milliseconds(100));
+
+        const size_t reserved = budget.estimateReservation(1500);
+        ASSERT_TRUE(budget.reserve(reserved));
+        EXPECT_TRUE(budget.resize(reserved, 700));
+        EXPECT_EQ(budget.getUsed(), 700u);
+    }
+
+    // A measured footprint beyond what is left is still rejected
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+    ASSERT_TRUE(budget.reserve(500));
+    const size_t reserved = budget.estimateReservation(400);
+    ASSERT_TRUE(budget.reserve(reserved));
+    EXPECT_FALSE(budget.resize(reserved, 600));
+    EXPECT_EQ(budget.getUsed(), 500u);
+}
+
+TEST(MemoryBudget, ShrinkingUnblocksDeferredReservations)
+{
+    trt::MemoryBudget budget;
+    budget.setLimit(1000);
+    budget.setPolicy(trt::BudgetPolicy::kDEFER, std::chrono::milliseconds(5000));
+    ASSERT_TRUE(budget.reserve(900));
+
+    std::future<bool> deferred = std::async(std::launch::async, [&]() { return budget.reserve(300); });
+    EXPECT_EQ(deferred.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    EXPECT_TRUE(budget.resize(900, 700));
+    EXPECT_TRUE(deferred.get());
+    EXPECT_EQ(budget.getUsed(), 1000u);
+}
+
+TEST(IOBlob, FreesThroughItsOwnAllocator)
+{
+    trt::MemoryBudget budget;
+    std::shared_ptr<MockAllocator> first = std::make_shared<MockAllocator>();
+    std::shared_ptr<MockAllocator> second = std::make_shared<MockAllocator>();
+    budget.setAllocator(first);
+
+    {
+        trt::IOBlob blob;
+        blob.allocator = budget.getAllocator();
+        blob.gpuPtr = blob.allocator->allocate(64);
+        blob.rawGpuPtr = blob.allocator->allocate(16);
+        EXPECT_EQ(first->live.size(), 2u);
+
+        // Installing another allocator does not affect the existing blobs
+        budget.setAllocator(second);
+        first.reset();
+    }
+
+    EXPECT_EQ(budget.getAllocator(), second);
+    EXPECT_TRUE(second->live.empty());
+}
+
+TEST(IOBlob, AllocatorOutlivesTheBudgetSwap)
+{
+    trt::MemoryBudget budget;
+    std::shared_ptr<MockAllocator> mock = std::make_shared<MockAllocator>();
+    budget.setAllocator(mock);
+
+    std::unique_ptr<trt::IOBlob> blob(new trt::IOBlob);
+    blob->allocator = budget.getAllocator();
+    blob->gpuPtr = blob->allocator->allocate(64);
+
+    budget.setAllocator(std::make_shared<MockAllocator>());
+    EXPECT_EQ(mock->live.size(), 1u);
+    blob.reset();
+    EXPECT_TRUE(mock->live.empty());
+}
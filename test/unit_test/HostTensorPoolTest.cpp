@@ -0,0 +1,172 @@
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/HostTensorPool.hpp"
+
+namespace {
+
+/**
+ * @brief Stand-in for the page-locked allocator: plain aligned host memory,
+ *        counting the calls the pool makes.
+ */
+class CountingAllocator : public trt::HostAllocator
+{
+public:
+    ~CountingAllocator() override
+    {
+        for (void *ptr : live)
+            std::free(ptr);
+    }
+
+    void* allocate(size_t bytes, size_t alignment) override
+    {
+        void *ptr = nullptr;
+        if (bytes > limit || posix_memalign(&ptr, alignment, bytes) != 0)
+            return nullptr;
+        live.insert(ptr);
+        return ptr;
+    }
+
+    void deallocate(void *ptr) override
+    {
+        ++numDeallocated;
+        live.erase(ptr);
+        std::free(ptr);
+    }
+
+    bool registerMemory(void*, size_t) override
+    {
+        ++numRegistered;
+        return true;
+    }
+
+    void unregisterMemory(void*) override
+    {
+        ++numUnregistered;
+    }
+
+    std::set<void*> live;
+    size_t limit = SIZE_MAX;
+    int numDeallocated = 0;
+    int numRegistered = 0;
+    int numUnregistered = 0;
+};
+
+} // namespace
+
+TEST(HostTensorPool, Alignment)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    trt::HostTensorPool pool(allocator, 512);
+
+    void *ptr = pool.acquire(100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 512, 0u);
+    EXPECT_EQ(pool.getBytesAllocated(), 512u);
+    EXPECT_TRUE(pool.release(ptr));
+}
+
+TEST(HostTensorPool, ReusesReleasedBuffers)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    trt::HostTensorPool pool(allocator, 256);
+
+    void *first = pool.acquire(1000);
+    EXPECT_TRUE(pool.release(first));
+    EXPECT_FALSE(pool.release(first)); // Already released
+    EXPECT_EQ(pool.getNumIdle(), 1u);
+
+    EXPECT_EQ(pool.acquire(600), first);
+    EXPECT_EQ(pool.getNumAllocations(), 1u);
+    EXPECT_EQ(pool.getNumInUse(), 1u);
+    EXPECT_EQ(pool.getNumIdle(), 0u);
+    EXPECT_TRUE(pool.release(first));
+}
+
+TEST(HostTensorPool, DoesNotWasteMoreThanHalf)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    trt::HostTensorPool pool(allocator, 256);
+
+    void *large = pool.acquire(4096);
+    EXPECT_TRUE(pool.release(large));
+
+    void *small = pool.acquire(1024); // 4096 > 2 x 1024
+    EXPECT_NE(small, large);
+    EXPECT_EQ(pool.getNumAllocations(), 2u);
+
+    void *half = pool.acquire(2048);  // 4096 <= 2 x 2048
+    EXPECT_EQ(half, large);
+    EXPECT_TRUE(pool.release(small));
+    EXPECT_TRUE(pool.release(half));
+}
+
+TEST(HostTensorPool, FailedAllocation)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    allocator->limit = 1024;
+    trt::HostTensorPool pool(allocator, 256);
+
+    EXPECT_EQ(pool.acquire(4096), nullptr);
+    EXPECT_EQ(pool.getNumAllocations(), 0u);
+    EXPECT_EQ(pool.getNumInUse(), 0u);
+}
+
+TEST(HostTensorPool, PinnedRanges)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    char *ptr = nullptr;
+    {
+        trt::HostTensorPool pool(allocator, 256);
+        ptr = static_cast<char*>(pool.acquire(1000));
+        EXPECT_TRUE(trt::HostTensorPool::isPinned(ptr, 1024));
+        EXPECT_TRUE(trt::HostTensorPool::isPinned(ptr + 512, 512));
+        EXPECT_FALSE(trt::HostTensorPool::isPinned(ptr + 512, 513));
+        EXPECT_FALSE(trt::HostTensorPool::isPinned(ptr - 1, 1));
+
+        EXPECT_TRUE(pool.release(ptr));
+        EXPECT_TRUE(trt::HostTensorPool::isPinned(ptr, 1024)); // Idle buffers stay pinned
+    }
+    EXPECT_FALSE(trt::HostTensorPool::isPinned(ptr, 1));
+    EXPECT_EQ(allocator->numDeallocated, 1);
+}
+
+TEST(HostTensorPool, RegisteredMemory)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    std::unique_ptr<float[]> caller(new float[256]);
+    {
+        trt::HostTensorPool pool(allocator, 256);
+        EXPECT_TRUE(pool.registerMemory(caller.get(), 256 * sizeof(float)));
+        EXPECT_EQ(allocator->numRegistered, 1);
+        EXPECT_TRUE(trt::HostTensorPool::isPinned(caller.get() + 128, 128 * sizeof(float)));
+
+        EXPECT_TRUE(pool.unregisterMemory(caller.get()));
+        EXPECT_FALSE(pool.unregisterMemory(caller.get()));
+        EXPECT_EQ(allocator->numUnregistered, 1);
+        EXPECT_FALSE(trt::HostTensorPool::isPinned(caller.get(), 1));
+
+        // Left registered, unregistered by the pool
+        EXPECT_TRUE(pool.registerMemory(caller.get(), 256 * sizeof(float)));
+    }
+    EXPECT_EQ(allocator->numUnregistered, 2);
+    EXPECT_FALSE(trt::HostTensorPool::isPinned(caller.get(), 1));
+}
+
+TEST(HostTensorPool, KeepsBuffersInUse)
+{
+    std::shared_ptr<CountingAllocator> allocator = std::make_shared<CountingAllocator>();
+    void *held = nullptr;
+    {
+        trt::HostTensorPool pool(allocator, 256);
+        held = pool.acquire(1024);
+        EXPECT_TRUE(pool.release(pool.acquire(4096)));
+    }
+    EXPECT_EQ(allocator->numDeallocated, 1);  // Only the idle buffer
+    EXPECT_EQ(allocator->live.count(held), 1u);
+    EXPECT_TRUE(trt::HostTensorPool::isPinned(held, 1024));
+}
@@ -0,0 +1,142 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/InferenceServer.hpp"
+#include "TRTNetwork/InferenceClient.hpp"
+
+namespace {
+
+const int SAMPLE_SIZE = 4;
+const int NUM_CLASSES = 2;
+const int MAX_BATCH = 2;
+
+class HeapAllocator : public trt::HostAllocator
+{
+public:
+    void* allocate(size_t bytes, size_t) override { return std::malloc(bytes); }
+    void deallocate(void *ptr) override { std::free(ptr); }
+    bool registerMemory(void*, size_t) override { return true; }
+    void unregisterMemory(void*) override {}
+};
+
+/**
+ * @brief Writes the sum of each input sample to every class of its output,
+ *        overwrites the input in the slot, and records what it was given.
+ */
+class FakeExecutor : public trt::Executor
+{
+public:
+    bool execute(const std::string&, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict) override
+    {
+        batchSizes.push_back(batchSize);
+        float *data = static_cast<float*>(feedDict.at(0).second);
+        float *prob = static_cast<float*>(feedDict.at(1).second);
+        outputSeen.push_back(prob[0]);
+        for (int n = 0; n < batchSize; ++n) {
+            float sum = 0.f;
+            for (int i = 0; i < SAMPLE_SIZE; ++i)
+                sum += data[n * SAMPLE_SIZE + i];
+            for (int c = 0; c < NUM_CLASSES; ++c)
+                prob[n * NUM_CLASSES + c] = sum;
+        }
+        data[0] = -1.f;
+        return true;
+    }
+
+    std::vector<int> batchSizes;
+    std::vector<float> outputSeen; // First output value in the slot before the inference
+};
+
+class InferenceServerTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        name = "trt_unit_test_" + std::to_string(getpid());
+        server.reset(new trt::InferenceServer(name, executor, 4, std::make_shared<HeapAllocator>()));
+        server->addModel("fake", MAX_BATCH, {{"data", SAMPLE_SIZE * sizeof(float)}},
+                         {{"prob", NUM_CLASSES * sizeof(float)}});
+        ASSERT_TRUE(server->open());
+        server->start();
+        ASSERT_TRUE(client.connect(name));
+    }
+
+    void TearDown() override
+    {
+        client.disconnect();
+        server.reset();
+    }
+
+    std::string name;
+    FakeExecutor executor;
+    std::unique_ptr<trt::InferenceServer> server;
+    trt::InferenceClient client;
+};
+
+} // namespace
+
+TEST_F(InferenceServerTest, CopiesInputsInAndOutputsOut)
+{
+    std::vector<float> data = {1, 2, 3, 4, 10, 20, 30, 40};
+    std::vector<float> prob(MAX_BATCH * NUM_CLASSES, 7.f);
+    ASSERT_TRUE(client.infer("fake", 2, {{"data", data.data()}, {"prob", prob.data()}}));
+
+    EXPECT_EQ(prob, (std::vector<float>{10, 10, 100, 100}));
+    EXPECT_EQ(data.at(0), 1.f);                    // Inputs are not copied back
+    ASSERT_EQ(executor.outputSeen.size(), 1u);
+    EXPECT_NE(executor.outputSeen.at(0), 7.f);     // Outputs are not copied in
+    EXPECT_EQ(executor.batchSizes, (std::vector<int>{2}));
+}
+
+TEST_F(InferenceServerTest, RejectsBatchSizeOutOfRange)
+{
+    std::vector<float> data(4 * SAMPLE_SIZE, 1.f);
+    std::vector<float> prob(4 * NUM_CLASSES, 7.f);
+    EXPECT_FALSE(client.infer("fake", 0, {{"data", data.data()}, {"prob", prob.data()}}));
+    EXPECT_FALSE(client.infer("fake", -1, {{"data", data.data()}, {"prob", prob.data()}}));
+    EXPECT_FALSE(client.infer("fake", MAX_BATCH + 1, {{"data", data.data()}, {"prob", prob.data()}}));
+    EXPECT_FALSE(client.infer("unknown", 1, {{"data", data.data()}, {"prob", prob.data()}}));
+    EXPECT_FALSE(client.infer("fake", 1, {{"label", data.data()}}));
+    EXPECT_TRUE(executor.batchSizes.empty());
+
+    // No ticket was taken, so the ring still serves the next request
+    EXPECT_TRUE(client.infer("fake", 1, {{"data", data.data()}, {"prob", prob.data()}}));
+    EXPECT_EQ(prob.at(0), 4.f);
+}
+
+TEST_F(InferenceServerTest, RunFailsInvalidBatchWithoutStallingTheRing)
+{
+    EXPECT_EQ(client.getMaxBatchSize("fake"), MAX_BATCH);
+    EXPECT_EQ(client.getMaxBatchSize("unknown"), 0);
+
+    uint64_t ticket;
+    ASSERT_TRUE(client.acquire(ticket));
+    EXPECT_FALSE(client.run(ticket, "fake", MAX_BATCH + 1));
+    client.release(ticket);
+    EXPECT_TRUE(executor.batchSizes.empty());
+
+    ASSERT_TRUE(client.acquire(ticket));
+    float *data = static_cast<float*>(client.getTensor(ticket, "fake", "data"));
+    std::fill(data, data + SAMPLE_SIZE, 2.f);
+    EXPECT_TRUE(client.run(ticket, "fake", 1));
+    EXPECT_EQ(static_cast<const float*>(client.getTensor(ticket, "fake", "prob"))[1], 8.f);
+    client.release(ticket);
+}
+
+TEST_F(InferenceServerTest, AcquireFailsFastWithoutServer)
+{
+    server.reset();
+
+    uint64_t ticket;
+    EXPECT_FALSE(client.acquire(ticket));
+
+    std::vector<float> data(SAMPLE_SIZE), prob(NUM_CLASSES);
+    EXPECT_FALSE(client.infer("fake", 1, {{"data", data.data()}, {"prob", prob.data()}}));
+}
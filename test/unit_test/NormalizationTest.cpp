@@ -0,0 +1,259 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/Normalization.hpp"
+
+namespace {
+
+/* Mocks of the parts of nvinfer1::INetworkDefinition, ITensor and ILayer
+ * which prependNormalization uses, recording the layers it adds. */
+struct MockTensor
+{
+    std::string name;
+    nvinfer1::Dims dims;
+
+    const char* getName() const { return name.c_str(); }
+    nvinfer1::Dims getDimensions() const { return dims; }
+};
+
+struct MockLayer
+{
+    std::string name;
+    std::vector<MockTensor*> inputs;
+    MockTensor output;
+
+    // Parameters of the added layers
+    std::string kind;
+    int numOutputs = 0;
+    std::vector<float> first;   // Kernel or shift
+    std::vector<float> second;  // Bias or scale
+    int64_t powerCount = -1;
+
+    int getNbInputs() const { return (int)inputs.size(); }
+    MockTensor* getInput(int i) const { return inputs.at(i); }
+    MockTensor* getOutput(int) { return &output; }
+    void setInput(int i, MockTensor &tensor) { inputs.at(i) = &tensor; }
+    void setName(const char *value) { name = value; }
+};
+
+struct MockNetwork
+{
+    std::vector< std::unique_ptr<MockTensor> > inputs;
+    std::vector< std::unique_ptr<MockLayer> > layers;
+
+    MockTensor* addInput(const std::string &name, std::vector<int> shape)
+    {
+        inputs.emplace_back(new MockTensor);
+        inputs.back()->name = name;
+        inputs.back()->dims.nbDims = (int)shape.size();
+        for (size_t i = 0; i < shape.size(); ++i)
+            inputs.back()->dims.d[i] = shape.at(i);
+        return inputs.back().get();
+    }
+
+    MockLayer* addLayer(const std::string &name, std::vector<MockTensor*> layerInputs)
+    {
+        layers.emplace_back(new MockLayer);
+        layers.back()->name = name;
+        layers.back()->inputs = layerInputs;
+        layers.back()->output.name = name;
+        return layers.back().get();
+    }
+
+    int getNbInputs() const { return (int)inputs.size(); }
+    MockTensor* getInput(int i) const { return inputs.at(i).get(); }
+    int getNbLayers() const { return (int)layers.size(); }
+    MockLayer* getLayer(int l) const { return layers.at(l).get(); }
+
+    MockLayer* addConvolution(MockTensor &input, int numOutputs, nvinfer1::DimsHW kernelSize,
+                              nvinfer1::Weights kernel, nvinfer1::Weights bias)
+    {
+        EXPECT_EQ(kernelSize.d[0], 1);
+        EXPECT_EQ(kernelSize.d[1], 1);
+        MockLayer *layer = addLayer("", {&input});
+        layer->kind = "convolution";
+        layer->numOutputs = numOutputs;
+        layer->first = valuesOf(kernel);
+        layer->second = valuesOf(bias);
+        return layer;
+    }
+
+    MockLayer* addScale(MockTensor &input, nvinfer1::ScaleMode mode, nvinfer1::Weights shift,
+                        nvinfer1::Weights scale, nvinfer1::Weights power)
+    {
+        EXPECT_TRUE(mode == nvinfer1::ScaleMode::kCHANNEL);
+        MockLayer *layer = addLayer("", {&input});
+        layer->kind = "scale";
+        layer->first = valuesOf(shift);
+        layer->second = valuesOf(scale);
+        layer->powerCount = power.count;
+        return layer;
+    }
+
+    static std::vector<float> valuesOf(const nvinfer1::Weights &weights)
+    {
+        const float *values = static_cast<const float*>(weights.values);
+        return std::vector<float>(values, values + weights.count);
+    }
+};
+
+/**
+ * @brief A detector-like network: the image "data" and "im_info" inputs,
+ *        two layers reading the image and one reading the other input.
+ */
+void buildNetwork(MockNetwork &network, bool imageFirst)
+{
+    MockTensor *info = nullptr, *data = nullptr;
+    if (imageFirst) {
+        data = network.addInput("data", {3, 4, 4});
+        info = network.addInput("im_info", {1, 1, 3});
+    } else {
+        info = network.addInput("im_info", {1, 1, 3});
+        data = network.addInput("data", {3, 4, 4});
+    }
+    MockLayer *conv1 = network.addLayer("conv1", {data});
+    network.addLayer("proposal", {&conv1->output, info});
+    network.addLayer("shortcut", {data, &conv1->output});
+}
+
+/**
+ * @brief Check that the "data" input was rewired through the last layer.
+ */
+void expectRewired(const MockNetwork &network)
+{
+    ASSERT_EQ(network.getNbLayers(), 4);
+    const MockLayer *normalization = network.getLayer(3);
+    EXPECT_EQ(normalization->name, "input_normalization");
+    ASSERT_EQ(normalization->getNbInputs(), 1);
+    EXPECT_EQ(normalization->inputs.at(0)->name, "data");
+
+    const MockTensor *normalized = &normalization->output;
+    EXPECT_EQ(network.getLayer(0)->getInput(0), normalized);          // conv1
+    EXPECT_EQ(network.getLayer(1)->getInput(1)->name, "im_info");     // proposal
+    EXPECT_EQ(network.getLayer(2)->getInput(0), normalized);          // shortcut
+    EXPECT_EQ(network.getLayer(2)->getInput(1), &network.getLayer(0)->output);
+}
+
+} // namespace
+
+TEST(InputNormalization, Validate)
+{
+    trt::InputNormalization normalization;
+    EXPECT_TRUE(normalization.validate(3));
+    EXPECT_FALSE(normalization.validate(0));
+
+    normalization.mean = {104.f, 117.f, 123.f};
+    EXPECT_TRUE(normalization.validate(3));
+    EXPECT_FALSE(normalization.validate(1));
+
+    normalization.channelOrder = {2, 1, 0};
+    EXPECT_TRUE(normalization.validate(3));
+    EXPECT_TRUE(normalization.swapsChannels());
+    normalization.channelOrder = {0, 1, 2};
+    EXPECT_FALSE(normalization.swapsChannels());
+    normalization.channelOrder = {0, 0, 2};
+    EXPECT_FALSE(normalization.validate(3));
+    normalization.channelOrder = {0, 1, 3};
+    EXPECT_FALSE(normalization.validate(3));
+    normalization.channelOrder = {1, 0};
+    EXPECT_FALSE(normalization.validate(3));
+}
+
+TEST(PrependNormalization, ScaleLayer)
+{
+    MockNetwork network;
+    buildNetwork(network, true);
+
+    trt::InputNormalization normalization;
+    normalization.mean = {104.f, 117.f, 123.f};
+    normalization.scale = 0.5f;
+    std::vector<float> weights;
+    ASSERT_TRUE(trt::prependNormalization(network, normalization, weights));
+    expectRewired(network);
+
+    // y = 0.5 * x - 0.5 * mean
+    const MockLayer *layer = network.getLayer(3);
+    EXPECT_EQ(layer->kind, "scale");
+    EXPECT_EQ(layer->first, (std::vector<float>{-52.f, -58.5f, -61.5f}));
+    EXPECT_EQ(layer->second, (std::vector<float>{0.5f, 0.5f, 0.5f}));
+    EXPECT_EQ(layer->powerCount, 0);
+}
+
+TEST(PrependNormalization, ChannelSwapIsAConvolution)
+{
+    MockNetwork network;
+    buildNetwork(network, true);
+
+    trt::InputNormalization normalization;
+    normalization.mean = {1.f, 2.f, 3.f};
+    normalization.scale = 2.f;
+    normalization.channelOrder = {2, 0, 1};
+    std::vector<float> weights;
+    ASSERT_TRUE(trt::prependNormalization(network, normalization, weights));
+    expectRewired(network);
+
+    // Output channel c reads input channel channelOrder[c]
+    const MockLayer *layer = network.getLayer(3);
+    EXPECT_EQ(layer->kind, "convolution");
+    EXPECT_EQ(layer->numOutputs, 3);
+    EXPECT_EQ(layer->first, (std::vector<float>{0.f, 0.f, 2.f,
+                                                2.f, 0.f, 0.f,
+                                                0.f, 2.f, 0.f}));
+    EXPECT_EQ(layer->second, (std::vector<float>{-2.f, -4.f, -6.f}));
+}
+
+TEST(PrependNormalization, ResolvesTheInputByName)
+{
+    // The image is the second input of the network, as in many detectors
+    MockNetwork network;
+    buildNetwork(network, false);
+
+    trt::InputNormalization normalization;
+    normalization.mean = {104.f, 117.f, 123.f};
+    std::vector<float> weights;
+    ASSERT_TRUE(trt::prependNormalization(network, normalization, weights, "data"));
+    expectRewired(network);
+}
+
+TEST(PrependNormalization, DefaultsToTheFirstInput)
+{
+    MockNetwork network;
+    buildNetwork(network, true);
+
+    std::vector<float> weights;
+    ASSERT_TRUE(trt::prependNormalization(network, trt::InputNormalization(), weights));
+    expectRewired(network);
+    EXPECT_EQ(network.getLayer(3)->first, (std::vector<float>{0.f, 0.f, 0.f}));
+    EXPECT_EQ(network.getLayer(3)->second, (std::vector<float>{1.f, 1.f, 1.f}));
+}
+
+TEST(PrependNormalization, RejectionsLeaveTheNetworkUntouched)
+{
+    trt::InputNormalization normalization;
+    normalization.mean = {104.f, 117.f, 123.f};
+    std::vector<float> weights;
+
+    MockNetwork empty;
+    EXPECT_FALSE(trt::prependNormalization(empty, normalization, weights));
+    EXPECT_EQ(empty.getNbLayers(), 0);
+
+    MockNetwork network;
+    buildNetwork(network, false);
+    EXPECT_FALSE(trt::prependNormalization(network, normalization, weights, "image"));  // Unknown input
+    EXPECT_FALSE(trt::prependNormalization(network, normalization, weights));           // im_info has 1 channel
+    EXPECT_EQ(network.getNbLayers(), 3);
+    EXPECT_EQ(network.getLayer(0)->getInput(0)->name, "data");
+
+    normalization.channelOrder = {0, 2, 2};
+    EXPECT_FALSE(trt::prependNormalization(network, normalization, weights, "data"));
+    EXPECT_EQ(network.getNbLayers(), 3);
+
+    MockNetwork scalar;
+    MockTensor *input = scalar.addInput("data", {});
+    scalar.addLayer("fc", {input});
+    EXPECT_FALSE(trt::prependNormalization(scalar, trt::InputNormalization(), weights));
+    EXPECT_EQ(scalar.getNbLayers(), 1);
+}
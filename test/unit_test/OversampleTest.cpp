@@ -0,0 +1,156 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/Oversample.hpp"
+#include "TRTNetwork/TRTNetwork.hpp"
+#include "TRTNetwork/Transformer.hpp"
+
+namespace {
+
+/**
+ * @brief Plain host memory, keeping track of the live allocations.
+ */
+class TrackingAllocator : public trt::HostAllocator
+{
+public:
+    void* allocate(size_t bytes, size_t alignment) override
+    {
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, alignment, bytes) != 0)
+            return nullptr;
+        live.insert(ptr);
+        return ptr;
+    }
+
+    void deallocate(void *ptr) override
+    {
+        live.erase(ptr);
+        std::free(ptr);
+    }
+
+    bool registerMemory(void*, size_t) override { return true; }
+    void unregisterMemory(void*) override {}
+
+    std::set<void*> live;
+};
+
+void expectOrigins(const std::vector<cv::Point> &origins, const std::vector<cv::Point> &expected)
+{
+    ASSERT_EQ(origins.size(), expected.size());
+    for (size_t n = 0; n < expected.size(); ++n) {
+        EXPECT_EQ(origins.at(n).x, expected.at(n).x) << "crop " << n;
+        EXPECT_EQ(origins.at(n).y, expected.at(n).y) << "crop " << n;
+    }
+}
+
+} // namespace
+
+/* The expected values are the crops_ix of caffe.io.oversample, which lists
+ * (y, x) of the corners row by row, then the center. */
+TEST(OversampleOrigins, MatchCaffe)
+{
+    // The reference models: 256 x 256 cropped to 227 x 227, the center is at 14
+    expectOrigins(trt::oversampleOrigins(cv::Size(256, 256), cv::Size(227, 227)),
+                  {{0, 0}, {29, 0}, {0, 29}, {29, 29}, {14, 14}});
+    // Odd margins and non-square images
+    expectOrigins(trt::oversampleOrigins(cv::Size(255, 240), cv::Size(227, 227)),
+                  {{0, 0}, {28, 0}, {0, 13}, {28, 13}, {14, 6}});
+    expectOrigins(trt::oversampleOrigins(cv::Size(256, 256), cv::Size(224, 224)),
+                  {{0, 0}, {32, 0}, {0, 32}, {32, 32}, {16, 16}});
+    // No margin, every crop is the whole image
+    expectOrigins(trt::oversampleOrigins(cv::Size(227, 227), cv::Size(227, 227)),
+                  {{0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}});
+}
+
+TEST(CopyOversampledCrops, MatchCaffe)
+{
+    // Two planes of 5 x 4 holding their own index, cropped to 2 x 2
+    const cv::Size dims(5, 4), cropDims(2, 2);
+    std::vector<float> planes(2 * dims.area());
+    std::iota(planes.begin(), planes.begin() + dims.area(), 0.f);
+    std::iota(planes.begin() + dims.area(), planes.end(), 100.f);
+
+    std::vector<float> batch(trt::OVERSAMPLE_CROPS * 2 * cropDims.area(), -1.f);
+    trt::copyOversampledCrops(planes.data(), 2, dims, cropDims, batch.data());
+
+    // Corners at x = 0, 3 and y = 0, 2, the center at (1, 1), then the mirrors
+    const float crops[trt::OVERSAMPLE_CROPS][4] = {
+        {0, 1, 5, 6}, {3, 4, 8, 9}, {10, 11, 15, 16}, {13, 14, 18, 19}, {6, 7, 11, 12},
+        {1, 0, 6, 5}, {4, 3, 9, 8}, {11, 10, 16, 15}, {14, 13, 19, 18}, {7, 6, 12, 11}
+    };
+    for (int n = 0; n < trt::OVERSAMPLE_CROPS; ++n) {
+        for (int c = 0; c < 2; ++c)
+            for (int i = 0; i < 4; ++i)
+                EXPECT_EQ(batch.at((n * 2 + c) * 4 + i), crops[n][i] + 100 * c)
+                    << "crop " << n << ", channel " << c << ", pixel " << i;
+    }
+}
+
+TEST(ReduceCrops, Mean)
+{
+    // Three crops of two scores
+    const float outputs[] = {0.1f, 0.9f, 0.4f, 0.6f, 0.7f, 0.3f};
+    float result[2] = {0.f, 0.f};
+    trt::reduceCrops(outputs, 3, 2, trt::CropReduction::kMEAN, result);
+    EXPECT_FLOAT_EQ(result[0], 0.4f);
+    EXPECT_FLOAT_EQ(result[1], 0.6f);
+
+    trt::reduceCrops(outputs, 1, 2, trt::CropReduction::kMEAN, result);
+    EXPECT_FLOAT_EQ(result[0], 0.1f);
+    EXPECT_FLOAT_EQ(result[1], 0.9f);
+}
+
+TEST(ReduceCrops, MeanOfTenCrops)
+{
+    std::vector<float> outputs(trt::OVERSAMPLE_CROPS * 3);
+    for (int n = 0; n < trt::OVERSAMPLE_CROPS; ++n) {
+        outputs.at(n * 3) = (float)n;       // Mean 4.5
+        outputs.at(n * 3 + 1) = 1.f;
+        outputs.at(n * 3 + 2) = n == 7 ? 10.f : 0.f;
+    }
+    float result[3];
+    trt::reduceCrops(outputs.data(), trt::OVERSAMPLE_CROPS, 3, trt::CropReduction::kMEAN, result);
+    EXPECT_FLOAT_EQ(result[0], 4.5f);
+    EXPECT_FLOAT_EQ(result[1], 1.f);
+    EXPECT_FLOAT_EQ(result[2], 1.f);
+}
+
+TEST(ReduceCrops, Max)
+{
+    const float outputs[] = {0.1f, 0.9f, 0.4f, 0.6f, 0.7f, 0.3f};
+    float result[2] = {0.f, 0.f};
+    trt::reduceCrops(outputs, 3, 2, trt::CropReduction::kMAX, result);
+    EXPECT_FLOAT_EQ(result[0], 0.7f);
+    EXPECT_FLOAT_EQ(result[1], 0.9f);
+}
+
+TEST(Oversampler, ReleasesItsBuffers)
+{
+    // Needs a GPU and the reference CaffeNet, as the examples do
+    const char *caffeRoot = std::getenv("CAFFE_ROOT");
+    if (!caffeRoot) {
+        std::cout << "CAFFE_ROOT is not set, skipping" << std::endl;
+        return;
+    }
+    const std::string models = std::string(caffeRoot) + "/models/bvlc_reference_caffenet/";
+    trt::TRTNetwork caffenet("caffenet", models + "deploy.prototxt", models + "bvlc_reference_caffenet.caffemodel",
+                             {"prob"}, {"data"}, trt::OVERSAMPLE_CROPS);
+    trt::Transformer transformer;
+
+    std::shared_ptr<TrackingAllocator> allocator = std::make_shared<TrackingAllocator>();
+    {
+        trt::Oversampler oversampler(caffenet, transformer, "data", "prob", cv::Size(256, 256),
+                                     trt::CropReduction::kMEAN, allocator);
+        EXPECT_EQ(oversampler.getImagesPerBatch(), 1);
+        EXPECT_EQ(allocator->live.size(), 2u);
+    }
+    // Both buffers went back to the pool, which freed them
+    EXPECT_TRUE(allocator->live.empty());
+}
@@ -0,0 +1,185 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/Regression.hpp"
+
+namespace {
+
+trt::BlobData makeBlob(const std::vector<int> &shape, const std::vector<float> &data)
+{
+    trt::BlobData blob;
+    blob.shape = shape;
+    blob.data = data;
+    return blob;
+}
+
+void writeInt(std::ofstream &file, int32_t value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Write a golden file of one entry with the given header fields
+ *        and no data.
+ */
+std::string writeHeader(int32_t nameLength, const std::vector<int32_t> &dims)
+{
+    const std::string path = testing::TempDir() + "trt_golden_header.bin";
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write("TRTGOLD1", 8);
+    writeInt(file, 1);
+    writeInt(file, nameLength);
+    file.write("prob", 4);
+    writeInt(file, (int32_t)dims.size());
+    for (int32_t dim : dims)
+        writeInt(file, dim);
+    return path;
+}
+
+} // namespace
+
+TEST(CompareOutputs, Metrics)
+{
+    // Identical, top-1 swapped, and the reference top-1 last in the test
+    const std::vector<float> test = {
+        0.f, 0.5f, 0.25f, 0.f, 0.f, 0.25f,
+        1.f, 0.5f, 0.f,   0.f, 0.f, 0.f,
+        1.f, 0.5f, 0.5f,  0.5f, 0.5f, 0.f
+    };
+    const std::vector<float> reference = {
+        0.f,  0.5f, 0.25f, 0.f, 0.f, 0.25f,
+        0.5f, 1.f,  0.f,   0.f, 0.f, 0.f,
+        0.f,  0.f,  0.f,   0.f, 0.f, 1.f
+    };
+
+    trt::Divergence d = trt::compareOutputs(test.data(), reference.data(), 3, 6);
+    EXPECT_EQ(d.samples, 3u);
+    EXPECT_FLOAT_EQ(d.maxAbsError, 1.f);
+    EXPECT_DOUBLE_EQ(d.meanAbsError, 5.0 / 18);
+    EXPECT_DOUBLE_EQ(d.top1Agreement, 1.0 / 3);
+    EXPECT_DOUBLE_EQ(d.top5Agreement, 2.0 / 3);
+
+    // Fewer classes than the top-5 make it always agree
+    d = trt::compareOutputs(test.data() + 6, reference.data() + 6, 1, 3);
+    EXPECT_DOUBLE_EQ(d.top1Agreement, 0.0);
+    EXPECT_DOUBLE_EQ(d.top5Agreement, 1.0);
+
+    d = trt::compareOutputs(test.data(), reference.data(), 0, 6);
+    EXPECT_EQ(d.samples, 0u);
+    EXPECT_DOUBLE_EQ(d.meanAbsError, 0.0);
+}
+
+TEST(CompareOutputs, Accumulate)
+{
+    trt::Divergence a, b;
+    a.samples = 1;
+    a.maxAbsError = 0.5f;
+    a.meanAbsError = 0.5;
+    a.top1Agreement = 1.0;
+    a.top5Agreement = 1.0;
+    b.samples = 3;
+    b.maxAbsError = 2.f;
+    b.meanAbsError = 0.1;
+    b.top1Agreement = 0.0;
+    b.top5Agreement = 1.0 / 3;
+
+    trt::Divergence total;
+    total.accumulate(a);
+    total.accumulate(trt::Divergence());
+    total.accumulate(b);
+    EXPECT_EQ(total.samples, 4u);
+    EXPECT_FLOAT_EQ(total.maxAbsError, 2.f);
+    EXPECT_DOUBLE_EQ(total.meanAbsError, 0.2);
+    EXPECT_DOUBLE_EQ(total.top1Agreement, 0.25);
+    EXPECT_DOUBLE_EQ(total.top5Agreement, 0.5);
+}
+
+TEST(Golden, RoundTrip)
+{
+    trt::GoldenSet golden;
+    golden["cat.jpg/prob"] = makeBlob({2, 3}, {1.f, -2.f, 3.5f, 0.f, 1e-6f, 7.f});
+    golden["dog.jpg/prob"] = makeBlob({1, 0}, {});
+    golden[""] = makeBlob({4}, {1.f, 2.f, 3.f, 4.f});
+
+    const std::string path = testing::TempDir() + "trt_golden.bin";
+    ASSERT_TRUE(trt::writeGolden(path, golden));
+
+    trt::GoldenSet read;
+    read["stale"] = makeBlob({1}, {1.f});
+    ASSERT_TRUE(trt::readGolden(path, read));
+    ASSERT_EQ(read.size(), golden.size());
+    for (const std::pair<const std::string, trt::BlobData> &kv : golden) {
+        ASSERT_EQ(read.count(kv.first), 1u) << kv.first;
+        EXPECT_EQ(read.at(kv.first).shape, kv.second.shape);
+        EXPECT_EQ(read.at(kv.first).data, kv.second.data);
+    }
+
+    trt::Divergence d = trt::compareGolden(read, golden);
+    EXPECT_EQ(d.samples, 2u);
+    EXPECT_FLOAT_EQ(d.maxAbsError, 0.f);
+    EXPECT_DOUBLE_EQ(d.top1Agreement, 1.0);
+
+    // A truncated file is rejected
+    std::ifstream in(path.c_str(), std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream(path.c_str(), std::ios::binary).write(bytes.data(), bytes.size() - 1);
+    EXPECT_FALSE(trt::readGolden(path, read));
+    std::remove(path.c_str());
+}
+
+TEST(Golden, MalformedFiles)
+{
+    trt::GoldenSet golden;
+    EXPECT_FALSE(trt::readGolden(testing::TempDir() + "trt_no_such_golden.bin", golden));
+
+    const std::string path = testing::TempDir() + "trt_golden_magic.bin";
+    std::ofstream(path.c_str(), std::ios::binary).write("TRTGOLD2\0\0\0\0", 12);
+    EXPECT_FALSE(trt::readGolden(path, golden));
+    std::remove(path.c_str());
+
+    // Lengths and shapes which would overflow or exhaust the memory
+    const std::vector< std::pair<int32_t, std::vector<int32_t> > > headers = {
+        {-1, {1}},
+        {0x7fffffff, {1}},
+        {4, {-1}},
+        {4, {65536, 65536}},
+        {4, {2, 1 << 30}},
+        {4, {(1 << 28) + 1}},
+    };
+    for (const std::pair<int32_t, std::vector<int32_t> > &header : headers) {
+        const std::string headerPath = writeHeader(header.first, header.second);
+        EXPECT_FALSE(trt::readGolden(headerPath, golden)) << header.first;
+        std::remove(headerPath.c_str());
+    }
+
+    // The header alone of a small entry is only missing its data
+    const std::string headerPath = writeHeader(4, {2, 2});
+    EXPECT_FALSE(trt::readGolden(headerPath, golden));
+    std::remove(headerPath.c_str());
+}
+
+TEST(Golden, CompareSkipsMissingAndMismatchedEntries)
+{
+    trt::GoldenSet reference, test;
+    reference["a"] = makeBlob({3}, {0.f, 1.f, 0.f});
+    reference["b"] = makeBlob({3}, {1.f, 0.f, 0.f});
+    reference["c"] = makeBlob({2}, {1.f, 0.f});
+    test["a"] = makeBlob({3}, {0.f, 0.75f, 0.5f});
+    test["c"] = makeBlob({1, 2}, {0.f, 1.f});
+    test["extra"] = makeBlob({1}, {1.f});
+
+    trt::Divergence d = trt::compareGolden(test, reference);
+    EXPECT_EQ(d.samples, 1u);
+    EXPECT_FLOAT_EQ(d.maxAbsError, 0.5f);
+    EXPECT_DOUBLE_EQ(d.meanAbsError, 0.25);
+    EXPECT_DOUBLE_EQ(d.top1Agreement, 1.0);
+
+    EXPECT_EQ(trt::compareGolden(test, trt::GoldenSet()).samples, 0u);
+}
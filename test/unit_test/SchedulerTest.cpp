@@ -0,0 +1,301 @@
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/Scheduler.hpp"
+
+namespace {
+
+typedef std::chrono::milliseconds ms;
+
+/**
+ * @brief Executor which records the order of the inferences and takes a
+ *        fixed time per sample of the simulated clock.
+ */
+class FakeExecutor : public trt::Executor
+{
+public:
+    explicit FakeExecutor(std::shared_ptr<trt::ManualClock> clock, trt::Duration perSample = ms(1))
+        : clock(clock), perSample(perSample) {}
+
+    bool execute(const std::string &model, int batchSize,
+                 const std::vector< std::pair<std::string, void*> >&) override
+    {
+        clock->advance(perSample * batchSize);
+        order.push_back(model);
+        return true;
+    }
+
+    std::shared_ptr<trt::ManualClock> clock;
+    trt::Duration perSample;
+    std::vector<std::string> order;
+};
+
+trt::InferenceRequest makeRequest(const std::string &model, int priority = 0, int batchSize = 1,
+                                  trt::TimePoint deadline = trt::TimePoint::max())
+{
+    trt::InferenceRequest request;
+    request.model = model;
+    request.priority = priority;
+    request.batchSize = batchSize;
+    request.deadline = deadline;
+    return request;
+}
+
+std::map<std::string, int> countOf(const std::vector<std::string> &order)
+{
+    std::map<std::string, int> counts;
+    for (const std::string &model : order)
+        ++counts[model];
+    return counts;
+}
+
+} // namespace
+
+TEST(Scheduler, WeightedFairShare)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setModelWeight("a", 3.0);
+    scheduler.setModelWeight("b", 1.0);
+
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_EQ(scheduler.submit(makeRequest("a")), trt::AdmissionResult::kACCEPTED);
+        ASSERT_EQ(scheduler.submit(makeRequest("b")), trt::AdmissionResult::kACCEPTED);
+    }
+    for (int i = 0; i < 20; ++i)
+        ASSERT_TRUE(scheduler.dispatchOne());
+
+    std::map<std::string, int> counts = countOf(executor.order);
+    EXPECT_EQ(counts["a"], 15);
+    EXPECT_EQ(counts["b"], 5);
+}
+
+TEST(Scheduler, FairShareCountsSamples)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 1, clock);
+
+    // Equal weights: a batch of 4 costs as much as 4 batches of 1
+    for (int i = 0; i < 10; ++i) {
+        scheduler.submit(makeRequest("large", 0, 4));
+        for (int j = 0; j < 4; ++j)
+            scheduler.submit(makeRequest("small", 0, 1));
+    }
+    for (int i = 0; i < 20; ++i)
+        ASSERT_TRUE(scheduler.dispatchOne());
+
+    std::map<std::string, int> counts = countOf(executor.order);
+    EXPECT_EQ(counts["large"], 4);
+    EXPECT_EQ(counts["small"], 16);
+}
+
+TEST(Scheduler, IdleModelCannotSaveUpCredit)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 1, clock);
+
+    for (int i = 0; i < 10; ++i) {
+        scheduler.submit(makeRequest("busy"));
+        scheduler.dispatchOne();
+    }
+
+    // The newcomer starts from the current virtual time and alternates
+    for (int i = 0; i < 4; ++i) {
+        scheduler.submit(makeRequest("busy"));
+        scheduler.submit(makeRequest("new"));
+    }
+    executor.order.clear();
+    for (int i = 0; i < 8; ++i)
+        scheduler.dispatchOne();
+
+    std::map<std::string, int> counts = countOf(executor.order);
+    EXPECT_EQ(counts["busy"], 4);
+    EXPECT_EQ(counts["new"], 4);
+}
+
+TEST(Scheduler, EarliestDeadlineFirstWithinModel)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock, trt::Duration::zero());
+    trt::Scheduler scheduler(executor, 1, clock);
+
+    const trt::TimePoint t0 = clock->now();
+    std::vector<std::string> order;
+    auto submit = [&](const std::string &tag, trt::TimePoint deadline) {
+        trt::InferenceRequest request = makeRequest("m", 0, 1, deadline);
+        request.done = [&order, tag](bool) { order.push_back(tag); };
+        scheduler.submit(std::move(request));
+    };
+    submit("none1", trt::TimePoint::max());
+    submit("late", t0 + ms(300));
+    submit("early", t0 + ms(100));
+    submit("none2", trt::TimePoint::max());
+    submit("mid", t0 + ms(200));
+
+    while (scheduler.dispatchOne()) {}
+    EXPECT_EQ(order, (std::vector<std::string>{"early", "mid", "late", "none1", "none2"}));
+}
+
+TEST(Scheduler, UrgentRequestsPreemptFairShare)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock, trt::Duration::zero());
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setUrgencyWindow(ms(50));
+
+    const trt::TimePoint t0 = clock->now();
+    scheduler.submit(makeRequest("a", 0, 1, t0 + ms(40)));
+    scheduler.submit(makeRequest("b", 0, 1, t0 + ms(30)));
+    scheduler.submit(makeRequest("c", 0, 1, t0 + ms(500)));
+    scheduler.submit(makeRequest("d"));
+
+    while (scheduler.dispatchOne()) {}
+    ASSERT_EQ(executor.order.size(), 4u);
+    EXPECT_EQ(executor.order.at(0), "b");
+    EXPECT_EQ(executor.order.at(1), "a");
+}
+
+TEST(Scheduler, StrictPriorityBetweenClasses)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 3, clock);
+
+    scheduler.submit(makeRequest("low", 2));
+    scheduler.submit(makeRequest("mid", 1));
+    scheduler.submit(makeRequest("high", 0));
+    EXPECT_EQ(scheduler.submit(makeRequest("bad", 3)), trt::AdmissionResult::kINVALID);
+
+    while (scheduler.dispatchOne()) {}
+    EXPECT_EQ(executor.order, (std::vector<std::string>{"high", "mid", "low"}));
+}
+
+TEST(Scheduler, ShedsRequestsWhichCannotMeetTheirDeadline)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock, ms(10));
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setServiceTimeEstimate("m", ms(10));
+
+    const trt::TimePoint t0 = clock->now();
+    EXPECT_EQ(scheduler.submit(makeRequest("m", 0, 1, t0 + ms(5))), trt::AdmissionResult::kEXPIRED);
+
+    bool result = true;
+    trt::InferenceRequest request = makeRequest("m", 0, 1, t0 + ms(15));
+    request.done = [&result](bool success) { result = success; };
+    EXPECT_EQ(scheduler.submit(std::move(request)), trt::AdmissionResult::kACCEPTED);
+
+    // Still queued when there is no time left for it
+    clock->advance(ms(10));
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_FALSE(result);
+    EXPECT_TRUE(executor.order.empty());
+
+    trt::ClassMetrics metrics = scheduler.getMetrics(0);
+    EXPECT_EQ(metrics.shed, 1u);
+    EXPECT_EQ(metrics.expired, 1u);
+}
+
+TEST(Scheduler, BoundedQueueRejects)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setQueueCapacity(0, 2);
+
+    EXPECT_EQ(scheduler.trySubmit(makeRequest("m")), trt::AdmissionResult::kACCEPTED);
+    EXPECT_EQ(scheduler.trySubmit(makeRequest("m")), trt::AdmissionResult::kACCEPTED);
+    EXPECT_EQ(scheduler.trySubmit(makeRequest("m")), trt::AdmissionResult::kREJECTED);
+    scheduler.dispatchOne();
+    EXPECT_EQ(scheduler.trySubmit(makeRequest("m")), trt::AdmissionResult::kACCEPTED);
+    EXPECT_EQ(scheduler.getMetrics(0).maxQueueLength, 2u);
+}
+
+TEST(Scheduler, ServiceEstimateScalesWithBatch)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock, ms(1));
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setServiceTimeEstimate("m", ms(40), 4);
+
+    const trt::TimePoint t0 = clock->now();
+    EXPECT_EQ(scheduler.submit(makeRequest("m", 0, 1, t0 + ms(15))), trt::AdmissionResult::kACCEPTED);
+    EXPECT_EQ(scheduler.submit(makeRequest("m", 0, 2, t0 + ms(15))), trt::AdmissionResult::kEXPIRED);
+}
+
+TEST(Scheduler, MeasuredServiceTimeIsPerSample)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock, ms(1));
+    trt::Scheduler scheduler(executor, 1, clock);
+
+    // The first run of 4 samples takes 4ms, seeding 1ms per sample
+    scheduler.submit(makeRequest("m", 0, 4));
+    ASSERT_TRUE(scheduler.dispatchOne());
+
+    const trt::TimePoint t0 = clock->now();
+    EXPECT_EQ(scheduler.submit(makeRequest("m", 0, 1, t0 + ms(2))), trt::AdmissionResult::kACCEPTED);
+    EXPECT_EQ(scheduler.submit(makeRequest("m", 0, 8, t0 + ms(5))), trt::AdmissionResult::kEXPIRED);
+}
+
+TEST(Scheduler, QueuedLargeBatchExpiresBeforeDispatch)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock, ms(1));
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setServiceTimeEstimate("m", ms(1));
+
+    const trt::TimePoint t0 = clock->now();
+    ASSERT_EQ(scheduler.submit(makeRequest("m", 0, 8, t0 + ms(10))), trt::AdmissionResult::kACCEPTED);
+    clock->advance(ms(4)); // 6ms left for 8ms of work
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_TRUE(executor.order.empty());
+    EXPECT_EQ(scheduler.getMetrics(0).expired, 1u);
+    EXPECT_EQ(scheduler.getMetrics(0).deadlineMisses, 0u);
+}
+
+TEST(Scheduler, StopReleasesBlockedSubmit)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setQueueCapacity(0, 1);
+    ASSERT_EQ(scheduler.submit(makeRequest("m")), trt::AdmissionResult::kACCEPTED);
+
+    // No deadline and nobody dispatching: only stop() can end the wait
+    std::future<trt::AdmissionResult> blocked = std::async(std::launch::async, [&]() {
+        return scheduler.submit(makeRequest("m"));
+    });
+    EXPECT_EQ(blocked.wait_for(ms(50)), std::future_status::timeout);
+
+    scheduler.stop();
+    ASSERT_EQ(blocked.wait_for(ms(5000)), std::future_status::ready);
+    EXPECT_EQ(blocked.get(), trt::AdmissionResult::kREJECTED);
+    EXPECT_EQ(scheduler.getNumPending(), 1u);
+}
+
+TEST(Scheduler, BlockedSubmitProceedsOnRoom)
+{
+    std::shared_ptr<trt::ManualClock> clock = std::make_shared<trt::ManualClock>();
+    FakeExecutor executor(clock);
+    trt::Scheduler scheduler(executor, 1, clock);
+    scheduler.setQueueCapacity(0, 1);
+    ASSERT_EQ(scheduler.submit(makeRequest("m")), trt::AdmissionResult::kACCEPTED);
+
+    std::future<trt::AdmissionResult> blocked = std::async(std::launch::async, [&]() {
+        return scheduler.submit(makeRequest("m"));
+    });
+    EXPECT_EQ(blocked.wait_for(ms(50)), std::future_status::timeout);
+
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_EQ(blocked.get(), trt::AdmissionResult::kACCEPTED);
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/TensorView.hpp"
+
+namespace {
+
+/**
+ * @brief What copyToDevice does, on the host: gather a view into a packed
+ *        buffer by executing its plan.
+ */
+std::vector<float> gather(const trt::TensorView &view)
+{
+    std::vector<float> packed(view.numElements());
+    const char *src = static_cast<const char*>(view.data);
+    char *dst = reinterpret_cast<char*>(packed.data());
+    for (const trt::Copy2D &c : trt::planStridedCopy(view))
+        for (size_t row = 0; row < c.height; ++row)
+            std::memcpy(dst + c.packedOffset + row * c.width, src + c.viewOffset + row * c.viewPitch, c.width);
+    return packed;
+}
+
+std::vector<float> iota(size_t count)
+{
+    std::vector<float> values(count);
+    std::iota(values.begin(), values.end(), 0.f);
+    return values;
+}
+
+} // namespace
+
+TEST(TensorView, ContiguousStrides)
+{
+    trt::TensorView view(nullptr, {2, 3, 4, 5});
+    EXPECT_EQ(view.strides, (std::vector<size_t>{240, 80, 20, 4}));
+    EXPECT_TRUE(view.isContiguous());
+    EXPECT_FALSE(view.hasOverlap());
+    EXPECT_EQ(view.numBytes(), 480u);
+
+    trt::TensorView raw(nullptr, {2, 4, 5, 3}, trt::DType::kUINT8);
+    EXPECT_EQ(raw.strides, (std::vector<size_t>{60, 15, 3, 1}));
+}
+
+TEST(PlanStridedCopy, ContiguousIsOneCopy)
+{
+    std::vector<float> data = iota(2 * 3 * 4 * 5);
+    trt::TensorView view(data.data(), {2, 3, 4, 5});
+
+    std::vector<trt::Copy2D> plan = trt::planStridedCopy(view);
+    ASSERT_EQ(plan.size(), 1u);
+    EXPECT_EQ(plan.at(0).width, data.size() * sizeof(float));
+    EXPECT_EQ(plan.at(0).height, 1u);
+    EXPECT_EQ(gather(view), data);
+}
+
+TEST(PlanStridedCopy, PitchedRowsAreOneCopyPerPlane)
+{
+    // Rows of 5 floats padded to a pitch of 8 floats
+    const size_t pitch = 8 * sizeof(float);
+    std::vector<float> data = iota(2 * 3 * 4 * 8);
+    trt::TensorView view(data.data(), {2, 3, 4, 5}, {3 * 4 * pitch, 4 * pitch, pitch, sizeof(float)});
+    EXPECT_FALSE(view.isContiguous());
+
+    std::vector<trt::Copy2D> plan = trt::planStridedCopy(view);
+    ASSERT_EQ(plan.size(), 6u);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(plan.at(i).viewOffset, i * 4 * pitch);
+        EXPECT_EQ(plan.at(i).packedOffset, i * 4 * 5 * sizeof(float));
+        EXPECT_EQ(plan.at(i).width, 5 * sizeof(float));
+        EXPECT_EQ(plan.at(i).height, 4u);
+        EXPECT_EQ(plan.at(i).viewPitch, pitch);
+    }
+
+    std::vector<float> packed = gather(view);
+    for (int plane = 0; plane < 6; ++plane)
+        for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 5; ++x)
+                EXPECT_EQ(packed.at((plane * 4 + y) * 5 + x), data.at((plane * 4 + y) * 8 + x));
+}
+
+TEST(PlanStridedCopy, InterleavedBatchIsOneCopy)
+{
+    // Every other sample of a batch of 4
+    const size_t sample = 3 * 4 * 5 * sizeof(float);
+    std::vector<float> data = iota(4 * 3 * 4 * 5);
+    trt::TensorView view(data.data(), {2, 3, 4, 5}, {2 * sample, 80, 20, 4});
+
+    std::vector<trt::Copy2D> plan = trt::planStridedCopy(view);
+    ASSERT_EQ(plan.size(), 1u);
+    EXPECT_EQ(plan.at(0).width, sample);
+    EXPECT_EQ(plan.at(0).height, 2u);
+    EXPECT_EQ(plan.at(0).viewPitch, 2 * sample);
+
+    std::vector<float> packed = gather(view);
+    EXPECT_TRUE(std::equal(packed.begin(), packed.begin() + 60, data.begin()));
+    EXPECT_TRUE(std::equal(packed.begin() + 60, packed.end(), data.begin() + 120));
+}
+
+TEST(PlanStridedCopy, SizeOneDimsKeepContiguity)
+{
+    std::vector<float> data = iota(3 * 4);
+    trt::TensorView view(data.data(), {1, 3, 1, 4}, {12345, 16, 999, 4});
+    EXPECT_TRUE(view.isContiguous());
+    EXPECT_EQ(trt::planStridedCopy(view).size(), 1u);
+    EXPECT_EQ(gather(view), data);
+}
+
+TEST(PlanStridedCopy, TransposedLayout)
+{
+    // [N, C, H, W] view of an interleaved [N, H, W, C] buffer
+    const int C = 3, H = 2, W = 4;
+    std::vector<float> hwc = iota(H * W * C);
+    trt::TensorView view(hwc.data(), {1, C, H, W},
+                         {H * W * C * sizeof(float), sizeof(float), W * C * sizeof(float), C * sizeof(float)});
+    EXPECT_FALSE(view.hasOverlap());
+
+    std::vector<float> chw = gather(view);
+    for (int c = 0; c < C; ++c)
+        for (int y = 0; y < H; ++y)
+            for (int x = 0; x < W; ++x)
+                EXPECT_EQ(chw.at((c * H + y) * W + x), hwc.at((y * W + x) * C + c));
+}
+
+TEST(PlanStridedCopy, RejectedLayouts)
+{
+    float data[4] = {0.f};
+    EXPECT_TRUE(trt::planStridedCopy(trt::TensorView(data, {2, 2}, {8})).empty());      // Missing strides
+    EXPECT_TRUE(trt::planStridedCopy(trt::TensorView(data, {0, 2})).empty());           // No element
+    EXPECT_TRUE(trt::planStridedCopy(trt::TensorView(data, {2, 2}, {8, 4, 4})).empty()); // Extra stride
+}
+
+TEST(TensorView, Overlap)
+{
+    float data[8] = {0.f};
+    EXPECT_TRUE(trt::TensorView(data, {4, 2}, {0, 4}).hasOverlap());  // Broadcast batch
+    EXPECT_TRUE(trt::TensorView(data, {2, 4}, {8, 4}).hasOverlap());  // Rows overlap by half
+    EXPECT_FALSE(trt::TensorView(data, {2, 2}, {16, 4}).hasOverlap()); // Gaps are fine
+}
+
+TEST(ValidateView, MatchingDims)
+{
+    float data[2 * 3 * 4 * 5];
+    EXPECT_TRUE(trt::validateView(trt::TensorView(data, {2, 3, 4, 5}), "data", {3, 4, 5}, 2, false));
+    EXPECT_TRUE(trt::validateView(trt::TensorView(data, {1, 3, 4, 5}), "data", {3, 4, 5}, 2, false));
+}
+
+TEST(ValidateView, MismatchedDims)
+{
+    float data[2 * 3 * 4 * 5];
+    EXPECT_FALSE(trt::validateView(trt::TensorView(data, {2, 3, 5, 4}), "data", {3, 4, 5}, 2, false));
+    EXPECT_FALSE(trt::validateView(trt::TensorView(data, {2, 60}), "data", {3, 4, 5}, 2, false));
+    EXPECT_FALSE(trt::validateView(trt::TensorView(data, {3, 4, 5}), "data", {3, 4, 5}, 2, false));
+    EXPECT_FALSE(trt::validateView(trt::TensorView(data, {2, 3, 4, 5}, {240, 80, 20}), "data", {3, 4, 5}, 2,
+                                   false));
+}
+
+TEST(ValidateView, BatchSize)
+{
+    float data[3 * 60];
+    EXPECT_FALSE(trt::validateView(trt::TensorView(data, {0, 3, 4, 5}), "data", {3, 4, 5}, 2, false));
+    EXPECT_FALSE(trt::validateView(trt::TensorView(data, {3, 3, 4, 5}), "data", {3, 4, 5}, 2, false));
+}
+
+TEST(ValidateView, RawImages)
+{
+    uint8_t raw[2 * 4 * 5 * 3];
+    trt::TensorView hwc(raw, {2, 4, 5, 3}, trt::DType::kUINT8);
+    EXPECT_TRUE(trt::validateView(hwc, "data", {3, 4, 5}, 2, false, true));
+    EXPECT_FALSE(trt::validateView(hwc, "data", {3, 4, 5}, 2, false, false)); // Not normalized by the engine
+    EXPECT_FALSE(trt::validateView(hwc, "prob", {3, 4, 5}, 2, true, true));   // Outputs are float
+    EXPECT_FALSE(trt::validateView(trt::TensorView(raw, {2, 3, 4, 5}, trt::DType::kUINT8), "data", {3, 4, 5}, 2,
+                                   false, true));                                // Planar
+}
+
+TEST(ValidateView, OverlappingOutputs)
+{
+    float data[10];
+    trt::TensorView broadcast(data, {2, 10, 1, 1}, {0, 4, 4, 4});
+    EXPECT_TRUE(trt::validateView(broadcast, "data", {10, 1, 1}, 2, false));
+    EXPECT_FALSE(trt::validateView(broadcast, "prob", {10, 1, 1}, 2, true));
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/ThreadPool.hpp"
+
+namespace {
+
+trt::ThreadPoolOptions withThreads(int numThreads)
+{
+    trt::ThreadPoolOptions options;
+    options.numThreads = numThreads;
+    return options;
+}
+
+} // namespace
+
+TEST(ParseCpuList, Ranges)
+{
+    std::vector<int> cpus;
+    ASSERT_TRUE(trt::parseCpuList("0-3,8, 10-11\n", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_FALSE(trt::parseCpuList("", cpus));
+    EXPECT_FALSE(trt::parseCpuList("3-1", cpus));
+    EXPECT_FALSE(trt::parseCpuList("1-a", cpus));
+}
+
+TEST(ThreadPool, ParallelForRunsEveryIndexOnce)
+{
+    trt::ThreadPool pool(withThreads(4));
+    EXPECT_EQ(pool.getNumThreads(), 4);
+    EXPECT_EQ(pool.getNumWorkers(), 3);
+
+    std::vector<int> hits(1000, 0);
+    pool.parallelFor(0, (int)hits.size(), [&](int i) { ++hits.at(i); });
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), (long)hits.size());
+
+    pool.parallelFor(5, 5, [&](int) { FAIL(); });
+}
+
+TEST(ThreadPool, NestedParallelFor)
+{
+    trt::ThreadPool pool(withThreads(4));
+    const int outer = 8, inner = 32;
+    std::vector< std::atomic<int> > hits(outer * inner);
+    pool.parallelFor(0, outer, [&](int i) {
+        pool.parallelFor(0, inner, [&](int j) { ++hits.at(i * inner + j); });
+    });
+    for (const std::atomic<int> &hit : hits)
+        EXPECT_EQ(hit.load(), 1);
+}
+
+TEST(ThreadPool, ParallelForRethrowsAfterRunningIterations)
+{
+    trt::ThreadPool pool(withThreads(4));
+    std::atomic<int> running(0), started(0);
+
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        started = 0;
+        try {
+            pool.parallelFor(0, 200, [&](int i) {
+                ++running;
+                ++started;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                --running;
+                if (i % 7 == 3)
+                    throw std::runtime_error("bad item");
+            });
+            FAIL() << "The exception of the body was swallowed";
+        } catch (const std::runtime_error &e) {
+            EXPECT_STREQ(e.what(), "bad item");
+        }
+        // Nothing still runs the body of the returned loop, and no new index started
+        EXPECT_EQ(running.load(), 0);
+        EXPECT_LT(started.load(), 200);
+    }
+
+    // The pool is still usable
+    std::atomic<int> sum(0);
+    pool.parallelFor(0, 100, [&](int i) { sum += i; });
+    EXPECT_EQ(sum.load(), 4950);
+}
+
+TEST(ThreadPool, ParallelForRethrowsWithoutWorkers)
+{
+    trt::ThreadPool pool(withThreads(1));
+    EXPECT_EQ(pool.getNumWorkers(), 0);
+    EXPECT_THROW(pool.parallelFor(0, 10, [](int) { throw std::bad_alloc(); }), std::bad_alloc);
+}
+
+TEST(ThreadPool, FailingTaskKeepsTheWorker)
+{
+    trt::ThreadPool pool(withThreads(2));
+    for (int i = 0; i < 4; ++i)
+        pool.submit([]() { throw std::runtime_error("task failed"); });
+    pool.submit([]() { throw 42; });
+
+    std::promise<int> done;
+    std::future<int> result = done.get_future();
+    pool.submit([&]() { done.set_value(7); });
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(result.get(), 7);
+
+    trt::ThreadPool inlinePool(withThreads(1));
+    EXPECT_NO_THROW(inlinePool.submit([]() { throw std::runtime_error("inline task failed"); }));
+}
+
+TEST(ThreadPool, AllocateOnNodeIsZeroed)
+{
+    trt::ThreadPool pool(withThreads(2));
+    const size_t bytes = 1 << 16;
+    unsigned char *ptr = static_cast<unsigned char*>(pool.allocateOnNode(bytes, 0));
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(std::count(ptr, ptr + bytes, 0), (long)bytes);
+    std::free(ptr);
+}
@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TRTNetwork/Traffic.hpp"
+
+namespace {
+
+trt::TraceRecord makeRecord(const std::string &model, int64_t startNs, int64_t durationNs, int batchSize)
+{
+    trt::TraceRecord rec;
+    rec.model = model;
+    rec.startNs = startNs;
+    rec.durationNs = durationNs;
+    rec.batchSize = batchSize;
+    rec.success = true;
+
+    trt::TraceTensor input, output;
+    input.name = "data";
+    input.shape = {batchSize, 2};
+    output.name = "prob";
+    output.isOutput = true;
+    output.shape = {batchSize, 3, 1, 1};
+    rec.tensors = {input, output};
+    return rec;
+}
+
+void writeTrace(const std::string &path, const std::vector<trt::TraceRecord> &records)
+{
+    trt::TrafficRecorder recorder(path);
+    ASSERT_TRUE(recorder.isOpen());
+    for (const trt::TraceRecord &rec : records)
+        recorder.record(rec);
+    EXPECT_EQ(recorder.getNumRecords(), records.size());
+}
+
+/**
+ * @brief Records the requests it is given and the first input values.
+ */
+class RecordingExecutor : public trt::Executor
+{
+public:
+    bool execute(const std::string &model, int batchSize,
+                 const std::vector< std::pair<std::string, void*> > &feedDict) override
+    {
+        std::lock_guard<std::mutex> locker(mtx);
+        models.push_back(model);
+        const float *data = static_cast<const float*>(feedDict.at(0).second);
+        inputs.push_back(std::vector<float>(data, data + 2 * batchSize));
+        return model != "failing";
+    }
+
+    std::mutex mtx;
+    std::vector<std::string> models;
+    std::vector< std::vector<float> > inputs;
+};
+
+} // namespace
+
+TEST(Trace, RoundTrip)
+{
+    const std::string path = testing::TempDir() + "trt_round_trip.trace";
+    std::vector<trt::TraceRecord> written = {makeRecord("classifier", 1000, 500, 2),
+                                             makeRecord("detector", 1500, 2000, 1)};
+    const float values[2] = {0.5f, -1.f};
+    written.at(1).tensors.at(0).data.assign(reinterpret_cast<const char*>(values),
+                                            reinterpret_cast<const char*>(values) + sizeof(values));
+    written.at(1).success = false;
+    writeTrace(path, written);
+
+    std::vector<trt::TraceRecord> records;
+    ASSERT_TRUE(trt::readTrace(path, records));
+    ASSERT_EQ(records.size(), 2u);
+    for (size_t i = 0; i < records.size(); ++i) {
+        const trt::TraceRecord &rec = records.at(i), &expected = written.at(i);
+        EXPECT_EQ(rec.model, expected.model);
+        EXPECT_EQ(rec.startNs, expected.startNs);
+        EXPECT_EQ(rec.durationNs, expected.durationNs);
+        EXPECT_EQ(rec.batchSize, expected.batchSize);
+        EXPECT_EQ(rec.success, expected.success);
+        ASSERT_EQ(rec.tensors.size(), 2u);
+        for (size_t t = 0; t < rec.tensors.size(); ++t) {
+            EXPECT_EQ(rec.tensors.at(t).name, expected.tensors.at(t).name);
+            EXPECT_EQ(rec.tensors.at(t).isOutput, expected.tensors.at(t).isOutput);
+            EXPECT_EQ(rec.tensors.at(t).shape, expected.tensors.at(t).shape);
+            EXPECT_EQ(rec.tensors.at(t).data, expected.tensors.at(t).data);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(Trace, TruncatedTailIsDropped)
+{
+    const std::string path = testing::TempDir() + "trt_truncated.trace";
+    writeTrace(path, {makeRecord("a", 0, 10, 1), makeRecord("b", 5, 10, 1), makeRecord("c", 9, 10, 1)});
+
+    std::string bytes;
+    {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size() - 7);
+    }
+
+    std::vector<trt::TraceRecord> records;
+    ASSERT_TRUE(trt::readTrace(path, records));
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records.at(1).model, "b");
+    std::remove(path.c_str());
+}
+
+TEST(Trace, MalformedFiles)
+{
+    std::vector<trt::TraceRecord> records;
+    EXPECT_FALSE(trt::readTrace(testing::TempDir() + "trt_no_such.trace", records));
+
+    const std::string path = testing::TempDir() + "trt_bad_magic.trace";
+    {
+        std::ofstream file(path.c_str(), std::ios::binary);
+        file << "NOTATRACE";
+    }
+    EXPECT_FALSE(trt::readTrace(path, records));
+    std::remove(path.c_str());
+}
+
+TEST(OpenLoopWorkers, PeakOverlap)
+{
+    // [0, 10), [2, 6), [4, 12) and [10, 11): at most 3 in flight at t = 4-6
+    std::vector<trt::TraceRecord> records = {makeRecord("a", 0, 10, 1), makeRecord("a", 2, 4, 1),
+                                             makeRecord("a", 4, 8, 1), makeRecord("a", 10, 1, 1)};
+    EXPECT_EQ(trt::openLoopWorkers(records), 6);
+
+    // Arrivals 4 times as fast at 0, 0.5, 1 and 2.5 but the same durations: 4 in flight at t = 2.5
+    EXPECT_EQ(trt::openLoopWorkers(records, 4.0), 8);
+
+    // A completion and an arrival at the same time do not overlap
+    EXPECT_EQ(trt::openLoopWorkers({makeRecord("a", 0, 5, 1), makeRecord("a", 5, 5, 1)}), 2);
+    EXPECT_EQ(trt::openLoopWorkers({}), 1);
+}
+
+TEST(ReplayTrace, ArrivalOrderAndZeroFill)
+{
+    // In completion order, as concurrent callers leave them
+    std::vector<trt::TraceRecord> records = {makeRecord("second", 2000, 100, 1), makeRecord("first", 1000, 5000, 1),
+                                             makeRecord("failing", 3000, 100, 1)};
+    const float values[2] = {3.f, 4.f};
+    records.at(1).tensors.at(0).data.assign(reinterpret_cast<const char*>(values),
+                                            reinterpret_cast<const char*>(values) + sizeof(values));
+    records.at(0).tensors.at(0).data.assign(reinterpret_cast<const char*>(values),
+                                            reinterpret_cast<const char*>(values) + sizeof(float));
+
+    RecordingExecutor executor;
+    trt::ReplayOptions options;
+    options.numWorkers = 1;
+    trt::ReplayResult result = trt::replayTrace(executor, records, options);
+
+    EXPECT_EQ(executor.models, (std::vector<std::string>{"first", "second", "failing"}));
+    ASSERT_EQ(executor.inputs.size(), 3u);
+    EXPECT_EQ(executor.inputs.at(0), (std::vector<float>{3.f, 4.f}));
+    EXPECT_EQ(executor.inputs.at(1), (std::vector<float>{3.f, 0.f})); // Captured shorter than its shape
+    EXPECT_EQ(executor.inputs.at(2), (std::vector<float>{0.f, 0.f})); // Not captured
+
+    EXPECT_EQ(result.requests, 3u);
+    EXPECT_EQ(result.failed, 1u);
+    EXPECT_EQ(result.samples, 3u);
+    EXPECT_EQ(result.delayed, 0u);
+}